@@ -6,7 +6,19 @@ namespace lve::backend {
   std::unique_ptr<RuntimeBackend> createRuntimeBackend(const RuntimeBackendConfig &config) {
     switch (config.api) {
       case BackendApi::Vulkan:
-        return std::make_unique<VulkanRuntimeBackend>(config.width, config.height, config.title);
+        if (config.headless) {
+          return std::make_unique<VulkanHeadlessRuntimeBackend>(
+            config.width,
+            config.height,
+            config.framePacing,
+            config.textureStreaming);
+        }
+        return std::make_unique<VulkanRuntimeBackend>(
+          config.width,
+          config.height,
+          config.title,
+          config.framePacing,
+          config.textureStreaming);
       default:
         return {};
     }
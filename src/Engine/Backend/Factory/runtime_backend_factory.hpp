@@ -15,6 +15,10 @@ namespace lve::backend {
     int width{0};
     int height{0};
     std::string title{};
+    FramePacingConfig framePacing{};
+    TextureStreamingConfig textureStreaming{};
+    // no window or present; width/height become the default view size, title is unused
+    bool headless{false};
   };
 
   std::unique_ptr<RuntimeBackend> createRuntimeBackend(const RuntimeBackendConfig &config);
@@ -1,6 +1,7 @@
 #include "descriptors.hpp"
 
 // std
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -110,8 +111,7 @@ bool LveDescriptorPool::allocateDescriptor(
   allocInfo.pSetLayouts = &descriptorSetLayout;
   allocInfo.descriptorSetCount = 1;
 
-  // Might want to create a "DescriptorPoolManager" class that handles this case, and builds
-  // a new pool whenever an old pool fills up. But this is beyond our current scope
+  // fixed size, LveDescriptorAllocator chains pools for sets whose count isn't known up front
   if (vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptor) != VK_SUCCESS) {
     return false;
   }
@@ -130,35 +130,125 @@ void LveDescriptorPool::resetPool() {
   vkResetDescriptorPool(lveDevice.device(), descriptorPool, 0);
 }
 
-// *************** Descriptor Writer *********************
+// *************** Descriptor Allocator Builder *********************
 
-LveDescriptorWriter::LveDescriptorWriter(LveDescriptorSetLayout &setLayout, LveDescriptorPool &pool)
-    : setLayout{setLayout}, pool{pool} {}
+LveDescriptorAllocator::Builder &LveDescriptorAllocator::Builder::addSetSize(
+    VkDescriptorType descriptorType, uint32_t countPerSet) {
+  setSizes.push_back({descriptorType, countPerSet});
+  return *this;
+}
 
-LveDescriptorWriter &LveDescriptorWriter::writeBuffer(
-    uint32_t binding, const VkDescriptorBufferInfo *bufferInfo) {
-  assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+LveDescriptorAllocator::Builder &LveDescriptorAllocator::Builder::setSetsPerPool(uint32_t count) {
+  setsPerPool = count;
+  return *this;
+}
 
-  auto &bindingDescription = setLayout.bindings[binding];
+std::unique_ptr<LveDescriptorAllocator> LveDescriptorAllocator::Builder::build() const {
+  return std::make_unique<LveDescriptorAllocator>(lveDevice, setSizes, setsPerPool);
+}
 
-  assert(
-      bindingDescription.descriptorCount == 1 &&
-      "Binding single descriptor info, but binding expects multiple");
+// *************** Descriptor Allocator *********************
 
-  VkWriteDescriptorSet write{};
-  write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-  write.descriptorType = bindingDescription.descriptorType;
-  write.dstBinding = binding;
-  write.pBufferInfo = bufferInfo;
-  write.descriptorCount = 1;
+LveDescriptorAllocator::LveDescriptorAllocator(
+    LveDevice &lveDevice, const std::vector<VkDescriptorPoolSize> &setSizes, uint32_t setsPerPool)
+    : lveDevice{lveDevice},
+      setSizes{setSizes},
+      nextSetsPerPool{std::clamp(setsPerPool, 1u, kMaxSetsPerPool)} {}
+
+LveDescriptorAllocator::~LveDescriptorAllocator() {
+  for (VkDescriptorPool pool : usedPools) {
+    vkDestroyDescriptorPool(lveDevice.device(), pool, nullptr);
+  }
+  for (VkDescriptorPool pool : freePools) {
+    vkDestroyDescriptorPool(lveDevice.device(), pool, nullptr);
+  }
+}
+
+bool LveDescriptorAllocator::allocateDescriptor(
+    const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet &descriptor) {
+  VkDescriptorSetAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool = usedPools.empty() ? acquirePool() : usedPools.back();
+  allocInfo.pSetLayouts = &descriptorSetLayout;
+  allocInfo.descriptorSetCount = 1;
+
+  // a full pool reports VK_ERROR_OUT_OF_POOL_MEMORY or VK_ERROR_FRAGMENTED_POOL, 1.0 drivers
+  // without maintenance1 may report other errors, so any failure retries once in a fresh pool
+  if (vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptor) != VK_SUCCESS) {
+    allocInfo.descriptorPool = acquirePool();
+    if (vkAllocateDescriptorSets(lveDevice.device(), &allocInfo, &descriptor) != VK_SUCCESS) {
+      return false;
+    }
+  }
+  stats.allocatedSets++;
+  return true;
+}
+
+void LveDescriptorAllocator::reset() {
+  for (VkDescriptorPool pool : usedPools) {
+    vkResetDescriptorPool(lveDevice.device(), pool, 0);
+    freePools.push_back(pool);
+  }
+  usedPools.clear();
+  stats.usedPools = 0;
+  stats.allocatedSets = 0;
+  stats.resets++;
+}
+
+VkDescriptorPool LveDescriptorAllocator::acquirePool() {
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  if (!freePools.empty()) {
+    pool = freePools.back();
+    freePools.pop_back();
+  } else {
+    std::vector<VkDescriptorPoolSize> poolSizes = setSizes;
+    for (auto &poolSize : poolSizes) {
+      poolSize.descriptorCount *= nextSetsPerPool;
+    }
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo{};
+    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    descriptorPoolInfo.pPoolSizes = poolSizes.data();
+    descriptorPoolInfo.maxSets = nextSetsPerPool;
+
+    if (vkCreateDescriptorPool(lveDevice.device(), &descriptorPoolInfo, nullptr, &pool) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("failed to create descriptor pool!");
+    }
+    // each new pool doubles, a growing scene needs few of them
+    nextSetsPerPool = std::min(nextSetsPerPool * 2, kMaxSetsPerPool);
+    stats.pools++;
+  }
+  usedPools.push_back(pool);
+  stats.usedPools = static_cast<uint32_t>(usedPools.size());
+  return pool;
+}
 
-  writes.push_back(write);
+// *************** Descriptor Writer *********************
+
+LveDescriptorWriter::LveDescriptorWriter(LveDescriptorSetLayout &setLayout, LveDescriptorPool &pool)
+    : setLayout{setLayout}, lveDevice{pool.lveDevice}, pool{&pool} {}
+
+LveDescriptorWriter::LveDescriptorWriter(
+    LveDescriptorSetLayout &setLayout, LveDescriptorAllocator &allocator)
+    : setLayout{setLayout}, lveDevice{allocator.lveDevice}, allocator{&allocator} {}
+
+LveDescriptorWriter &LveDescriptorWriter::writeBuffer(
+    uint32_t binding, const VkDescriptorBufferInfo *bufferInfo) {
+  addWrite(binding).pBufferInfo = bufferInfo;
   return *this;
 }
 
 LveDescriptorWriter &LveDescriptorWriter::writeImage(
     uint32_t binding, VkDescriptorImageInfo *imageInfo) {
+  addWrite(binding).pImageInfo = imageInfo;
+  return *this;
+}
+
+VkWriteDescriptorSet &LveDescriptorWriter::addWrite(uint32_t binding) {
   assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+  assert(writeCount < kMaxWrites && "Too many writes for one descriptor set");
 
   auto &bindingDescription = setLayout.bindings[binding];
 
@@ -166,19 +256,18 @@ LveDescriptorWriter &LveDescriptorWriter::writeImage(
       bindingDescription.descriptorCount == 1 &&
       "Binding single descriptor info, but binding expects multiple");
 
-  VkWriteDescriptorSet write{};
+  VkWriteDescriptorSet &write = writes[writeCount++];
+  write = {};
   write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
   write.descriptorType = bindingDescription.descriptorType;
   write.dstBinding = binding;
-  write.pImageInfo = imageInfo;
   write.descriptorCount = 1;
-
-  writes.push_back(write);
-  return *this;
+  return write;
 }
 
 bool LveDescriptorWriter::build(VkDescriptorSet &set) {
-  bool success = pool.allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
+  bool success = allocator ? allocator->allocateDescriptor(setLayout.getDescriptorSetLayout(), set)
+                           : pool->allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
   if (!success) {
     return false;
   }
@@ -187,10 +276,115 @@ bool LveDescriptorWriter::build(VkDescriptorSet &set) {
 }
 
 void LveDescriptorWriter::overwrite(VkDescriptorSet &set) {
-  for (auto &write : writes) {
-    write.dstSet = set;
+  for (uint32_t i = 0; i < writeCount; i++) {
+    writes[i].dstSet = set;
   }
-  vkUpdateDescriptorSets(pool.lveDevice.device(), writes.size(), writes.data(), 0, nullptr);
+  vkUpdateDescriptorSets(lveDevice.device(), writeCount, writes.data(), 0, nullptr);
+}
+
+// *************** Descriptor Updater Builder *********************
+
+LveDescriptorUpdater::Builder &LveDescriptorUpdater::Builder::addEntry(
+    uint32_t binding, std::size_t offset) {
+  entries.emplace_back(binding, offset);
+  return *this;
+}
+
+std::unique_ptr<LveDescriptorUpdater> LveDescriptorUpdater::Builder::build() const {
+  return std::make_unique<LveDescriptorUpdater>(setLayout, dataSize, entries);
+}
+
+// *************** Descriptor Updater *********************
+
+LveDescriptorUpdater::LveDescriptorUpdater(
+    LveDescriptorSetLayout &setLayout,
+    std::size_t dataSize,
+    const std::vector<std::pair<uint32_t, std::size_t>> &entryOffsets)
+    : lveDevice{setLayout.lveDevice}, dataSize{dataSize} {
+  for (const auto &[binding, offset] : entryOffsets) {
+    assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+    const auto &bindingDescription = setLayout.bindings.at(binding);
+    assert(
+        bindingDescription.descriptorCount == 1 &&
+        "Updater entries describe a single descriptor, but binding expects multiple");
+    entries.push_back({binding, bindingDescription.descriptorType, offset});
+  }
+
+  if (!lveDevice.hasDescriptorUpdateTemplates()) {
+    return;
+  }
+
+  std::vector<VkDescriptorUpdateTemplateEntryKHR> templateEntries{};
+  for (const auto &entry : entries) {
+    VkDescriptorUpdateTemplateEntryKHR templateEntry{};
+    templateEntry.dstBinding = entry.binding;
+    templateEntry.dstArrayElement = 0;
+    templateEntry.descriptorCount = 1;
+    templateEntry.descriptorType = entry.type;
+    templateEntry.offset = entry.offset;
+    templateEntry.stride = dataSize;
+    templateEntries.push_back(templateEntry);
+  }
+
+  VkDescriptorUpdateTemplateCreateInfoKHR templateInfo{};
+  templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+  templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(templateEntries.size());
+  templateInfo.pDescriptorUpdateEntries = templateEntries.data();
+  templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+  templateInfo.descriptorSetLayout = setLayout.getDescriptorSetLayout();
+  updateTemplate = lveDevice.createDescriptorUpdateTemplate(templateInfo);
+}
+
+LveDescriptorUpdater::~LveDescriptorUpdater() {
+  if (updateTemplate != VK_NULL_HANDLE) {
+    lveDevice.destroyDescriptorUpdateTemplate(updateTemplate);
+  }
+}
+
+void LveDescriptorUpdater::queueData(VkDescriptorSet set, const void *data) {
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  queuedSets.push_back(set);
+  queuedData.insert(queuedData.end(), bytes, bytes + dataSize);
+}
+
+void LveDescriptorUpdater::flush() {
+  if (queuedSets.empty()) {
+    return;
+  }
+
+  if (updateTemplate != VK_NULL_HANDLE) {
+    for (std::size_t i = 0; i < queuedSets.size(); i++) {
+      lveDevice.updateDescriptorSetWithTemplate(
+          queuedSets[i], updateTemplate, queuedData.data() + i * dataSize);
+    }
+  } else {
+    writes.clear();
+    for (std::size_t i = 0; i < queuedSets.size(); i++) {
+      const unsigned char *data = queuedData.data() + i * dataSize;
+      for (const auto &entry : entries) {
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = queuedSets[i];
+        write.dstBinding = entry.binding;
+        write.descriptorType = entry.type;
+        write.descriptorCount = 1;
+        if (entry.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ||
+            entry.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+            entry.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+            entry.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
+          write.pBufferInfo = reinterpret_cast<const VkDescriptorBufferInfo *>(data + entry.offset);
+        } else {
+          write.pImageInfo = reinterpret_cast<const VkDescriptorImageInfo *>(data + entry.offset);
+        }
+        writes.push_back(write);
+      }
+    }
+    vkUpdateDescriptorSets(
+        lveDevice.device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+  }
+
+  queuedSets.clear();
+  queuedData.clear();
 }
 
 }  // namespace lve
@@ -3,6 +3,9 @@
 #include "device.hpp"
  
 // std
+#include <array>
+#include <cassert>
+#include <cstddef>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -41,6 +44,7 @@ class LveDescriptorSetLayout {
   std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
  
   friend class LveDescriptorWriter;
+  friend class LveDescriptorUpdater;
 };
  
 class LveDescriptorPool {
@@ -84,9 +88,69 @@ class LveDescriptorPool {
   friend class LveDescriptorWriter;
 };
  
+// Allocates from a chain of pools and opens another one whenever the current pool is full, so
+// allocation never fails because a fixed pool ran out. reset() releases every set at once and
+// keeps the pools for reuse; between resets an allocation is a bump in the current pool.
+class LveDescriptorAllocator {
+ public:
+  class Builder {
+   public:
+    Builder(LveDevice &lveDevice) : lveDevice{lveDevice} {}
+
+    // descriptors one set of the intended layouts needs, scaled by the sets of each pool
+    Builder &addSetSize(VkDescriptorType descriptorType, uint32_t countPerSet);
+    Builder &setSetsPerPool(uint32_t count);
+    std::unique_ptr<LveDescriptorAllocator> build() const;
+
+   private:
+    LveDevice &lveDevice;
+    std::vector<VkDescriptorPoolSize> setSizes{};
+    uint32_t setsPerPool = 256;
+  };
+
+  struct Stats {
+    uint32_t pools = 0;  // created, in use or waiting for reuse
+    uint32_t usedPools = 0;
+    uint64_t allocatedSets = 0;  // since the last reset
+    uint64_t resets = 0;
+  };
+
+  LveDescriptorAllocator(
+      LveDevice &lveDevice, const std::vector<VkDescriptorPoolSize> &setSizes, uint32_t setsPerPool);
+  ~LveDescriptorAllocator();
+  LveDescriptorAllocator(const LveDescriptorAllocator &) = delete;
+  LveDescriptorAllocator &operator=(const LveDescriptorAllocator &) = delete;
+
+  bool allocateDescriptor(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet &descriptor);
+
+  // every set allocated so far becomes invalid, the GPU must be done with all of them
+  void reset();
+
+  // changes on every reset, lets callers that cache sets notice they were released
+  uint64_t generation() const { return stats.resets; }
+  const Stats &getStats() const { return stats; }
+
+ private:
+  static constexpr uint32_t kMaxSetsPerPool = 4096;
+
+  VkDescriptorPool acquirePool();
+
+  LveDevice &lveDevice;
+  std::vector<VkDescriptorPoolSize> setSizes;
+  uint32_t nextSetsPerPool;
+  std::vector<VkDescriptorPool> usedPools;  // back() is the one allocated from
+  std::vector<VkDescriptorPool> freePools;
+  Stats stats{};
+
+  friend class LveDescriptorWriter;
+};
+
 class LveDescriptorWriter {
  public:
+  static constexpr uint32_t kMaxWrites = 8;
+ 
   LveDescriptorWriter(LveDescriptorSetLayout &setLayout, LveDescriptorPool &pool);
+  LveDescriptorWriter(LveDescriptorSetLayout &setLayout, LveDescriptorAllocator &allocator);
  
   LveDescriptorWriter &writeBuffer(uint32_t binding, const VkDescriptorBufferInfo *bufferInfo);
   LveDescriptorWriter &writeImage(uint32_t binding, VkDescriptorImageInfo *imageInfo);
@@ -95,8 +159,71 @@ class LveDescriptorWriter {
   void overwrite(VkDescriptorSet &set);
  
  private:
+  VkWriteDescriptorSet &addWrite(uint32_t binding);
+ 
   LveDescriptorSetLayout &setLayout;
-  LveDescriptorPool &pool;
+  LveDevice &lveDevice;
+  LveDescriptorPool *pool = nullptr;
+  LveDescriptorAllocator *allocator = nullptr;
+  // a writer fills a single set, so its writes fit inline
+  std::array<VkWriteDescriptorSet, kMaxWrites> writes{};
+  uint32_t writeCount = 0;
+};
+ 
+// Fills whole sets of one layout from a caller defined struct that holds one
+// VkDescriptorBufferInfo or VkDescriptorImageInfo per binding. queue() copies the struct and
+// flush() applies everything queued, through a descriptor update template when the device has
+// them and otherwise with a single vkUpdateDescriptorSets call. A queued set must not be bound
+// in a command buffer before the flush.
+class LveDescriptorUpdater {
+ public:
+  class Builder {
+   public:
+    Builder(LveDescriptorSetLayout &setLayout, std::size_t dataSize)
+        : setLayout{setLayout}, dataSize{dataSize} {}
+ 
+    // offset of the binding's info within the struct, the type comes from the layout
+    Builder &addEntry(uint32_t binding, std::size_t offset);
+    std::unique_ptr<LveDescriptorUpdater> build() const;
+ 
+   private:
+    LveDescriptorSetLayout &setLayout;
+    std::size_t dataSize;
+    std::vector<std::pair<uint32_t, std::size_t>> entries{};
+  };
+ 
+  LveDescriptorUpdater(
+      LveDescriptorSetLayout &setLayout,
+      std::size_t dataSize,
+      const std::vector<std::pair<uint32_t, std::size_t>> &entries);
+  ~LveDescriptorUpdater();
+  LveDescriptorUpdater(const LveDescriptorUpdater &) = delete;
+  LveDescriptorUpdater &operator=(const LveDescriptorUpdater &) = delete;
+ 
+  template <typename T>
+  void queue(VkDescriptorSet set, const T &data) {
+    assert(sizeof(T) == dataSize && "Descriptor data does not match the updater");
+    queueData(set, &data);
+  }
+  void flush();
+ 
+ private:
+  struct Entry {
+    uint32_t binding;
+    VkDescriptorType type;
+    std::size_t offset;
+  };
+ 
+  void queueData(VkDescriptorSet set, const void *data);
+ 
+  LveDevice &lveDevice;
+  std::size_t dataSize;
+  std::vector<Entry> entries;
+  VkDescriptorUpdateTemplateKHR updateTemplate = VK_NULL_HANDLE;
+ 
+  // kept between flushes so a steady frame doesn't allocate
+  std::vector<VkDescriptorSet> queuedSets;
+  std::vector<unsigned char> queuedData;
   std::vector<VkWriteDescriptorSet> writes;
 };
  
@@ -1,8 +1,14 @@
 #include "device.hpp"
 
+#include "Engine/Backend/Vulkan/Core/sampler_cache.hpp"
+#include "Engine/Backend/Vulkan/Core/upload_manager.hpp"
+
 // std headers
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <unordered_set>
 
@@ -47,24 +53,47 @@ void DestroyDebugUtilsMessengerEXT(
 }
 
 // class member functions
-LveDevice::LveDevice(LveWindow &window) : window{window} {
+LveDevice::LveDevice(LveWindow &window) : window{&window} {
   createInstance();
   setupDebugMessenger();
   createSurface();
   pickPhysicalDevice();
   createLogicalDevice();
   createCommandPool();
+  createPipelineCache();
+  createAllocator();
+  uploadManager_ = std::make_unique<LveUploadManager>(*this);
+  samplerCache_ = std::make_unique<LveSamplerCache>(*this);
+}
+
+LveDevice::LveDevice() {
+  createInstance();
+  setupDebugMessenger();
+  pickPhysicalDevice();
+  createLogicalDevice();
+  createCommandPool();
+  createPipelineCache();
+  createAllocator();
+  uploadManager_ = std::make_unique<LveUploadManager>(*this);
+  samplerCache_ = std::make_unique<LveSamplerCache>(*this);
 }
 
 LveDevice::~LveDevice() {
+  samplerCache_.reset();
+  uploadManager_.reset();
+  savePipelineCache();
+  vkDestroyPipelineCache(device_, pipelineCache_, nullptr);
   vkDestroyCommandPool(device_, commandPool, nullptr);
+  allocator_.reset();
   vkDestroyDevice(device_, nullptr);
 
   if (enableValidationLayers) {
     DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
   }
 
-  vkDestroySurfaceKHR(instance, surface_, nullptr);
+  if (surface_ != VK_NULL_HANDLE) {
+    vkDestroySurfaceKHR(instance, surface_, nullptr);
+  }
   vkDestroyInstance(instance, nullptr);
 }
 
@@ -138,6 +167,9 @@ void LveDevice::createLogicalDevice() {
 
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
   std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+  if (indices.transferFamilyHasValue) {
+    uniqueQueueFamilies.insert(indices.transferFamily);
+  }
 
   float queuePriority = 1.0f;
   for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -152,6 +184,12 @@ void LveDevice::createLogicalDevice() {
   VkPhysicalDeviceFeatures deviceFeatures = {};
   deviceFeatures.samplerAnisotropy = VK_TRUE;
   deviceFeatures.fillModeNonSolid = VK_TRUE;
+  VkPhysicalDeviceFeatures supportedFeatures;
+  vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+  if (supportedFeatures.textureCompressionBC) {
+    deviceFeatures.textureCompressionBC = VK_TRUE;
+    blockCompressionSupported = true;
+  }
 
   VkDeviceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -160,8 +198,22 @@ void LveDevice::createLogicalDevice() {
   createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
   createInfo.pEnabledFeatures = &deviceFeatures;
-  createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-  createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+  std::vector<const char *> enabledExtensions;
+  if (!isHeadless()) {
+    enabledExtensions = deviceExtensions;
+  }
+  if (physicalDeviceProperties2Supported &&
+      checkOptionalDeviceExtension(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+    enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    memoryBudgetSupported = true;
+  }
+  const bool updateTemplatesSupported = checkOptionalDeviceExtension(
+      physicalDevice, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+  if (updateTemplatesSupported) {
+    enabledExtensions.push_back(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+  }
+  createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+  createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
   // might not really be necessary anymore because device specific validation layers
   // have been deprecated
@@ -176,8 +228,25 @@ void LveDevice::createLogicalDevice() {
     throw std::runtime_error("failed to create logical device!");
   }
 
+  if (updateTemplatesSupported) {
+    createDescriptorUpdateTemplate_ = reinterpret_cast<PFN_vkCreateDescriptorUpdateTemplateKHR>(
+        vkGetDeviceProcAddr(device_, "vkCreateDescriptorUpdateTemplateKHR"));
+    destroyDescriptorUpdateTemplate_ = reinterpret_cast<PFN_vkDestroyDescriptorUpdateTemplateKHR>(
+        vkGetDeviceProcAddr(device_, "vkDestroyDescriptorUpdateTemplateKHR"));
+    updateDescriptorSetWithTemplate_ = reinterpret_cast<PFN_vkUpdateDescriptorSetWithTemplateKHR>(
+        vkGetDeviceProcAddr(device_, "vkUpdateDescriptorSetWithTemplateKHR"));
+    if (!createDescriptorUpdateTemplate_ || !destroyDescriptorUpdateTemplate_) {
+      updateDescriptorSetWithTemplate_ = nullptr;
+    }
+  }
+
   vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
   vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+  if (indices.transferFamilyHasValue) {
+    vkGetDeviceQueue(device_, indices.transferFamily, 0, &transferQueue_);
+  } else {
+    transferQueue_ = graphicsQueue_;
+  }
 }
 
 void LveDevice::createCommandPool() {
@@ -194,15 +263,120 @@ void LveDevice::createCommandPool() {
   }
 }
 
-void LveDevice::createSurface() { window.createWindowSurface(instance, &surface_); }
+namespace {
+// prefix written in front of the driver blob; VkPipelineCacheHeaderVersionOne has no driver version
+struct PipelineCacheFileHeader {
+  uint32_t magic;
+  uint32_t driverVersion;
+  uint64_t dataSize;
+};
+constexpr uint32_t kPipelineCacheMagic = 0x4C564543;  // "LVEC"
+}  // namespace
+
+void LveDevice::createPipelineCache() {
+  std::vector<char> initialData;
+  std::ifstream file{pipelineCachePath, std::ios::ate | std::ios::binary};
+  if (file.is_open()) {
+    const auto fileSize = static_cast<size_t>(file.tellg());
+    PipelineCacheFileHeader fileHeader{};
+    file.seekg(0);
+    if (fileSize >= sizeof(fileHeader) &&
+        file.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader)) &&
+        fileHeader.magic == kPipelineCacheMagic &&
+        fileHeader.driverVersion == properties.driverVersion &&
+        fileHeader.dataSize == fileSize - sizeof(fileHeader)) {
+      initialData.resize(static_cast<size_t>(fileHeader.dataSize));
+      file.read(initialData.data(), static_cast<std::streamsize>(initialData.size()));
+    }
+    if (!file || !isPipelineCacheCompatible(initialData)) {
+      std::cout << "pipeline cache: discarding stale " << pipelineCachePath << std::endl;
+      initialData.clear();
+    }
+  }
+
+  VkPipelineCacheCreateInfo cacheInfo{};
+  cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  cacheInfo.initialDataSize = initialData.size();
+  cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+  if (vkCreatePipelineCache(device_, &cacheInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+    // a rejected blob is not fatal, start from an empty cache instead
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = nullptr;
+    if (vkCreatePipelineCache(device_, &cacheInfo, nullptr, &pipelineCache_) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create pipeline cache!");
+    }
+  }
+}
+
+bool LveDevice::isPipelineCacheCompatible(const std::vector<char> &data) const {
+  // driver blob starts with VkPipelineCacheHeaderVersionOne
+  if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+    return false;
+  }
+  VkPipelineCacheHeaderVersionOne header{};
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties.vendorID && header.deviceID == properties.deviceID &&
+         std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void LveDevice::savePipelineCache() {
+  if (pipelineCache_ == VK_NULL_HANDLE) {
+    return;
+  }
+  size_t dataSize = 0;
+  if (vkGetPipelineCacheData(device_, pipelineCache_, &dataSize, nullptr) != VK_SUCCESS ||
+      dataSize == 0) {
+    return;
+  }
+  std::vector<char> data(dataSize);
+  if (vkGetPipelineCacheData(device_, pipelineCache_, &dataSize, data.data()) != VK_SUCCESS) {
+    return;
+  }
+
+  // write to a temp file first so a crash mid-write never leaves a truncated cache behind
+  const std::string tempPath = pipelineCachePath + ".tmp";
+  {
+    std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+      std::cerr << "pipeline cache: failed to write " << tempPath << std::endl;
+      return;
+    }
+    PipelineCacheFileHeader fileHeader{};
+    fileHeader.magic = kPipelineCacheMagic;
+    fileHeader.driverVersion = properties.driverVersion;
+    fileHeader.dataSize = dataSize;
+    file.write(reinterpret_cast<const char *>(&fileHeader), sizeof(fileHeader));
+    file.write(data.data(), static_cast<std::streamsize>(dataSize));
+    if (!file) {
+      std::cerr << "pipeline cache: failed to write " << tempPath << std::endl;
+      return;
+    }
+  }
+  std::remove(pipelineCachePath.c_str());
+  if (std::rename(tempPath.c_str(), pipelineCachePath.c_str()) != 0) {
+    std::cerr << "pipeline cache: failed to replace " << pipelineCachePath << std::endl;
+  }
+}
+
+void LveDevice::createAllocator() {
+  allocator_ = std::make_unique<LveMemoryAllocator>(
+      instance, physicalDevice, device_, memoryBudgetSupported);
+}
+
+void LveDevice::createSurface() { window->createWindowSurface(instance, &surface_); }
 
 bool LveDevice::isDeviceSuitable(VkPhysicalDevice device) {
   QueueFamilyIndices indices = findQueueFamilies(device);
 
   bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-  bool swapChainAdequate = false;
-  if (extensionsSupported) {
+  // nothing is presented without a surface
+  bool swapChainAdequate = isHeadless();
+  if (extensionsSupported && !isHeadless()) {
     SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
     swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
   }
@@ -262,18 +436,56 @@ bool LveDevice::checkValidationLayerSupport() {
 }
 
 std::vector<const char *> LveDevice::getRequiredExtensions() {
-  std::vector<const char *> extensions = window.getRequiredInstanceExtensions();
-  if (extensions.empty()) {
-    throw std::runtime_error("GLFW did not return required Vulkan instance extensions");
+  std::vector<const char *> extensions;
+  if (!isHeadless()) {
+    extensions = window->getRequiredInstanceExtensions();
+    if (extensions.empty()) {
+      throw std::runtime_error("GLFW did not return required Vulkan instance extensions");
+    }
   }
 
   if (enableValidationLayers) {
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
   }
 
+  // optional, needed for VK_EXT_memory_budget on a 1.0 instance
+  physicalDeviceProperties2Supported =
+      checkInstanceExtensionSupport(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+  if (physicalDeviceProperties2Supported) {
+    extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+  }
+
   return extensions;
 }
 
+bool LveDevice::checkInstanceExtensionSupport(const char *extensionName) {
+  uint32_t extensionCount = 0;
+  vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+  std::vector<VkExtensionProperties> extensions(extensionCount);
+  vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+
+  for (const auto &extension : extensions) {
+    if (strcmp(extension.extensionName, extensionName) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LveDevice::checkOptionalDeviceExtension(VkPhysicalDevice device, const char *extensionName) {
+  uint32_t extensionCount = 0;
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+  std::vector<VkExtensionProperties> extensions(extensionCount);
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+
+  for (const auto &extension : extensions) {
+    if (strcmp(extension.extensionName, extensionName) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void LveDevice::hasGflwRequiredInstanceExtensions() {
   uint32_t extensionCount = 0;
   vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
@@ -298,6 +510,10 @@ void LveDevice::hasGflwRequiredInstanceExtensions() {
 }
 
 bool LveDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
+  if (isHeadless()) {
+    return true;
+  }
+
   uint32_t extensionCount;
   vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
@@ -333,7 +549,11 @@ QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
       indices.graphicsFamilyHasValue = true;
     }
     VkBool32 presentSupport = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+    if (isHeadless()) {
+      presentSupport = indices.graphicsFamilyHasValue && indices.graphicsFamily == static_cast<uint32_t>(i);
+    } else {
+      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+    }
     if (queueFamily.queueCount > 0 && presentSupport) {
       indices.presentFamily = i;
       indices.presentFamilyHasValue = true;
@@ -345,11 +565,25 @@ QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
     i++;
   }
 
+  // a transfer-only family is usually a DMA engine that can copy while graphics runs
+  for (uint32_t family = 0; family < queueFamilyCount; family++) {
+    const VkQueueFlags flags = queueFamilies[family].queueFlags;
+    if (queueFamilies[family].queueCount > 0 && (flags & VK_QUEUE_TRANSFER_BIT) &&
+        !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+      indices.transferFamily = family;
+      indices.transferFamilyHasValue = true;
+      break;
+    }
+  }
+
   return indices;
 }
 
 SwapChainSupportDetails LveDevice::querySwapChainSupport(VkPhysicalDevice device) {
-  SwapChainSupportDetails details;
+  SwapChainSupportDetails details{};
+  if (isHeadless()) {
+    return details;
+  }
   vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface_, &details.capabilities);
 
   uint32_t formatCount;
@@ -390,17 +624,18 @@ VkFormat LveDevice::findSupportedFormat(
   throw std::runtime_error("failed to find supported format!");
 }
 
-uint32_t LveDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-  VkPhysicalDeviceMemoryProperties memProperties;
-  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-    if ((typeFilter & (1 << i)) &&
-        (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-      return i;
-    }
-  }
+bool LveDevice::formatSupportsFeatures(
+    VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) {
+  VkFormatProperties props;
+  vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+  const VkFormatFeatureFlags supported = tiling == VK_IMAGE_TILING_LINEAR
+                                             ? props.linearTilingFeatures
+                                             : props.optimalTilingFeatures;
+  return (supported & features) == features;
+}
 
-  throw std::runtime_error("failed to find suitable memory type!");
+uint32_t LveDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+  return allocator_->findMemoryType(typeFilter, properties);
 }
 
 void LveDevice::createBuffer(
@@ -408,7 +643,8 @@ void LveDevice::createBuffer(
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer &buffer,
-    VkDeviceMemory &bufferMemory) {
+    LveAllocation &bufferMemory,
+    MemoryStrategy strategy) {
   VkBufferCreateInfo bufferInfo{};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.size = size;
@@ -422,16 +658,17 @@ void LveDevice::createBuffer(
   VkMemoryRequirements memRequirements;
   vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate vertex buffer memory!");
+  bufferMemory = allocator_->allocate(memRequirements, properties, false, strategy);
+  if (vkBindBufferMemory(device_, buffer, bufferMemory.memory, bufferMemory.offset) != VK_SUCCESS) {
+    throw std::runtime_error("failed to bind buffer memory!");
   }
+}
 
-  vkBindBufferMemory(device_, buffer, bufferMemory, 0);
+void LveDevice::destroyBuffer(VkBuffer buffer, LveAllocation &bufferMemory) {
+  if (buffer != VK_NULL_HANDLE) {
+    vkDestroyBuffer(device_, buffer, nullptr);
+  }
+  allocator_->free(bufferMemory);
 }
 
 VkCommandBuffer LveDevice::beginSingleTimeCommands() {
@@ -460,9 +697,18 @@ void LveDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
   submitInfo.commandBufferCount = 1;
   submitInfo.pCommandBuffers = &commandBuffer;
 
-  vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphicsQueue_);
+  // wait on this submission only, not on whatever frames are queued ahead of it
+  VkFenceCreateInfo fenceInfo{};
+  fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  VkFence fence;
+  if (vkCreateFence(device_, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create single time command fence!");
+  }
+
+  vkQueueSubmit(graphicsQueue_, 1, &submitInfo, fence);
+  vkWaitForFences(device_, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
 
+  vkDestroyFence(device_, fence, nullptr);
   vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
 }
 
@@ -509,7 +755,8 @@ void LveDevice::createImageWithInfo(
     const VkImageCreateInfo &imageInfo,
     VkMemoryPropertyFlags properties,
     VkImage &image,
-    VkDeviceMemory &imageMemory) {
+    LveAllocation &imageMemory,
+    MemoryStrategy strategy) {
   if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
@@ -517,20 +764,49 @@ void LveDevice::createImageWithInfo(
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device_, image, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate image memory!");
+  // render targets get recreated on resize, keep them out of the shared blocks
+  const VkImageUsageFlags attachmentUsage =
+      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+  if (strategy == MemoryStrategy::Default && (imageInfo.usage & attachmentUsage)) {
+    strategy = MemoryStrategy::Dedicated;
   }
 
-  if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
+  imageMemory = allocator_->allocate(
+      memRequirements,
+      properties,
+      imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL,
+      strategy);
+  if (vkBindImageMemory(device_, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS) {
     throw std::runtime_error("failed to bind image memory!");
   }
 }
 
+VkDescriptorUpdateTemplateKHR LveDevice::createDescriptorUpdateTemplate(
+    const VkDescriptorUpdateTemplateCreateInfoKHR &templateInfo) {
+  VkDescriptorUpdateTemplateKHR updateTemplate = VK_NULL_HANDLE;
+  if (createDescriptorUpdateTemplate_(device_, &templateInfo, nullptr, &updateTemplate) !=
+      VK_SUCCESS) {
+    throw std::runtime_error("failed to create descriptor update template!");
+  }
+  return updateTemplate;
+}
+
+void LveDevice::destroyDescriptorUpdateTemplate(VkDescriptorUpdateTemplateKHR updateTemplate) {
+  destroyDescriptorUpdateTemplate_(device_, updateTemplate, nullptr);
+}
+
+void LveDevice::updateDescriptorSetWithTemplate(
+    VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplateKHR updateTemplate, const void *data) {
+  updateDescriptorSetWithTemplate_(device_, descriptorSet, updateTemplate, data);
+}
+
+void LveDevice::destroyImage(VkImage image, LveAllocation &imageMemory) {
+  if (image != VK_NULL_HANDLE) {
+    vkDestroyImage(device_, image, nullptr);
+  }
+  allocator_->free(imageMemory);
+}
+
 void LveDevice::transitionImageLayout(
   VkImage image,
   VkFormat format,
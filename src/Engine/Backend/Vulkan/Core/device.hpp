@@ -1,13 +1,18 @@
 #pragma once
 
+#include "Engine/Backend/Vulkan/Core/memory_allocator.hpp"
 #include "Engine/Backend/Window/window.hpp"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace lve {
 
+class LveSamplerCache;
+class LveUploadManager;
+
 struct SwapChainSupportDetails {
   VkSurfaceCapabilitiesKHR capabilities;
   std::vector<VkSurfaceFormatKHR> formats;
@@ -17,8 +22,10 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
   uint32_t graphicsFamily;
   uint32_t presentFamily;
+  uint32_t transferFamily;  // only set for a dedicated (non-graphics) transfer family
   bool graphicsFamilyHasValue = false;
   bool presentFamilyHasValue = false;
+  bool transferFamilyHasValue = false;
   bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
 };
 
@@ -31,6 +38,8 @@ class LveDevice {
 #endif
 
   LveDevice(LveWindow &window);
+  // headless: no surface, no swapchain extension, presentQueue() is the graphics queue
+  LveDevice();
   ~LveDevice();
 
   // Not copyable or movable
@@ -42,8 +51,19 @@ class LveDevice {
   VkCommandPool getCommandPool() { return commandPool; }
   VkDevice device() { return device_; }
   VkSurfaceKHR surface() { return surface_; }
+  bool isHeadless() const { return window == nullptr; }
   VkQueue graphicsQueue() { return graphicsQueue_; }
   VkQueue presentQueue() { return presentQueue_; }
+  // falls back to the graphics queue when there is no dedicated transfer family
+  VkQueue transferQueue() { return transferQueue_; }
+  VkPipelineCache pipelineCache() { return pipelineCache_; }
+  LveMemoryAllocator &allocator() { return *allocator_; }
+  LveUploadManager &uploads() { return *uploadManager_; }
+  LveSamplerCache &samplers() { return *samplerCache_; }
+  bool hasMemoryBudget() const { return memoryBudgetSupported; }
+  bool hasBlockCompression() const { return blockCompressionSupported; }
+  // VK_KHR_descriptor_update_template, optional on a 1.0 device
+  bool hasDescriptorUpdateTemplates() const { return updateDescriptorSetWithTemplate_ != nullptr; }
   // Expose Vulkan handles for subsystems that need them (e.g., ImGui init)
   VkInstance getInstance() { return instance; }
   VkPhysicalDevice getPhysicalDevice() { return physicalDevice; }
@@ -53,6 +73,7 @@ class LveDevice {
   QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
   VkFormat findSupportedFormat(
       const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+  bool formatSupportsFeatures(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features);
 
   // Buffer Helper Functions
   void createBuffer(
@@ -60,7 +81,9 @@ class LveDevice {
       VkBufferUsageFlags usage,
       VkMemoryPropertyFlags properties,
       VkBuffer &buffer,
-      VkDeviceMemory &bufferMemory);
+      LveAllocation &bufferMemory,
+      MemoryStrategy strategy = MemoryStrategy::Default);
+  void destroyBuffer(VkBuffer buffer, LveAllocation &bufferMemory);
   VkCommandBuffer beginSingleTimeCommands();
   void endSingleTimeCommands(VkCommandBuffer commandBuffer);
   void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
@@ -71,7 +94,16 @@ class LveDevice {
       const VkImageCreateInfo &imageInfo,
       VkMemoryPropertyFlags properties,
       VkImage &image,
-      VkDeviceMemory &imageMemory);
+      LveAllocation &imageMemory,
+      MemoryStrategy strategy = MemoryStrategy::Default);
+  void destroyImage(VkImage image, LveAllocation &imageMemory);
+
+  // only valid when hasDescriptorUpdateTemplates()
+  VkDescriptorUpdateTemplateKHR createDescriptorUpdateTemplate(
+      const VkDescriptorUpdateTemplateCreateInfoKHR &templateInfo);
+  void destroyDescriptorUpdateTemplate(VkDescriptorUpdateTemplateKHR updateTemplate);
+  void updateDescriptorSetWithTemplate(
+      VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplateKHR updateTemplate, const void *data);
 
   void transitionImageLayout(
       VkImage image,
@@ -81,6 +113,9 @@ class LveDevice {
       uint32_t mipLevels = 1,
       uint32_t layerCount = 1);
 
+  // Pipeline cache is loaded on construction and written back on destruction
+  void savePipelineCache();
+
   VkPhysicalDeviceProperties properties;
 
  private:
@@ -90,6 +125,8 @@ class LveDevice {
   void pickPhysicalDevice();
   void createLogicalDevice();
   void createCommandPool();
+  void createPipelineCache();
+  void createAllocator();
 
   // helper functions
   bool isDeviceSuitable(VkPhysicalDevice device);
@@ -99,21 +136,36 @@ class LveDevice {
   void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
   void hasGflwRequiredInstanceExtensions();
   bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+  bool checkInstanceExtensionSupport(const char *extensionName);
+  bool checkOptionalDeviceExtension(VkPhysicalDevice device, const char *extensionName);
   SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
+  bool isPipelineCacheCompatible(const std::vector<char> &data) const;
 
   VkInstance instance;
   VkDebugUtilsMessengerEXT debugMessenger;
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-  LveWindow &window;
+  LveWindow *window = nullptr;
   VkCommandPool commandPool;
 
   VkDevice device_;
-  VkSurfaceKHR surface_;
+  VkSurfaceKHR surface_ = VK_NULL_HANDLE;
   VkQueue graphicsQueue_;
   VkQueue presentQueue_;
+  VkQueue transferQueue_;
+  VkPipelineCache pipelineCache_ = VK_NULL_HANDLE;
+  std::unique_ptr<LveMemoryAllocator> allocator_;
+  std::unique_ptr<LveUploadManager> uploadManager_;
+  std::unique_ptr<LveSamplerCache> samplerCache_;
+  bool physicalDeviceProperties2Supported = false;
+  bool memoryBudgetSupported = false;
+  bool blockCompressionSupported = false;
+  PFN_vkCreateDescriptorUpdateTemplateKHR createDescriptorUpdateTemplate_ = nullptr;
+  PFN_vkDestroyDescriptorUpdateTemplateKHR destroyDescriptorUpdateTemplate_ = nullptr;
+  PFN_vkUpdateDescriptorSetWithTemplateKHR updateDescriptorSetWithTemplate_ = nullptr;
 
   const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
   const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+  const std::string pipelineCachePath = "pipeline_cache.bin";
 };
 
 }  // namespace lve
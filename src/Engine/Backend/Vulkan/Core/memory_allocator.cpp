@@ -0,0 +1,461 @@
+#include "memory_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+constexpr VkDeviceSize kMinBuddyNode = 256;
+constexpr VkDeviceSize kLargeHeapBlockSize = 64ull * 1024 * 1024;
+constexpr VkDeviceSize kMinBlockSize = 1ull * 1024 * 1024;
+constexpr VkDeviceSize kLargeHeapThreshold = 1ull * 1024 * 1024 * 1024;
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+VkDeviceSize floorPowerOfTwo(VkDeviceSize value) {
+  VkDeviceSize result = 1;
+  while (result * 2 <= value) {
+    result *= 2;
+  }
+  return result;
+}
+
+size_t strategyIndex(MemoryStrategy strategy) { return strategy == MemoryStrategy::Linear ? 1 : 0; }
+
+}  // namespace
+
+struct LveMemoryBlock {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize size = 0;
+  void *mapped = nullptr;
+  uint32_t memoryTypeIndex = 0;
+  MemoryStrategy strategy = MemoryStrategy::Default;
+  bool optimalImage = false;
+  uint32_t allocationCount = 0;
+  VkDeviceSize usedBytes = 0;
+
+  // buddy: free node offsets per order, order n nodes are kMinBuddyNode << n bytes
+  std::vector<std::set<VkDeviceSize>> freeLists;
+  // linear: bump pointer, rewound when the block empties
+  VkDeviceSize linearHead = 0;
+};
+
+LveMemoryAllocator::LveMemoryAllocator(
+    VkInstance instance,
+    VkPhysicalDevice physicalDevice,
+    VkDevice device,
+    bool memoryBudgetSupported)
+    : physicalDevice{physicalDevice}, device{device} {
+  vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+  VkPhysicalDeviceProperties properties;
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+  maxDeviceMemoryCount = properties.limits.maxMemoryAllocationCount;
+
+  if (memoryBudgetSupported) {
+    getMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(
+        vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+  }
+
+  pools.resize(static_cast<size_t>(memoryProperties.memoryTypeCount) * 4);
+}
+
+LveMemoryAllocator::~LveMemoryAllocator() {
+  uint32_t leaked = 0;
+  for (auto &pool : pools) {
+    for (auto &block : pool.blocks) {
+      leaked += block->allocationCount;
+      destroyBlock(*block);
+    }
+    pool.blocks.clear();
+  }
+  for (auto &block : dedicatedBlocks) {
+    leaked += block->allocationCount;
+    destroyBlock(*block);
+  }
+  dedicatedBlocks.clear();
+
+  if (leaked > 0) {
+    std::cerr << "memory allocator: " << leaked << " allocation(s) still alive at shutdown\n";
+  }
+}
+
+uint32_t LveMemoryAllocator::findMemoryType(
+    uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+  for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+    if ((typeFilter & (1 << i)) &&
+        (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+
+  throw std::runtime_error("failed to find suitable memory type!");
+}
+
+LveAllocation LveMemoryAllocator::allocate(
+    const VkMemoryRequirements &requirements,
+    VkMemoryPropertyFlags properties,
+    bool optimalImage,
+    MemoryStrategy strategy) {
+  std::lock_guard<std::mutex> lock{mutex};
+
+  const uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+  const VkDeviceSize alignment = requiredAlignment(memoryTypeIndex, requirements.alignment);
+  const VkDeviceSize blockSize = preferredBlockSize(memoryTypeIndex);
+
+  // anything that would take more than half a block is cheaper on its own
+  if (strategy != MemoryStrategy::Dedicated && std::max(requirements.size, alignment) > blockSize / 2) {
+    strategy = MemoryStrategy::Dedicated;
+  }
+
+  LveAllocation allocation{};
+  allocation.memoryTypeIndex = memoryTypeIndex;
+  allocation.size = requirements.size;
+
+  if (strategy == MemoryStrategy::Dedicated) {
+    auto block = createBlock(
+        memoryTypeIndex, requirements.size, requirements.size, MemoryStrategy::Dedicated, optimalImage);
+    block->allocationCount = 1;
+    block->usedBytes = requirements.size;
+    allocation.memory = block->memory;
+    allocation.mapped = block->mapped;
+    allocation.block = block.get();
+    dedicatedBlocks.push_back(std::move(block));
+    return allocation;
+  }
+
+  BlockPool &pool = poolFor(memoryTypeIndex, optimalImage, strategy);
+  for (auto &block : pool.blocks) {
+    if (allocateFromBlock(*block, requirements.size, alignment, allocation)) {
+      return allocation;
+    }
+  }
+
+  VkDeviceSize minSize = kMinBuddyNode;
+  while (minSize < std::max(requirements.size, alignment)) {
+    minSize <<= 1;
+  }
+  auto block = createBlock(memoryTypeIndex, blockSize, minSize, strategy, optimalImage);
+  if (!allocateFromBlock(*block, requirements.size, alignment, allocation)) {
+    destroyBlock(*block);
+    throw std::runtime_error("failed to suballocate from a new memory block!");
+  }
+  pool.blocks.push_back(std::move(block));
+  return allocation;
+}
+
+void LveMemoryAllocator::free(LveAllocation &allocation) {
+  if (allocation.block == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{mutex};
+  LveMemoryBlock *block = allocation.block;
+
+  if (block->strategy == MemoryStrategy::Dedicated) {
+    auto it = std::find_if(dedicatedBlocks.begin(), dedicatedBlocks.end(), [block](const auto &entry) {
+      return entry.get() == block;
+    });
+    if (it != dedicatedBlocks.end()) {
+      destroyBlock(**it);
+      dedicatedBlocks.erase(it);
+    }
+    allocation = LveAllocation{};
+    return;
+  }
+
+  releaseFromBlock(*block, allocation);
+  allocation = LveAllocation{};
+
+  if (block->allocationCount > 0) {
+    return;
+  }
+
+  // keep a single empty block per pool around so alloc/free churn doesn't hit the driver
+  BlockPool &pool = poolFor(block->memoryTypeIndex, block->optimalImage, block->strategy);
+  const bool anotherEmpty = std::any_of(pool.blocks.begin(), pool.blocks.end(), [block](const auto &entry) {
+    return entry.get() != block && entry->allocationCount == 0;
+  });
+  if (anotherEmpty) {
+    auto it = std::find_if(pool.blocks.begin(), pool.blocks.end(), [block](const auto &entry) {
+      return entry.get() == block;
+    });
+    destroyBlock(**it);
+    pool.blocks.erase(it);
+  }
+}
+
+VkResult LveMemoryAllocator::flush(
+    const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size) {
+  if (allocation.block == nullptr || isCoherent(allocation.memoryTypeIndex)) {
+    return VK_SUCCESS;
+  }
+  const VkMappedMemoryRange range = mappedRange(allocation, offset, size);
+  return vkFlushMappedMemoryRanges(device, 1, &range);
+}
+
+VkResult LveMemoryAllocator::invalidate(
+    const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size) {
+  if (allocation.block == nullptr || isCoherent(allocation.memoryTypeIndex)) {
+    return VK_SUCCESS;
+  }
+  const VkMappedMemoryRange range = mappedRange(allocation, offset, size);
+  return vkInvalidateMappedMemoryRanges(device, 1, &range);
+}
+
+MemoryStats LveMemoryAllocator::queryStats() {
+  std::lock_guard<std::mutex> lock{mutex};
+
+  MemoryStats stats{};
+  stats.heaps.resize(memoryProperties.memoryHeapCount);
+  stats.deviceMemoryCount = deviceMemoryCount;
+  stats.maxDeviceMemoryCount = maxDeviceMemoryCount;
+  for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+    stats.heaps[i].heapSize = memoryProperties.memoryHeaps[i].size;
+  }
+
+  auto addBlock = [&](const LveMemoryBlock &block) {
+    MemoryHeapStats &heap = stats.heaps[memoryProperties.memoryTypes[block.memoryTypeIndex].heapIndex];
+    heap.blockBytes += block.size;
+    heap.usedBytes += block.usedBytes;
+    heap.allocationCount += block.allocationCount;
+    if (block.strategy == MemoryStrategy::Dedicated) {
+      heap.dedicatedCount++;
+    } else {
+      heap.blockCount++;
+    }
+  };
+  for (const auto &pool : pools) {
+    for (const auto &block : pool.blocks) {
+      addBlock(*block);
+    }
+  }
+  for (const auto &block : dedicatedBlocks) {
+    addBlock(*block);
+  }
+
+  if (getMemoryProperties2 != nullptr) {
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2KHR properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+    properties2.pNext = &budgetProperties;
+    getMemoryProperties2(physicalDevice, &properties2);
+
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+      stats.heaps[i].budget = budgetProperties.heapBudget[i];
+      stats.heaps[i].usage = budgetProperties.heapUsage[i];
+    }
+    stats.budgetFromDriver = true;
+  } else {
+    // without the extension assume the usual 80% of the heap is available to us
+    for (auto &heap : stats.heaps) {
+      heap.budget = heap.heapSize / 10 * 8;
+      heap.usage = heap.blockBytes;
+    }
+  }
+  return stats;
+}
+
+std::unique_ptr<LveMemoryBlock> LveMemoryAllocator::createBlock(
+    uint32_t memoryTypeIndex,
+    VkDeviceSize size,
+    VkDeviceSize minSize,
+    MemoryStrategy strategy,
+    bool optimalImage) {
+  if (maxDeviceMemoryCount > 0 && deviceMemoryCount >= maxDeviceMemoryCount) {
+    throw std::runtime_error("maxMemoryAllocationCount reached!");
+  }
+
+  auto block = std::make_unique<LveMemoryBlock>();
+  block->memoryTypeIndex = memoryTypeIndex;
+  block->strategy = strategy;
+  block->optimalImage = optimalImage;
+
+  VkMemoryAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.memoryTypeIndex = memoryTypeIndex;
+  while (true) {
+    allocInfo.allocationSize = size;
+    const VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &block->memory);
+    if (result == VK_SUCCESS) {
+      break;
+    }
+    const bool outOfMemory =
+        result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY;
+    if (!outOfMemory || size / 2 < minSize) {
+      throw std::runtime_error("failed to allocate device memory block!");
+    }
+    size /= 2;
+  }
+  block->size = size;
+  deviceMemoryCount++;
+
+  if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags &
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+    if (vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) != VK_SUCCESS) {
+      destroyBlock(*block);
+      throw std::runtime_error("failed to map device memory block!");
+    }
+  }
+
+  if (strategy == MemoryStrategy::Default) {
+    uint32_t maxOrder = 0;
+    while ((kMinBuddyNode << (maxOrder + 1)) <= size) {
+      maxOrder++;
+    }
+    block->freeLists.resize(maxOrder + 1);
+    block->freeLists[maxOrder].insert(0);
+  }
+  return block;
+}
+
+void LveMemoryAllocator::destroyBlock(LveMemoryBlock &block) {
+  if (block.memory == VK_NULL_HANDLE) {
+    return;
+  }
+  if (block.mapped != nullptr) {
+    vkUnmapMemory(device, block.memory);
+    block.mapped = nullptr;
+  }
+  vkFreeMemory(device, block.memory, nullptr);
+  block.memory = VK_NULL_HANDLE;
+  deviceMemoryCount--;
+}
+
+bool LveMemoryAllocator::allocateFromBlock(
+    LveMemoryBlock &block, VkDeviceSize size, VkDeviceSize alignment, LveAllocation &out) {
+  VkDeviceSize offset = 0;
+
+  if (block.strategy == MemoryStrategy::Linear) {
+    offset = alignUp(block.linearHead, alignment);
+    if (offset + size > block.size) {
+      return false;
+    }
+    block.linearHead = offset + size;
+    out.blockOffset = offset;
+  } else {
+    // buddy nodes are aligned to their own size, so a node >= alignment satisfies it
+    VkDeviceSize nodeSize = kMinBuddyNode;
+    uint32_t order = 0;
+    while (nodeSize < std::max(size, alignment)) {
+      nodeSize <<= 1;
+      order++;
+    }
+    if (order >= block.freeLists.size()) {
+      return false;
+    }
+
+    uint32_t level = order;
+    while (level < block.freeLists.size() && block.freeLists[level].empty()) {
+      level++;
+    }
+    if (level == block.freeLists.size()) {
+      return false;
+    }
+
+    offset = *block.freeLists[level].begin();
+    block.freeLists[level].erase(block.freeLists[level].begin());
+    while (level > order) {
+      level--;
+      block.freeLists[level].insert(offset + (kMinBuddyNode << level));
+    }
+    out.blockOffset = offset;
+    out.order = order;
+  }
+
+  block.allocationCount++;
+  block.usedBytes += size;
+
+  out.memory = block.memory;
+  out.offset = offset;
+  out.mapped = block.mapped != nullptr ? static_cast<char *>(block.mapped) + offset : nullptr;
+  out.block = &block;
+  return true;
+}
+
+void LveMemoryAllocator::releaseFromBlock(LveMemoryBlock &block, const LveAllocation &allocation) {
+  block.allocationCount--;
+  block.usedBytes -= allocation.size;
+
+  if (block.strategy == MemoryStrategy::Linear) {
+    if (block.allocationCount == 0) {
+      block.linearHead = 0;
+    } else if (allocation.offset + allocation.size == block.linearHead) {
+      block.linearHead = allocation.blockOffset;
+    }
+    return;
+  }
+
+  VkDeviceSize offset = allocation.blockOffset;
+  uint32_t order = allocation.order;
+  while (order + 1 < block.freeLists.size()) {
+    const VkDeviceSize buddy = offset ^ (kMinBuddyNode << order);
+    auto it = block.freeLists[order].find(buddy);
+    if (it == block.freeLists[order].end()) {
+      break;
+    }
+    block.freeLists[order].erase(it);
+    offset = std::min(offset, buddy);
+    order++;
+  }
+  block.freeLists[order].insert(offset);
+}
+
+LveMemoryAllocator::BlockPool &LveMemoryAllocator::poolFor(
+    uint32_t memoryTypeIndex, bool optimalImage, MemoryStrategy strategy) {
+  const size_t index = static_cast<size_t>(memoryTypeIndex) * 4 + (optimalImage ? 2 : 0) +
+                       strategyIndex(strategy);
+  return pools[index];
+}
+
+VkDeviceSize LveMemoryAllocator::preferredBlockSize(uint32_t memoryTypeIndex) const {
+  const uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+  const VkDeviceSize heapSize = memoryProperties.memoryHeaps[heapIndex].size;
+  if (heapSize > kLargeHeapThreshold) {
+    return kLargeHeapBlockSize;
+  }
+  return std::max(kMinBlockSize, floorPowerOfTwo(heapSize / 8));
+}
+
+VkDeviceSize LveMemoryAllocator::requiredAlignment(
+    uint32_t memoryTypeIndex, VkDeviceSize alignment) const {
+  alignment = std::max<VkDeviceSize>(alignment, 1);
+  const VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+  if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !isCoherent(memoryTypeIndex)) {
+    // flush/invalidate ranges are widened to nonCoherentAtomSize
+    alignment = std::max(alignment, nonCoherentAtomSize);
+  }
+  return alignment;
+}
+
+bool LveMemoryAllocator::isCoherent(uint32_t memoryTypeIndex) const {
+  return (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags &
+          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+VkMappedMemoryRange LveMemoryAllocator::mappedRange(
+    const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size) const {
+  VkDeviceSize begin = allocation.offset + offset;
+  VkDeviceSize end =
+      size == VK_WHOLE_SIZE ? allocation.offset + allocation.size : begin + size;
+  begin = begin / nonCoherentAtomSize * nonCoherentAtomSize;
+  end = alignUp(end, nonCoherentAtomSize);
+
+  VkMappedMemoryRange range{};
+  range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  range.memory = allocation.memory;
+  range.offset = begin;
+  range.size = end >= allocation.block->size ? VK_WHOLE_SIZE : end - begin;
+  return range;
+}
+
+}  // namespace lve
@@ -0,0 +1,124 @@
+#pragma once
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+// Default: buddy suballocation from shared blocks, good for long lived resources.
+// Linear: bump allocation, the block rewinds once everything in it is freed (staging, transient).
+// Dedicated: one VkDeviceMemory for the resource (render targets, very large images).
+enum class MemoryStrategy {
+  Default,
+  Linear,
+  Dedicated
+};
+
+struct LveMemoryBlock;
+
+struct LveAllocation {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+  void *mapped = nullptr;  // persistently mapped when the memory type is host visible
+  uint32_t memoryTypeIndex = 0;
+
+  explicit operator bool() const { return memory != VK_NULL_HANDLE; }
+
+ private:
+  friend class LveMemoryAllocator;
+  LveMemoryBlock *block = nullptr;
+  VkDeviceSize blockOffset = 0;  // start of the buddy node, may differ from offset
+  uint32_t order = 0;
+};
+
+struct MemoryHeapStats {
+  VkDeviceSize heapSize = 0;
+  VkDeviceSize blockBytes = 0;  // bytes owned through vkAllocateMemory
+  VkDeviceSize usedBytes = 0;   // bytes handed out to resources
+  uint32_t blockCount = 0;
+  uint32_t dedicatedCount = 0;
+  uint32_t allocationCount = 0;
+  // from VK_EXT_memory_budget when available, otherwise estimated from heapSize / blockBytes
+  VkDeviceSize budget = 0;
+  VkDeviceSize usage = 0;
+};
+
+struct MemoryStats {
+  std::vector<MemoryHeapStats> heaps;
+  uint32_t deviceMemoryCount = 0;
+  uint32_t maxDeviceMemoryCount = 0;
+  bool budgetFromDriver = false;
+};
+
+class LveMemoryAllocator {
+ public:
+  LveMemoryAllocator(
+      VkInstance instance,
+      VkPhysicalDevice physicalDevice,
+      VkDevice device,
+      bool memoryBudgetSupported);
+  ~LveMemoryAllocator();
+
+  LveMemoryAllocator(const LveMemoryAllocator &) = delete;
+  LveMemoryAllocator &operator=(const LveMemoryAllocator &) = delete;
+
+  // optimalImage keeps tiled images out of buffer blocks so bufferImageGranularity never applies
+  LveAllocation allocate(
+      const VkMemoryRequirements &requirements,
+      VkMemoryPropertyFlags properties,
+      bool optimalImage,
+      MemoryStrategy strategy = MemoryStrategy::Default);
+  void free(LveAllocation &allocation);
+
+  // offset/size are relative to the allocation, no-ops on coherent memory
+  VkResult flush(const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size);
+  VkResult invalidate(const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size);
+
+  uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+  MemoryStats queryStats();
+
+ private:
+  struct BlockPool {
+    std::vector<std::unique_ptr<LveMemoryBlock>> blocks;
+  };
+
+  // on out-of-memory the block is halved until it would drop below minSize
+  std::unique_ptr<LveMemoryBlock> createBlock(
+      uint32_t memoryTypeIndex,
+      VkDeviceSize size,
+      VkDeviceSize minSize,
+      MemoryStrategy strategy,
+      bool optimalImage);
+  void destroyBlock(LveMemoryBlock &block);
+  BlockPool &poolFor(uint32_t memoryTypeIndex, bool optimalImage, MemoryStrategy strategy);
+  VkDeviceSize preferredBlockSize(uint32_t memoryTypeIndex) const;
+  VkDeviceSize requiredAlignment(uint32_t memoryTypeIndex, VkDeviceSize alignment) const;
+  bool isCoherent(uint32_t memoryTypeIndex) const;
+  VkMappedMemoryRange mappedRange(
+      const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+  bool allocateFromBlock(
+      LveMemoryBlock &block, VkDeviceSize size, VkDeviceSize alignment, LveAllocation &out);
+  void releaseFromBlock(LveMemoryBlock &block, const LveAllocation &allocation);
+
+  VkPhysicalDevice physicalDevice;
+  VkDevice device;
+  PFN_vkGetPhysicalDeviceMemoryProperties2KHR getMemoryProperties2 = nullptr;
+  VkPhysicalDeviceMemoryProperties memoryProperties{};
+  VkDeviceSize nonCoherentAtomSize = 1;
+  uint32_t maxDeviceMemoryCount = 0;
+
+  std::mutex mutex;
+  std::vector<BlockPool> pools;  // memoryTypeCount * 2 (buffer/optimal image) * 2 (buddy/linear)
+  std::vector<std::unique_ptr<LveMemoryBlock>> dedicatedBlocks;
+  uint32_t deviceMemoryCount = 0;
+};
+
+}  // namespace lve
@@ -6,7 +6,9 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
 
 #ifndef ENGINE_DIR
 #define ENGINE_DIR ""
@@ -47,6 +49,24 @@ std::vector<char> LvePipeline::readFile(const std::string& filepath) {
   return buffer;
 }
 
+std::shared_ptr<const std::vector<char>> LvePipeline::loadShaderCode(const std::string& filepath) {
+  static std::mutex cacheMutex;
+  static std::unordered_map<std::string, std::shared_ptr<const std::vector<char>>> codeCache;
+
+  {
+    std::lock_guard<std::mutex> lock{cacheMutex};
+    auto it = codeCache.find(filepath);
+    if (it != codeCache.end()) {
+      return it->second;
+    }
+  }
+
+  // read outside the lock so parallel pipeline jobs don't serialize on disk IO
+  auto code = std::make_shared<const std::vector<char>>(readFile(filepath));
+  std::lock_guard<std::mutex> lock{cacheMutex};
+  return codeCache.emplace(filepath, std::move(code)).first->second;
+}
+
 void LvePipeline::createGraphicsPipeline(
     const std::string& vertFilepath,
     const std::string& fragFilepath,
@@ -58,11 +78,11 @@ void LvePipeline::createGraphicsPipeline(
       configInfo.renderPass != VK_NULL_HANDLE &&
       "Cannot create graphics pipeline: no renderPass provided in configInfo");
 
-  auto vertCode = readFile(vertFilepath);
-  auto fragCode = readFile(fragFilepath);
+  auto vertCode = loadShaderCode(vertFilepath);
+  auto fragCode = loadShaderCode(fragFilepath);
 
-  createShaderModule(vertCode, &vertShaderModule);
-  createShaderModule(fragCode, &fragShaderModule);
+  createShaderModule(*vertCode, &vertShaderModule);
+  createShaderModule(*fragCode, &fragShaderModule);
 
   VkPipelineShaderStageCreateInfo shaderStages[2];
   shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -112,7 +132,7 @@ void LvePipeline::createGraphicsPipeline(
 
   if (vkCreateGraphicsPipelines(
           lveDevice.device(),
-          VK_NULL_HANDLE,
+          lveDevice.pipelineCache(),
           1,
           &pipelineInfo,
           nullptr,
@@ -3,6 +3,7 @@
 #include "device.hpp"
 
 // std
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -48,6 +49,8 @@ class LvePipeline {
 
  private:
   static std::vector<char> readFile(const std::string& filepath);
+  // SPIR-V is read from disk once per path and shared by every pipeline (thread-safe)
+  static std::shared_ptr<const std::vector<char>> loadShaderCode(const std::string& filepath);
 
   void createGraphicsPipeline(
       const std::string& vertFilepath,
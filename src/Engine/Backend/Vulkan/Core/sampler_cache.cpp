@@ -0,0 +1,82 @@
+#include "sampler_cache.hpp"
+
+// std
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+uint32_t floatBits(float value) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+}  // namespace
+
+LveSamplerCache::LveSamplerCache(LveDevice &device) : device{device} {}
+
+LveSamplerCache::~LveSamplerCache() {
+  for (auto &entry : samplers) {
+    vkDestroySampler(device.device(), entry.second, nullptr);
+  }
+}
+
+VkSampler LveSamplerCache::getSampler(const VkSamplerCreateInfo &info) {
+  if (info.pNext != nullptr) {
+    throw std::invalid_argument("sampler cache does not support pNext chains!");
+  }
+
+  const Key key = makeKey(info);
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = samplers.find(key);
+  if (it != samplers.end()) {
+    return it->second;
+  }
+
+  VkSampler sampler = VK_NULL_HANDLE;
+  if (vkCreateSampler(device.device(), &info, nullptr, &sampler) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create sampler!");
+  }
+  samplers.emplace(key, sampler);
+  return sampler;
+}
+
+std::size_t LveSamplerCache::size() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return samplers.size();
+}
+
+LveSamplerCache::Key LveSamplerCache::makeKey(const VkSamplerCreateInfo &info) {
+  return {
+      static_cast<uint32_t>(info.flags),
+      static_cast<uint32_t>(info.magFilter),
+      static_cast<uint32_t>(info.minFilter),
+      static_cast<uint32_t>(info.mipmapMode),
+      static_cast<uint32_t>(info.addressModeU),
+      static_cast<uint32_t>(info.addressModeV),
+      static_cast<uint32_t>(info.addressModeW),
+      floatBits(info.mipLodBias),
+      static_cast<uint32_t>(info.anisotropyEnable),
+      floatBits(info.anisotropyEnable ? info.maxAnisotropy : 1.0f),
+      static_cast<uint32_t>(info.compareEnable),
+      static_cast<uint32_t>(info.compareEnable ? info.compareOp : VK_COMPARE_OP_NEVER),
+      floatBits(info.minLod),
+      floatBits(info.maxLod),
+      static_cast<uint32_t>(info.borderColor),
+      static_cast<uint32_t>(info.unnormalizedCoordinates)};
+}
+
+std::size_t LveSamplerCache::KeyHash::operator()(const Key &key) const {
+  // FNV-1a over the packed fields
+  uint64_t hash = 14695981039346656037ull;
+  for (uint32_t word : key) {
+    hash ^= word;
+    hash *= 1099511628211ull;
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+}  // namespace lve
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Engine/Backend/Vulkan/Core/device.hpp"
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace lve {
+
+// Samplers are immutable, so every identical VkSamplerCreateInfo maps to one shared VkSampler
+// that lives as long as the device. Callers never destroy what they get back.
+class LveSamplerCache {
+ public:
+  explicit LveSamplerCache(LveDevice &device);
+  ~LveSamplerCache();
+
+  LveSamplerCache(const LveSamplerCache &) = delete;
+  LveSamplerCache &operator=(const LveSamplerCache &) = delete;
+
+  // info.pNext must be null, extension chains are not part of the key
+  VkSampler getSampler(const VkSamplerCreateInfo &info);
+  std::size_t size();
+
+ private:
+  using Key = std::array<uint32_t, 16>;
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  static Key makeKey(const VkSamplerCreateInfo &info);
+
+  LveDevice &device;
+  std::mutex mutex;
+  std::unordered_map<Key, VkSampler, KeyHash> samplers;
+};
+
+}  // namespace lve
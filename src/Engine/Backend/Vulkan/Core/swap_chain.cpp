@@ -1,7 +1,9 @@
 #include "swap_chain.hpp"
 
 // std
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -11,22 +13,28 @@
 
 namespace lve {
 
-LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent)
-    : device{deviceRef}, windowExtent{extent} {
+LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent, const SwapChainConfig &config)
+    : device{deviceRef}, windowExtent{extent}, config{config} {
   init();
 }
 
 LveSwapChain::LveSwapChain(
-    LveDevice &deviceRef, VkExtent2D extent, std::shared_ptr<LveSwapChain> previous)
-    : device{deviceRef}, windowExtent{extent}, oldSwapChain{previous} {
+    LveDevice &deviceRef,
+    VkExtent2D extent,
+    std::shared_ptr<LveSwapChain> previous,
+    const SwapChainConfig &config)
+    : device{deviceRef}, windowExtent{extent}, config{config}, oldSwapChain{previous} {
   init();
   oldSwapChain = nullptr;
 }
 
 void LveSwapChain::init() {
+  config.framesInFlight = std::clamp<uint32_t>(config.framesInFlight, 1, MAX_FRAMES_IN_FLIGHT);
   createSwapChain();
   createImageViews();
-  createRenderPass();
+  if (!adoptRenderPass()) {
+    createRenderPass();
+  }
   createDepthResources();
   createFramebuffers();
   createSyncObjects();
@@ -45,15 +53,16 @@ LveSwapChain::~LveSwapChain() {
 
   for (int i = 0; i < depthImages.size(); i++) {
     vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-    vkDestroyImage(device.device(), depthImages[i], nullptr);
-    vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+    device.destroyImage(depthImages[i], depthImageMemorys[i]);
   }
 
   for (auto framebuffer : swapChainFramebuffers) {
     vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
   }
 
-  vkDestroyRenderPass(device.device(), renderPass, nullptr);
+  if (renderPass != VK_NULL_HANDLE) {
+    vkDestroyRenderPass(device.device(), renderPass, nullptr);
+  }
 
   // cleanup synchronization objects
   for (size_t i = 0; i < imageAvailableSemaphores.size(); i++) {
@@ -68,12 +77,15 @@ LveSwapChain::~LveSwapChain() {
 }
 
 VkResult LveSwapChain::acquireNextImage(uint32_t *imageIndex) {
+  using Clock = std::chrono::steady_clock;
+  const auto waitStart = Clock::now();
   vkWaitForFences(
       device.device(),
       1,
       &inFlightFences[currentFrame],
       VK_TRUE,
       std::numeric_limits<uint64_t>::max());
+  const auto acquireStart = Clock::now();
 
   VkResult result = vkAcquireNextImageKHR(
       device.device(),
@@ -83,6 +95,8 @@ VkResult LveSwapChain::acquireNextImage(uint32_t *imageIndex) {
       VK_NULL_HANDLE,
       imageIndex);
 
+  fenceWaitMs = std::chrono::duration<double, std::milli>(acquireStart - waitStart).count();
+  acquireMs = std::chrono::duration<double, std::milli>(Clock::now() - acquireStart).count();
   return result;
 }
 
@@ -128,7 +142,7 @@ VkResult LveSwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, uint
 
   auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
 
-  currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+  currentFrame = (currentFrame + 1) % config.framesInFlight;
 
   return result;
 }
@@ -215,6 +229,19 @@ void LveSwapChain::createImageViews() {
   }
 }
 
+bool LveSwapChain::adoptRenderPass() {
+  // render pass only depends on the attachment formats, so a resize can keep the old one and
+  // everything built against it (ImGui pipelines, framebuffer compatibility) stays valid
+  if (oldSwapChain == nullptr || oldSwapChain->renderPass == VK_NULL_HANDLE ||
+      oldSwapChain->swapChainImageFormat != swapChainImageFormat ||
+      oldSwapChain->swapChainDepthFormat != findDepthFormat()) {
+    return false;
+  }
+  renderPass = oldSwapChain->renderPass;
+  oldSwapChain->renderPass = VK_NULL_HANDLE;
+  return true;
+}
+
 void LveSwapChain::createRenderPass() {
   VkAttachmentDescription depthAttachment{};
   depthAttachment.format = findDepthFormat();
@@ -351,9 +378,7 @@ void LveSwapChain::createDepthResources() {
 }
 
 void LveSwapChain::createSyncObjects() {
-  imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
   renderFinishedSemaphores.resize(imageCount());
-  inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
   imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
 
   VkSemaphoreCreateInfo semaphoreInfo = {};
@@ -363,11 +388,23 @@ void LveSwapChain::createSyncObjects() {
   fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
   fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-  for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-    if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
-            VK_SUCCESS ||
-        vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create synchronization objects for a frame!");
+  if (oldSwapChain != nullptr && oldSwapChain->inFlightFences.size() == config.framesInFlight) {
+    // per-frame fences keep tracking work submitted through the previous swapchain, so
+    // the renderer can reuse its command buffers without a device-wide wait
+    imageAvailableSemaphores = std::move(oldSwapChain->imageAvailableSemaphores);
+    inFlightFences = std::move(oldSwapChain->inFlightFences);
+    currentFrame = oldSwapChain->currentFrame;
+    oldSwapChain->imageAvailableSemaphores.clear();
+    oldSwapChain->inFlightFences.clear();
+  } else {
+    imageAvailableSemaphores.resize(config.framesInFlight);
+    inFlightFences.resize(config.framesInFlight);
+    for (size_t i = 0; i < config.framesInFlight; i++) {
+      if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
+              VK_SUCCESS ||
+          vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create synchronization objects for a frame!");
+      }
     }
   }
   for (size_t i = 0; i < renderFinishedSemaphores.size(); ++i){
@@ -391,24 +428,29 @@ VkSurfaceFormatKHR LveSwapChain::chooseSwapSurfaceFormat(
 
 VkPresentModeKHR LveSwapChain::chooseSwapPresentMode(
     const std::vector<VkPresentModeKHR> &availablePresentModes) {
-  /* 
   for (const auto &availablePresentMode : availablePresentModes) {
-    if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-      std::cout << "Present mode: Mailbox" << std::endl;
-      return availablePresentMode;
+    if (availablePresentMode == config.presentMode) {
+      activePresentMode = availablePresentMode;
+      break;
     }
   }
-  */
-
-  // for (const auto &availablePresentMode : availablePresentModes) {
-  //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-  //     std::cout << "Present mode: Immediate" << std::endl;
-  //     return availablePresentMode;
-  //   }
-  // }
+  if (activePresentMode != config.presentMode) {
+    // FIFO is the only mode every implementation must support
+    activePresentMode = VK_PRESENT_MODE_FIFO_KHR;
+  }
 
-  std::cout << "Present mode: V-Sync" << std::endl;
-  return VK_PRESENT_MODE_FIFO_KHR;
+  switch (activePresentMode) {
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+      std::cout << "Present mode: Mailbox" << std::endl;
+      break;
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+      std::cout << "Present mode: Immediate" << std::endl;
+      break;
+    default:
+      std::cout << "Present mode: V-Sync" << std::endl;
+      break;
+  }
+  return activePresentMode;
 }
 
 VkExtent2D LveSwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities) {
@@ -12,13 +12,22 @@
 
 namespace lve {
 
+struct SwapChainConfig {
+  uint32_t framesInFlight = 2;
+  VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+};
+
 class LveSwapChain {
  public:
-  static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+  // upper bound for per-frame resources, the active count is SwapChainConfig::framesInFlight
+  static constexpr int MAX_FRAMES_IN_FLIGHT = 3;
 
-  LveSwapChain(LveDevice &deviceRef, VkExtent2D windowExtent);
+  LveSwapChain(LveDevice &deviceRef, VkExtent2D windowExtent, const SwapChainConfig &config = {});
   LveSwapChain(
-      LveDevice &deviceRef, VkExtent2D windowExtent, std::shared_ptr<LveSwapChain> previous);
+      LveDevice &deviceRef,
+      VkExtent2D windowExtent,
+      std::shared_ptr<LveSwapChain> previous,
+      const SwapChainConfig &config = {});
 
   ~LveSwapChain();
 
@@ -33,6 +42,10 @@ class LveSwapChain {
   VkExtent2D getSwapChainExtent() { return swapChainExtent; }
   uint32_t width() { return swapChainExtent.width; }
   uint32_t height() { return swapChainExtent.height; }
+  uint32_t framesInFlight() const { return config.framesInFlight; }
+  VkPresentModeKHR presentMode() const { return activePresentMode; }
+  double lastFenceWaitMs() const { return fenceWaitMs; }
+  double lastAcquireMs() const { return acquireMs; }
 
   float extentAspectRatio() {
     return static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height);
@@ -53,6 +66,7 @@ class LveSwapChain {
   void createImageViews();
   void createDepthResources();
   void createRenderPass();
+  bool adoptRenderPass();
   void createFramebuffers();
   void createSyncObjects();
 
@@ -71,13 +85,15 @@ class LveSwapChain {
   VkRenderPass renderPass;
 
   std::vector<VkImage> depthImages;
-  std::vector<VkDeviceMemory> depthImageMemorys;
+  std::vector<LveAllocation> depthImageMemorys;
   std::vector<VkImageView> depthImageViews;
   std::vector<VkImage> swapChainImages;
   std::vector<VkImageView> swapChainImageViews;
 
   LveDevice &device;
   VkExtent2D windowExtent;
+  SwapChainConfig config;
+  VkPresentModeKHR activePresentMode = VK_PRESENT_MODE_FIFO_KHR;
 
   VkSwapchainKHR swapChain;
   std::shared_ptr<LveSwapChain> oldSwapChain;
@@ -87,6 +103,8 @@ class LveSwapChain {
   std::vector<VkFence> inFlightFences;
   std::vector<VkFence> imagesInFlight;
   size_t currentFrame = 0;
+  double fenceWaitMs = 0.0;
+  double acquireMs = 0.0;
 };
 
 }  // namespace lve
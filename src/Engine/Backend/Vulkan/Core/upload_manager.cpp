@@ -0,0 +1,658 @@
+#include "upload_manager.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace lve {
+
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+LveUploadManager::LveUploadManager(LveDevice &device, VkDeviceSize ringSize)
+    : device{device}, ringSize{ringSize} {
+  QueueFamilyIndices indices = device.findPhysicalQueueFamilies();
+  graphicsFamily = indices.graphicsFamily;
+  dedicatedTransfer = indices.transferFamilyHasValue && indices.transferFamily != graphicsFamily;
+  transferFamily = dedicatedTransfer ? indices.transferFamily : graphicsFamily;
+
+  // keeps buffer->image copies legal for every texel block size we upload (<= 16 bytes)
+  copyAlignment = std::max<VkDeviceSize>(16, device.properties.limits.optimalBufferCopyOffsetAlignment);
+
+  createCommandPools();
+  createRing();
+}
+
+LveUploadManager::~LveUploadManager() {
+  waitIdle();
+
+  std::lock_guard<std::mutex> lock{mutex};
+  if (recording) {
+    destroyBatch(*recording);
+    recording.reset();
+  }
+  for (auto &batch : freeBatches) {
+    destroyBatch(*batch);
+  }
+  freeBatches.clear();
+
+  device.destroyBuffer(ringBuffer, ringMemory);
+  vkDestroyCommandPool(device.device(), transferPool, nullptr);
+  if (graphicsPool != VK_NULL_HANDLE) {
+    vkDestroyCommandPool(device.device(), graphicsPool, nullptr);
+  }
+}
+
+void LveUploadManager::createCommandPools() {
+  VkCommandPoolCreateInfo poolInfo{};
+  poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  poolInfo.flags =
+      VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  poolInfo.queueFamilyIndex = transferFamily;
+  if (vkCreateCommandPool(device.device(), &poolInfo, nullptr, &transferPool) != VK_SUCCESS) {
+    throw std::runtime_error("failed to create upload command pool!");
+  }
+
+  if (dedicatedTransfer) {
+    poolInfo.queueFamilyIndex = graphicsFamily;
+    if (vkCreateCommandPool(device.device(), &poolInfo, nullptr, &graphicsPool) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create upload acquire command pool!");
+    }
+  }
+}
+
+void LveUploadManager::createRing() {
+  device.createBuffer(
+      ringSize,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      ringBuffer,
+      ringMemory,
+      MemoryStrategy::Dedicated);
+  if (ringMemory.mapped == nullptr) {
+    throw std::runtime_error("upload staging ring is not host visible!");
+  }
+}
+
+UploadTicket LveUploadManager::uploadBuffer(
+    VkBuffer dstBuffer,
+    VkDeviceSize dstOffset,
+    const void *data,
+    VkDeviceSize size,
+    VkAccessFlags dstAccess,
+    VkPipelineStageFlags dstStage) {
+  std::lock_guard<std::mutex> lock{mutex};
+  if (size == 0) {
+    return lastSubmitted;
+  }
+
+  StagingSlice slice = acquireStaging(size);
+  Batch &batch = openBatch();
+  if (slice.oversized) {
+    batch.oversizedStaging.emplace_back(slice.buffer, slice.oversizedMemory);
+  }
+  std::memcpy(slice.mapped, data, static_cast<size_t>(size));
+
+  VkBufferCopy copyRegion{};
+  copyRegion.srcOffset = slice.offset;
+  copyRegion.dstOffset = dstOffset;
+  copyRegion.size = size;
+  vkCmdCopyBuffer(batch.transferCommands, slice.buffer, dstBuffer, 1, &copyRegion);
+
+  VkBufferMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.buffer = dstBuffer;
+  barrier.offset = dstOffset;
+  barrier.size = size;
+  if (dedicatedTransfer) {
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = transferFamily;
+    barrier.dstQueueFamilyIndex = graphicsFamily;
+    batch.releaseBuffers.push_back(barrier);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = dstAccess;
+    batch.acquireBuffers.push_back(barrier);
+  } else {
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = dstAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    batch.acquireBuffers.push_back(barrier);
+  }
+  batch.dstStages |= dstStage;
+  batch.uploadCount++;
+  return batch.id;
+}
+
+UploadTicket LveUploadManager::uploadImage(
+    VkImage image,
+    const VkImageSubresourceRange &range,
+    const void *data,
+    VkDeviceSize size,
+    const std::vector<VkBufferImageCopy> &regions,
+    VkImageLayout finalLayout,
+    VkAccessFlags dstAccess,
+    VkPipelineStageFlags dstStage) {
+  std::lock_guard<std::mutex> lock{mutex};
+  return recordImageUpload(
+      image, range, data, size, regions, finalLayout, dstAccess, dstStage, nullptr);
+}
+
+UploadTicket LveUploadManager::uploadImageAndGenerateMips(
+    VkImage image,
+    VkExtent2D extent,
+    const VkImageSubresourceRange &range,
+    const void *data,
+    VkDeviceSize size,
+    VkImageLayout finalLayout,
+    VkAccessFlags dstAccess,
+    VkPipelineStageFlags dstStage) {
+  VkBufferImageCopy region{};
+  region.imageSubresource.aspectMask = range.aspectMask;
+  region.imageSubresource.mipLevel = range.baseMipLevel;
+  region.imageSubresource.baseArrayLayer = range.baseArrayLayer;
+  region.imageSubresource.layerCount = range.layerCount;
+  region.imageExtent = {extent.width, extent.height, 1};
+
+  MipGeneration mips{};
+  mips.image = image;
+  mips.extent = extent;
+  mips.range = range;
+  mips.finalLayout = finalLayout;
+  mips.dstAccess = dstAccess;
+  mips.dstStage = dstStage;
+
+  std::lock_guard<std::mutex> lock{mutex};
+  return recordImageUpload(
+      image, range, data, size, {region}, finalLayout, dstAccess, dstStage, &mips);
+}
+
+UploadTicket LveUploadManager::recordImageUpload(
+    VkImage image,
+    const VkImageSubresourceRange &range,
+    const void *data,
+    VkDeviceSize size,
+    const std::vector<VkBufferImageCopy> &regions,
+    VkImageLayout finalLayout,
+    VkAccessFlags dstAccess,
+    VkPipelineStageFlags dstStage,
+    const MipGeneration *mips) {
+  if (size == 0) {
+    return lastSubmitted;
+  }
+
+  StagingSlice slice = acquireStaging(size);
+  Batch &batch = openBatch();
+  if (slice.oversized) {
+    batch.oversizedStaging.emplace_back(slice.buffer, slice.oversizedMemory);
+  }
+  std::memcpy(slice.mapped, data, static_cast<size_t>(size));
+
+  VkImageMemoryBarrier toTransfer{};
+  toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  toTransfer.image = image;
+  toTransfer.subresourceRange = range;
+  toTransfer.srcAccessMask = 0;
+  toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(
+      batch.transferCommands,
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &toTransfer);
+
+  std::vector<VkBufferImageCopy> copies = regions;
+  for (auto &copy : copies) {
+    copy.bufferOffset += slice.offset;
+  }
+  vkCmdCopyBufferToImage(
+      batch.transferCommands,
+      slice.buffer,
+      image,
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      static_cast<uint32_t>(copies.size()),
+      copies.data());
+
+  // with mip generation the image stays in TRANSFER_DST until the blit chain has run
+  VkImageMemoryBarrier barrier = toTransfer;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = mips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : finalLayout;
+  const VkAccessFlags acquireAccess =
+      mips ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : dstAccess;
+  if (dedicatedTransfer) {
+    // release and acquire must describe the same layout transition
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = transferFamily;
+    barrier.dstQueueFamilyIndex = graphicsFamily;
+    batch.releaseImages.push_back(barrier);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = acquireAccess;
+    batch.acquireImages.push_back(barrier);
+    batch.dstStages |= mips ? VK_PIPELINE_STAGE_TRANSFER_BIT : dstStage;
+  } else if (!mips) {
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = dstAccess;
+    batch.acquireImages.push_back(barrier);
+    batch.dstStages |= dstStage;
+  }
+
+  if (mips) {
+    batch.mipGenerations.push_back(*mips);
+  }
+  batch.uploadCount++;
+  return batch.id;
+}
+
+UploadTicket LveUploadManager::submit() {
+  std::lock_guard<std::mutex> lock{mutex};
+  submitLocked();
+  return lastSubmitted;
+}
+
+void LveUploadManager::collect() {
+  std::lock_guard<std::mutex> lock{mutex};
+  retireLocked(false);
+}
+
+bool LveUploadManager::isComplete(UploadTicket ticket) {
+  std::lock_guard<std::mutex> lock{mutex};
+  retireLocked(false);
+  return ticket <= lastCompleted;
+}
+
+void LveUploadManager::wait(UploadTicket ticket) {
+  std::lock_guard<std::mutex> lock{mutex};
+  if (recording && ticket >= recording->id) {
+    submitLocked();
+  }
+  while (lastCompleted < ticket && !inFlight.empty()) {
+    retireLocked(true);
+  }
+}
+
+void LveUploadManager::waitIdle() {
+  std::lock_guard<std::mutex> lock{mutex};
+  submitLocked();
+  while (!inFlight.empty()) {
+    retireLocked(true);
+  }
+}
+
+LveUploadManager::Batch &LveUploadManager::openBatch() {
+  if (recording) {
+    return *recording;
+  }
+
+  if (!freeBatches.empty()) {
+    recording = std::move(freeBatches.back());
+    freeBatches.pop_back();
+  } else {
+    recording = std::make_unique<Batch>();
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    allocInfo.commandPool = transferPool;
+    if (vkAllocateCommandBuffers(device.device(), &allocInfo, &recording->transferCommands) !=
+        VK_SUCCESS) {
+      throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+    if (dedicatedTransfer) {
+      allocInfo.commandPool = graphicsPool;
+      if (vkAllocateCommandBuffers(device.device(), &allocInfo, &recording->acquireCommands) !=
+          VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upload acquire command buffer!");
+      }
+
+      VkSemaphoreCreateInfo semaphoreInfo{};
+      semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+      if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &recording->transferDone) !=
+          VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload semaphore!");
+      }
+    }
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(device.device(), &fenceInfo, nullptr, &recording->fence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create upload fence!");
+    }
+  }
+
+  recording->id = nextTicket++;
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(recording->transferCommands, &beginInfo);
+  if (recording->acquireCommands != VK_NULL_HANDLE) {
+    vkBeginCommandBuffer(recording->acquireCommands, &beginInfo);
+  }
+  return *recording;
+}
+
+void LveUploadManager::destroyBatch(Batch &batch) {
+  for (auto &staging : batch.oversizedStaging) {
+    device.destroyBuffer(staging.first, staging.second);
+  }
+  batch.oversizedStaging.clear();
+  if (batch.transferDone != VK_NULL_HANDLE) {
+    vkDestroySemaphore(device.device(), batch.transferDone, nullptr);
+  }
+  vkDestroyFence(device.device(), batch.fence, nullptr);
+  // command buffers go away with their pools
+}
+
+void LveUploadManager::submitLocked() {
+  if (!recording || recording->uploadCount == 0) {
+    return;
+  }
+  Batch &batch = *recording;
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+
+  if (dedicatedTransfer) {
+    if (!batch.releaseBuffers.empty() || !batch.releaseImages.empty()) {
+      vkCmdPipelineBarrier(
+          batch.transferCommands,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+          0,
+          0,
+          nullptr,
+          static_cast<uint32_t>(batch.releaseBuffers.size()),
+          batch.releaseBuffers.data(),
+          static_cast<uint32_t>(batch.releaseImages.size()),
+          batch.releaseImages.data());
+    }
+    if (!batch.acquireBuffers.empty() || !batch.acquireImages.empty()) {
+      vkCmdPipelineBarrier(
+          batch.acquireCommands,
+          VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+          batch.dstStages,
+          0,
+          0,
+          nullptr,
+          static_cast<uint32_t>(batch.acquireBuffers.size()),
+          batch.acquireBuffers.data(),
+          static_cast<uint32_t>(batch.acquireImages.size()),
+          batch.acquireImages.data());
+    }
+    for (const auto &mips : batch.mipGenerations) {
+      recordMipGeneration(batch.acquireCommands, mips);
+    }
+    vkEndCommandBuffer(batch.transferCommands);
+    vkEndCommandBuffer(batch.acquireCommands);
+
+    submitInfo.pCommandBuffers = &batch.transferCommands;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &batch.transferDone;
+    if (vkQueueSubmit(device.transferQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+      throw std::runtime_error("failed to submit upload batch!");
+    }
+
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    submitInfo.pCommandBuffers = &batch.acquireCommands;
+    submitInfo.signalSemaphoreCount = 0;
+    submitInfo.pSignalSemaphores = nullptr;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &batch.transferDone;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to submit upload acquire batch!");
+    }
+  } else {
+    if (!batch.acquireBuffers.empty() || !batch.acquireImages.empty()) {
+      vkCmdPipelineBarrier(
+          batch.transferCommands,
+          VK_PIPELINE_STAGE_TRANSFER_BIT,
+          batch.dstStages,
+          0,
+          0,
+          nullptr,
+          static_cast<uint32_t>(batch.acquireBuffers.size()),
+          batch.acquireBuffers.data(),
+          static_cast<uint32_t>(batch.acquireImages.size()),
+          batch.acquireImages.data());
+    }
+    for (const auto &mips : batch.mipGenerations) {
+      recordMipGeneration(batch.transferCommands, mips);
+    }
+    vkEndCommandBuffer(batch.transferCommands);
+
+    submitInfo.pCommandBuffers = &batch.transferCommands;
+    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+      throw std::runtime_error("failed to submit upload batch!");
+    }
+  }
+
+  batch.ringEnd = ringHead;
+  lastSubmitted = batch.id;
+  inFlight.push_back(std::move(recording));
+}
+
+void LveUploadManager::retireLocked(bool block) {
+  while (!inFlight.empty()) {
+    Batch &batch = *inFlight.front();
+    const VkResult status = block
+        ? vkWaitForFences(
+              device.device(), 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max())
+        : vkGetFenceStatus(device.device(), batch.fence);
+    if (status != VK_SUCCESS) {
+      return;
+    }
+    retireBatch(batch);
+    freeBatches.push_back(std::move(inFlight.front()));
+    inFlight.pop_front();
+    block = false;
+  }
+}
+
+void LveUploadManager::retireBatch(Batch &batch) {
+  ringTail = batch.ringEnd;
+  lastCompleted = batch.id;
+
+  for (auto &staging : batch.oversizedStaging) {
+    device.destroyBuffer(staging.first, staging.second);
+  }
+  batch.oversizedStaging.clear();
+  batch.releaseBuffers.clear();
+  batch.releaseImages.clear();
+  batch.acquireBuffers.clear();
+  batch.acquireImages.clear();
+  batch.mipGenerations.clear();
+  batch.dstStages = 0;
+  batch.uploadCount = 0;
+
+  vkResetFences(device.device(), 1, &batch.fence);
+  vkResetCommandBuffer(batch.transferCommands, 0);
+  if (batch.acquireCommands != VK_NULL_HANDLE) {
+    vkResetCommandBuffer(batch.acquireCommands, 0);
+  }
+}
+
+void LveUploadManager::recordMipGeneration(VkCommandBuffer commandBuffer, const MipGeneration &mips) {
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.image = mips.image;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.subresourceRange = mips.range;
+  barrier.subresourceRange.levelCount = 1;
+
+  int32_t mipWidth = static_cast<int32_t>(mips.extent.width);
+  int32_t mipHeight = static_cast<int32_t>(mips.extent.height);
+  const uint32_t lastLevel = mips.range.baseMipLevel + mips.range.levelCount - 1;
+
+  for (uint32_t level = mips.range.baseMipLevel + 1; level <= lastLevel; level++) {
+    barrier.subresourceRange.baseMipLevel = level - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &barrier);
+
+    const int32_t nextWidth = mipWidth > 1 ? mipWidth / 2 : 1;
+    const int32_t nextHeight = mipHeight > 1 ? mipHeight / 2 : 1;
+
+    VkImageBlit blit{};
+    blit.srcOffsets[0] = {0, 0, 0};
+    blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+    blit.srcSubresource.aspectMask = mips.range.aspectMask;
+    blit.srcSubresource.mipLevel = level - 1;
+    blit.srcSubresource.baseArrayLayer = mips.range.baseArrayLayer;
+    blit.srcSubresource.layerCount = mips.range.layerCount;
+    blit.dstOffsets[0] = {0, 0, 0};
+    blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+    blit.dstSubresource = blit.srcSubresource;
+    blit.dstSubresource.mipLevel = level;
+    vkCmdBlitImage(
+        commandBuffer,
+        mips.image,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        mips.image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        1,
+        &blit,
+        VK_FILTER_LINEAR);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = mips.finalLayout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = mips.dstAccess;
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        mips.dstStage,
+        0,
+        0,
+        nullptr,
+        0,
+        nullptr,
+        1,
+        &barrier);
+
+    mipWidth = nextWidth;
+    mipHeight = nextHeight;
+  }
+
+  barrier.subresourceRange.baseMipLevel = lastLevel;
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = mips.finalLayout;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = mips.dstAccess;
+  vkCmdPipelineBarrier(
+      commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      mips.dstStage,
+      0,
+      0,
+      nullptr,
+      0,
+      nullptr,
+      1,
+      &barrier);
+}
+
+LveUploadManager::StagingSlice LveUploadManager::acquireStaging(VkDeviceSize size) {
+  StagingSlice slice{};
+
+  // anything this large would just thrash the ring
+  if (size <= ringSize / 2) {
+    VkDeviceSize offset = 0;
+    while (!tryAllocateFromRing(size, offset)) {
+      if (recording && recording->uploadCount > 0) {
+        submitLocked();
+      } else if (!inFlight.empty()) {
+        retireLocked(true);
+      } else {
+        throw std::runtime_error("upload staging ring is exhausted!");
+      }
+    }
+    slice.buffer = ringBuffer;
+    slice.offset = offset;
+    slice.mapped = static_cast<char *>(ringMemory.mapped) + offset;
+    return slice;
+  }
+
+  slice.oversized = true;
+  device.createBuffer(
+      size,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      slice.buffer,
+      slice.oversizedMemory,
+      MemoryStrategy::Dedicated);
+  slice.mapped = slice.oversizedMemory.mapped;
+  return slice;
+}
+
+bool LveUploadManager::tryAllocateFromRing(VkDeviceSize size, VkDeviceSize &offset) {
+  if (isRingIdle()) {
+    ringHead = 0;
+    ringTail = 0;
+  }
+
+  const VkDeviceSize aligned = alignUp(ringHead, copyAlignment);
+  if (ringHead >= ringTail) {
+    // free space is [head, end) followed by [0, tail)
+    if (aligned + size <= ringSize) {
+      offset = aligned;
+      ringHead = aligned + size;
+      return true;
+    }
+    // strictly less so head never catches up with tail from behind
+    if (size < ringTail) {
+      offset = 0;
+      ringHead = size;
+      return true;
+    }
+    return false;
+  }
+
+  if (aligned + size < ringTail) {
+    offset = aligned;
+    ringHead = aligned + size;
+    return true;
+  }
+  return false;
+}
+
+bool LveUploadManager::isRingIdle() const {
+  return inFlight.empty() && (!recording || recording->uploadCount == 0);
+}
+
+}  // namespace lve
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Engine/Backend/Vulkan/Core/device.hpp"
+
+// std
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+// Identifies the batch an upload was recorded into; complete once that batch's fence signals.
+using UploadTicket = uint64_t;
+
+// Streams data into device local buffers/images through a persistent staging ring. Uploads are
+// recorded into one open batch which is submitted as a single vkQueueSubmit, either explicitly
+// or by the renderer once per frame. Nothing here waits for the queue to go idle; a CPU wait
+// only happens when the ring is full and the oldest batch still owns the space.
+//
+// With a dedicated transfer family the copies run on the transfer queue and ownership is
+// released there and acquired on the graphics queue in the same batch.
+class LveUploadManager {
+ public:
+  static constexpr VkDeviceSize DEFAULT_RING_SIZE = 32ull * 1024 * 1024;
+
+  explicit LveUploadManager(LveDevice &device, VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+  ~LveUploadManager();
+
+  LveUploadManager(const LveUploadManager &) = delete;
+  LveUploadManager &operator=(const LveUploadManager &) = delete;
+
+  UploadTicket uploadBuffer(
+      VkBuffer dstBuffer,
+      VkDeviceSize dstOffset,
+      const void *data,
+      VkDeviceSize size,
+      VkAccessFlags dstAccess,
+      VkPipelineStageFlags dstStage);
+
+  // regions[i].bufferOffset is relative to data; the image ends up in finalLayout
+  UploadTicket uploadImage(
+      VkImage image,
+      const VkImageSubresourceRange &range,
+      const void *data,
+      VkDeviceSize size,
+      const std::vector<VkBufferImageCopy> &regions,
+      VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      VkAccessFlags dstAccess = VK_ACCESS_SHADER_READ_BIT,
+      VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+  // copies mip 0 and fills the remaining range.levelCount levels with linear blits on the graphics
+  // queue; the format must support VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT and blits
+  UploadTicket uploadImageAndGenerateMips(
+      VkImage image,
+      VkExtent2D extent,
+      const VkImageSubresourceRange &range,
+      const void *data,
+      VkDeviceSize size,
+      VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+      VkAccessFlags dstAccess = VK_ACCESS_SHADER_READ_BIT,
+      VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+  // submits the open batch (if any) and returns the ticket of the last submitted batch
+  UploadTicket submit();
+  // recycles staging space of finished batches, never blocks
+  void collect();
+  bool isComplete(UploadTicket ticket);
+  void wait(UploadTicket ticket);
+  void waitIdle();
+
+  bool usesTransferQueue() const { return dedicatedTransfer; }
+
+ private:
+  struct MipGeneration {
+    VkImage image = VK_NULL_HANDLE;
+    VkExtent2D extent{};
+    VkImageSubresourceRange range{};
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkAccessFlags dstAccess = 0;
+    VkPipelineStageFlags dstStage = 0;
+  };
+
+  struct Batch {
+    UploadTicket id = 0;
+    VkCommandBuffer transferCommands = VK_NULL_HANDLE;
+    VkCommandBuffer acquireCommands = VK_NULL_HANDLE;  // graphics side, dedicated transfer only
+    VkSemaphore transferDone = VK_NULL_HANDLE;
+    VkFence fence = VK_NULL_HANDLE;
+    VkDeviceSize ringEnd = 0;
+    uint32_t uploadCount = 0;
+    // post-copy barriers are collected and recorded once at submit
+    std::vector<VkBufferMemoryBarrier> releaseBuffers;
+    std::vector<VkImageMemoryBarrier> releaseImages;
+    std::vector<VkBufferMemoryBarrier> acquireBuffers;
+    std::vector<VkImageMemoryBarrier> acquireImages;
+    VkPipelineStageFlags dstStages = 0;
+    // blit chains recorded on the graphics side after the acquire barriers
+    std::vector<MipGeneration> mipGenerations;
+    // uploads that did not fit in the ring get their own staging buffer
+    std::vector<std::pair<VkBuffer, LveAllocation>> oversizedStaging;
+  };
+
+  struct StagingSlice {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    void *mapped = nullptr;
+    bool oversized = false;
+    LveAllocation oversizedMemory{};
+  };
+
+  void createRing();
+  void createCommandPools();
+  Batch &openBatch();
+  UploadTicket recordImageUpload(
+      VkImage image,
+      const VkImageSubresourceRange &range,
+      const void *data,
+      VkDeviceSize size,
+      const std::vector<VkBufferImageCopy> &regions,
+      VkImageLayout finalLayout,
+      VkAccessFlags dstAccess,
+      VkPipelineStageFlags dstStage,
+      const MipGeneration *mips);
+  void recordMipGeneration(VkCommandBuffer commandBuffer, const MipGeneration &mips);
+  void destroyBatch(Batch &batch);
+  void submitLocked();
+  void retireLocked(bool block);
+  void retireBatch(Batch &batch);
+  StagingSlice acquireStaging(VkDeviceSize size);
+  bool tryAllocateFromRing(VkDeviceSize size, VkDeviceSize &offset);
+  bool isRingIdle() const;
+
+  LveDevice &device;
+  uint32_t graphicsFamily = 0;
+  uint32_t transferFamily = 0;
+  bool dedicatedTransfer = false;
+
+  VkCommandPool transferPool = VK_NULL_HANDLE;
+  VkCommandPool graphicsPool = VK_NULL_HANDLE;
+
+  VkBuffer ringBuffer = VK_NULL_HANDLE;
+  LveAllocation ringMemory{};
+  VkDeviceSize ringSize = 0;
+  VkDeviceSize ringHead = 0;
+  VkDeviceSize ringTail = 0;
+  VkDeviceSize copyAlignment = 16;
+
+  std::mutex mutex;
+  std::unique_ptr<Batch> recording;
+  std::deque<std::unique_ptr<Batch>> inFlight;
+  std::vector<std::unique_ptr<Batch>> freeBatches;
+  UploadTicket nextTicket = 1;
+  UploadTicket lastSubmitted = 0;
+  UploadTicket lastCompleted = 0;
+};
+
+}  // namespace lve
@@ -18,6 +18,8 @@ namespace lve::backend {
   void VulkanEditorRenderBackend::onRenderPassChanged(
     RenderPassHandle renderPass,
     std::uint32_t imageCount) {
+    // ImGui's descriptor pool and pipeline may still be referenced by frames in flight
+    vkDeviceWaitIdle(device.device());
     imgui.shutdown();
     imgui.init(reinterpret_cast<VkRenderPass>(renderPass), imageCount);
   }
@@ -3,11 +3,17 @@
 #include "Engine/Backend/Vulkan/Render/material.hpp"
 #include "Engine/Backend/Vulkan/Render/model.hpp"
 #include "Engine/Backend/Vulkan/Render/texture.hpp"
+#include "Engine/IO/cooked_model_io.hpp"
 #include "Engine/IO/image_io.hpp"
+#include "Engine/IO/mesh_optimizer.hpp"
+#include "Engine/IO/mesh_simplifier.hpp"
 #include "Engine/IO/model_io.hpp"
 #include "Engine/IO/material_io.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
+#include <filesystem>
 #include <iostream>
 #include <unordered_map>
 #include <utility>
@@ -15,22 +21,463 @@
 
 namespace lve::backend {
 
-  VulkanRenderAssetFactory::VulkanRenderAssetFactory(LveDevice &device)
-    : device{device} {}
+  struct VulkanRenderAssetFactory::DecodedModel {
+    bool ok{false};
+    std::string error{};
+    bool fromCooked{false};
+    CookedModel cooked{};
+    ModelData data{}; // imported data, unused when fromCooked
+    std::vector<ImageData> embeddedImages{}; // per material, empty unless embedded and decoded
 
-  std::shared_ptr<RenderModel> VulkanRenderAssetFactory::loadModel(const std::string &path) {
-    backend::ModelData data{};
-    std::string error;
-    if (!loadModelDataFromFile(path, data, &error)) {
+    const ModelData &modelData() const { return fromCooked ? cooked.metadata() : data; }
+    ModelGeometryView geometry() const {
+      if (fromCooked) {
+        return cooked.geometry();
+      }
+      return ModelGeometryView{
+        data.vertices.data(),
+        data.vertices.size(),
+        data.tangents.size() == data.vertices.size() ? data.tangents.data() : nullptr,
+        data.indices.data(),
+        data.indices.size()};
+    }
+  };
+
+  struct VulkanRenderAssetFactory::DecodedTexture {
+    bool ok{false};
+    std::string error{};
+    TextureMipChain chain{};
+  };
+
+  namespace {
+    // worker threads decoding at once, over models and textures together
+    constexpr int kMaxConcurrentDecodes = 4;
+    // GPU objects created per processAsyncLoads(), spreads a scene's uploads over a few frames
+    constexpr int kMaxAsyncCompletions = 8;
+
+    template <typename T>
+    bool isReady(const std::future<T> &future) {
+      return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    template <typename T>
+    bool isRunning(const std::future<T> &future) {
+      return future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+    }
+
+    void reportModelError(const std::string &path, const std::string &error) {
       std::cerr << "Failed to load model " << path;
       if (!error.empty()) {
         std::cerr << ": " << error;
       }
       std::cerr << "\n";
+    }
+
+    // the same file imported with different settings is a different GPU texture
+    std::string textureKey(const std::string &path, const TextureLoadOptions &options) {
+      std::string key = std::filesystem::path(path).lexically_normal().generic_string();
+      key += '|' + std::to_string(static_cast<int>(options.usage));
+      key += options.sRGB ? "|srgb" : "|linear";
+      key += options.generateMipmaps ? "|mips" : "|nomips";
+      key += '|' + std::to_string(options.maxSize);
+      key += '|' + std::to_string(static_cast<int>(options.filter));
+      key += '|' + std::to_string(static_cast<int>(options.wrap));
+      key += '|' + options.compressedPath;
+      return key;
+    }
+  } // namespace
+
+  VulkanRenderAssetFactory::VulkanRenderAssetFactory(LveDevice &device, LveTextureStreamer &textureStreamer)
+    : device{device}, textureStreamer{textureStreamer} {}
+
+  void VulkanRenderAssetFactory::setTextureOptionsProvider(TextureOptionsProvider provider) {
+    textureOptions = std::move(provider);
+  }
+
+  void VulkanRenderAssetFactory::setModelOptionsProvider(ModelOptionsProvider provider) {
+    modelOptions = std::move(provider);
+  }
+
+  TextureLoadOptions VulkanRenderAssetFactory::optionsFor(const std::string &path, TextureUsage usage) const {
+    TextureLoadOptions options{};
+    if (textureOptions) {
+      options = textureOptions(path, usage);
+    }
+    options.usage = usage;
+    return options;
+  }
+
+  TextureCacheStats VulkanRenderAssetFactory::getTextureCacheStats() const {
+    TextureCacheStats stats = textureCacheStats;
+    stats.liveTextures = 0;
+    for (const auto &[key, texture] : textureRegistry) {
+      if (!texture.expired()) {
+        stats.liveTextures++;
+      }
+    }
+    return stats;
+  }
+
+  std::shared_ptr<LveTexture> VulkanRenderAssetFactory::acquireTexture(
+    const std::string &path,
+    TextureUsage usage,
+    std::string *outError) {
+    const TextureLoadOptions options = optionsFor(path, usage);
+    const std::string key = textureKey(path, options);
+    auto it = textureRegistry.find(key);
+    if (it != textureRegistry.end()) {
+      if (auto texture = it->second.lock()) {
+        textureCacheStats.hits++;
+        return texture;
+      }
+    }
+
+    textureCacheStats.misses++;
+    std::shared_ptr<LveTexture> texture{};
+    auto decode = textureDecodes.find(key);
+    if (decode != textureDecodes.end() && decode->second.result.valid()) {
+      // waits when the worker is still busy, which is still shorter than decoding from scratch
+      const std::shared_ptr<DecodedTexture> decoded = decode->second.result.get();
+      textureDecodes.erase(decode);
+      if (!decoded->ok) {
+        if (outError) {
+          *outError = decoded->error;
+        }
+        return {};
+      }
+      texture = textureStreamer.createTexture(path, options, std::move(decoded->chain));
+    } else {
+      if (decode != textureDecodes.end()) {
+        textureDecodes.erase(decode);
+      }
+      texture = textureStreamer.loadTexture(path, options, outError);
+    }
+    if (!texture) {
+      return {};
+    }
+    for (auto entry = textureRegistry.begin(); entry != textureRegistry.end();) {
+      entry = entry->second.expired() ? textureRegistry.erase(entry) : std::next(entry);
+    }
+    textureRegistry[key] = texture;
+    return texture;
+  }
+
+  std::string VulkanRenderAssetFactory::prefetchTexture(
+    const std::string &path,
+    TextureUsage usage,
+    bool startNow) {
+    const TextureLoadOptions options = optionsFor(path, usage);
+    std::string key = textureKey(path, options);
+    auto it = textureRegistry.find(key);
+    if (it != textureRegistry.end() && !it->second.expired()) {
+      return {};
+    }
+    auto [decode, inserted] = textureDecodes.try_emplace(key);
+    if (inserted) {
+      decode->second.path = path;
+      decode->second.options = options;
+    }
+    if (startNow && !decode->second.result.valid()) {
+      startTextureDecode(decode->second);
+    }
+    return key;
+  }
+
+  bool VulkanRenderAssetFactory::texturesDecoded(const std::vector<std::string> &keys) const {
+    for (const auto &key : keys) {
+      auto it = textureDecodes.find(key);
+      if (it != textureDecodes.end() && !isReady(it->second.result)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void VulkanRenderAssetFactory::startTextureDecode(TextureDecode &decode) {
+    LveDevice &loadDevice = device;
+    decode.result = std::async(
+      std::launch::async,
+      [&loadDevice, path = decode.path, options = decode.options]() {
+        auto decoded = std::make_shared<DecodedTexture>();
+        decoded->ok = LveTexture::loadMipChain(loadDevice, path, options, decoded->chain, &decoded->error);
+        return decoded;
+      });
+  }
+
+  std::shared_ptr<VulkanRenderAssetFactory::DecodedModel> VulkanRenderAssetFactory::decodeModel(
+    const std::string &path,
+    const ModelLoadOptions &options) {
+    auto decoded = std::make_shared<DecodedModel>();
+    if (!options.cookedPath.empty()) {
+      std::string error;
+      decoded->fromCooked = decoded->cooked.open(options.cookedPath, &error);
+      if (!decoded->fromCooked) {
+        std::cerr << "Failed to load cooked model " << options.cookedPath;
+        if (!error.empty()) {
+          std::cerr << ": " << error;
+        }
+        std::cerr << ", importing " << path << "\n";
+      }
+    }
+    if (!decoded->fromCooked) {
+      if (!loadModelDataFromFile(path, options.importSettings, decoded->data, &decoded->error)) {
+        return decoded;
+      }
+      // matches what the cooker stores
+      generateModelLods(decoded->data, options.importSettings.lodCount);
+      if (options.importSettings.optimizeVertexCache) {
+        optimizeModelData(decoded->data, options.importSettings.reduceOverdraw);
+      }
+    }
+
+    const ModelData &data = decoded->modelData();
+    decoded->embeddedImages.resize(data.materials.size());
+    for (std::size_t i = 0; i < data.materials.size(); ++i) {
+      const auto &source = data.materials[i].diffuse;
+      if (source.kind != backend::ModelTextureSource::Kind::EmbeddedCompressed &&
+          source.kind != backend::ModelTextureSource::Kind::EmbeddedRaw) {
+        continue;
+      }
+      std::string texError;
+      if (!loadImageDataFromTextureSource(source, decoded->embeddedImages[i], &texError)) {
+        decoded->embeddedImages[i] = {};
+        std::cerr << "Failed to decode embedded model texture";
+        if (!texError.empty()) {
+          std::cerr << ": " << texError;
+        }
+        std::cerr << "\n";
+      }
+    }
+    decoded->ok = true;
+    return decoded;
+  }
+
+  void VulkanRenderAssetFactory::startQueuedDecodes() {
+    int inFlight = 0;
+    for (const auto &[key, decode] : textureDecodes) {
+      inFlight += isRunning(decode.result) ? 1 : 0;
+    }
+    for (const auto &model : pendingModels) {
+      inFlight += isRunning(model.decode) ? 1 : 0;
+    }
+
+    // textures first, they hold back models whose geometry is already decoded
+    for (auto &[key, decode] : textureDecodes) {
+      if (inFlight >= kMaxConcurrentDecodes) {
+        return;
+      }
+      if (!decode.result.valid()) {
+        startTextureDecode(decode);
+        ++inFlight;
+      }
+    }
+    for (auto &model : pendingModels) {
+      if (inFlight >= kMaxConcurrentDecodes) {
+        return;
+      }
+      if (!model.decoded && !model.decode.valid()) {
+        model.decode = std::async(std::launch::async, &VulkanRenderAssetFactory::decodeModel, model.path, model.options);
+        ++inFlight;
+      }
+    }
+  }
+
+  AssetHandle<RenderModel> VulkanRenderAssetFactory::loadModelAsync(const std::string &path) {
+    PendingModel pending{};
+    pending.path = path;
+    pending.options = modelOptions ? modelOptions(path) : ModelLoadOptions{};
+    pending.handle = AssetHandle<RenderModel>::pending();
+    AssetHandle<RenderModel> handle = pending.handle;
+    pendingModels.push_back(std::move(pending));
+    startQueuedDecodes();
+    return handle;
+  }
+
+  AssetHandle<RenderMaterial> VulkanRenderAssetFactory::loadMaterialAsync(
+    const std::string &path,
+    const std::function<std::string(const std::string &)> &pathResolver) {
+    auto handle = AssetHandle<RenderMaterial>::pending();
+    // the material file itself is small, only its textures are worth a worker
+    MaterialData data{};
+    std::string error;
+    if (!loadMaterialDataFromFile(path, data, &error, pathResolver)) {
+      std::cerr << "Failed to load material " << path;
+      if (!error.empty()) {
+        std::cerr << ": " << error;
+      }
+      std::cerr << "\n";
+      handle.resolve({});
+      return handle;
+    }
+
+    PendingMaterial pending{};
+    pending.path = path;
+    pending.handle = handle;
+    pending.pathResolver = pathResolver;
+    const std::pair<const std::string *, TextureUsage> slots[] = {
+      {&data.textures.baseColor, TextureUsage::Color},
+      {&data.textures.normal, TextureUsage::Normal},
+      {&data.textures.metallicRoughness, TextureUsage::MetallicRoughness},
+      {&data.textures.occlusion, TextureUsage::Occlusion},
+      {&data.textures.emissive, TextureUsage::Color},
+    };
+    for (const auto &[slotPath, usage] : slots) {
+      if (slotPath->empty()) {
+        continue;
+      }
+      // resolved the way LveMaterial::applyData will resolve it
+      std::string resolved = pathResolver ? pathResolver(*slotPath) : std::string{};
+      std::string key = prefetchTexture(resolved.empty() ? *slotPath : resolved, usage, false);
+      if (!key.empty()) {
+        pending.textureKeys.push_back(std::move(key));
+      }
+    }
+    pending.data = std::move(data);
+    pendingMaterials.push_back(std::move(pending));
+    startQueuedDecodes();
+    return handle;
+  }
+
+  AssetHandle<RenderTexture> VulkanRenderAssetFactory::loadTextureAsync(const std::string &path) {
+    std::string key = prefetchTexture(path, TextureUsage::Color, false);
+    if (key.empty()) {
+      return AssetHandle<RenderTexture>::ready(acquireTexture(path, TextureUsage::Color));
+    }
+    PendingTexture pending{};
+    pending.path = path;
+    pending.handle = AssetHandle<RenderTexture>::pending();
+    pending.textureKey = std::move(key);
+    AssetHandle<RenderTexture> handle = pending.handle;
+    pendingTextures.push_back(std::move(pending));
+    startQueuedDecodes();
+    return handle;
+  }
+
+  void VulkanRenderAssetFactory::processAsyncLoads() {
+    int completions = 0;
+
+    for (auto it = pendingModels.begin(); it != pendingModels.end();) {
+      if (!it->decoded) {
+        if (!isReady(it->decode)) {
+          ++it;
+          continue;
+        }
+        it->decoded = it->decode.get();
+        if (it->decoded->ok) {
+          it->textureKeys = prefetchModelTextures(*it->decoded, false);
+        }
+      }
+      if (!it->decoded->ok) {
+        reportModelError(it->path, it->decoded->error);
+        it->handle.resolve({});
+        it = pendingModels.erase(it);
+        continue;
+      }
+      if (completions >= kMaxAsyncCompletions || !texturesDecoded(it->textureKeys)) {
+        ++it;
+        continue;
+      }
+      it->handle.resolve(buildModel(it->path, *it->decoded));
+      ++completions;
+      it = pendingModels.erase(it);
+    }
+
+    for (auto it = pendingMaterials.begin(); it != pendingMaterials.end();) {
+      if (completions >= kMaxAsyncCompletions || !texturesDecoded(it->textureKeys)) {
+        ++it;
+        continue;
+      }
+      auto material = std::make_shared<LveMaterial>(materialTextureLoader());
+      material->setPath(it->path);
+      std::string error;
+      if (!material->applyData(it->data, &error, it->pathResolver) && !error.empty()) {
+        std::cerr << "Failed to load material " << it->path << ": " << error << "\n";
+      }
+      it->handle.resolve(std::move(material));
+      ++completions;
+      it = pendingMaterials.erase(it);
+    }
+
+    for (auto it = pendingTextures.begin(); it != pendingTextures.end();) {
+      if (completions >= kMaxAsyncCompletions || !texturesDecoded({it->textureKey})) {
+        ++it;
+        continue;
+      }
+      std::string error;
+      auto texture = acquireTexture(it->path, TextureUsage::Color, &error);
+      if (!texture) {
+        std::cerr << "Failed to load texture " << it->path;
+        if (!error.empty()) {
+          std::cerr << ": " << error;
+        }
+        std::cerr << "\n";
+      }
+      it->handle.resolve(std::move(texture));
+      ++completions;
+      it = pendingTextures.erase(it);
+    }
+
+    if (getPendingAsyncLoads() == 0) {
+      // decodes whose import options changed before they were picked up
+      textureDecodes.clear();
+    }
+    startQueuedDecodes();
+  }
+
+  std::size_t VulkanRenderAssetFactory::getPendingAsyncLoads() const {
+    return pendingModels.size() + pendingMaterials.size() + pendingTextures.size();
+  }
+
+  MaterialTextureLoader VulkanRenderAssetFactory::materialTextureLoader() {
+    return [this](const std::string &path, TextureUsage usage, std::string *outError) {
+      return acquireTexture(path, usage, outError);
+    };
+  }
+
+  std::shared_ptr<RenderModel> VulkanRenderAssetFactory::loadModel(const std::string &path) {
+    const ModelLoadOptions options = modelOptions ? modelOptions(path) : ModelLoadOptions{};
+    const std::shared_ptr<DecodedModel> decoded = decodeModel(path, options);
+    if (!decoded->ok) {
+      reportModelError(path, decoded->error);
       return {};
     }
+    // the material textures decode side by side while the first one uploads
+    prefetchModelTextures(*decoded, true);
+    return buildModel(path, *decoded);
+  }
 
-    std::unordered_map<std::string, std::shared_ptr<LveTexture>> fileCache;
+  std::shared_ptr<RenderModel> VulkanRenderAssetFactory::buildModel(
+    const std::string &path,
+    const DecodedModel &decoded) {
+    try {
+      // a cooked mapping only has to outlive the copy into staging done by the constructor
+      return std::make_shared<LveModel>(
+        device, decoded.modelData(), decoded.geometry(), loadModelTextures(decoded));
+    } catch (const std::exception &e) {
+      reportModelError(path, e.what());
+      return {};
+    }
+  }
+
+  std::vector<std::string> VulkanRenderAssetFactory::prefetchModelTextures(
+    const DecodedModel &decoded,
+    bool startNow) {
+    std::vector<std::string> keys;
+    for (const auto &material : decoded.modelData().materials) {
+      const auto &source = material.diffuse;
+      if (source.kind == backend::ModelTextureSource::Kind::File && !source.path.empty()) {
+        std::string key = prefetchTexture(source.path, TextureUsage::Color, startNow);
+        if (!key.empty()) {
+          keys.push_back(std::move(key));
+        }
+      }
+    }
+    return keys;
+  }
+
+  std::vector<std::shared_ptr<LveTexture>> VulkanRenderAssetFactory::loadModelTextures(
+    const DecodedModel &decoded) {
+    const ModelData &data = decoded.modelData();
     std::vector<std::shared_ptr<LveTexture>> materialTextures;
     materialTextures.resize(data.materials.size());
 
@@ -39,69 +486,39 @@ namespace lve::backend {
       std::shared_ptr<LveTexture> texture{};
 
       if (source.kind == backend::ModelTextureSource::Kind::File && !source.path.empty()) {
-        auto it = fileCache.find(source.path);
-        if (it != fileCache.end()) {
-          texture = it->second;
-        } else {
-          ImageData image{};
-          std::string texError;
-          if (loadImageDataFromFile(source.path, image, &texError)) {
-            auto uniqueTex = LveTexture::createTextureFromRgba(
-              device,
-              image.pixels.data(),
-              image.width,
-              image.height);
-            texture = std::shared_ptr<LveTexture>(std::move(uniqueTex));
-            fileCache[source.path] = texture;
-          } else {
-            std::cerr << "Failed to load model texture " << source.path;
-            if (!texError.empty()) {
-              std::cerr << ": " << texError;
-            }
-            std::cerr << "\n";
-          }
-        }
-      } else if (
-        source.kind == backend::ModelTextureSource::Kind::EmbeddedCompressed ||
-        source.kind == backend::ModelTextureSource::Kind::EmbeddedRaw) {
-        ImageData image{};
         std::string texError;
-        if (loadImageDataFromTextureSource(source, image, &texError)) {
-          auto uniqueTex = LveTexture::createTextureFromRgba(
-            device,
-            image.pixels.data(),
-            image.width,
-            image.height);
-          texture = std::shared_ptr<LveTexture>(std::move(uniqueTex));
-        } else {
-          std::cerr << "Failed to decode embedded model texture";
+        texture = acquireTexture(source.path, TextureUsage::Color, &texError);
+        if (!texture) {
+          std::cerr << "Failed to load model texture " << source.path;
           if (!texError.empty()) {
             std::cerr << ": " << texError;
           }
           std::cerr << "\n";
         }
+      } else if (!decoded.embeddedImages[i].pixels.empty()) {
+        const ImageData &image = decoded.embeddedImages[i];
+        auto uniqueTex = LveTexture::createTextureFromRgba(
+          device,
+          image.pixels.data(),
+          image.width,
+          image.height);
+        texture = std::shared_ptr<LveTexture>(std::move(uniqueTex));
       }
 
       materialTextures[i] = texture;
     }
-
-    try {
-      return std::make_shared<LveModel>(device, data, std::move(materialTextures));
-    } catch (const std::exception &e) {
-      std::cerr << "Failed to load model " << path << ": " << e.what() << "\n";
-      return {};
-    }
+    return materialTextures;
   }
 
   std::shared_ptr<RenderMaterial> VulkanRenderAssetFactory::loadMaterial(
     const std::string &path,
     std::string *outError,
     const std::function<std::string(const std::string &)> &pathResolver) {
-    return LveMaterial::loadFromFile(device, path, outError, pathResolver);
+    return LveMaterial::loadFromFile(materialTextureLoader(), path, outError, pathResolver);
   }
 
   std::shared_ptr<RenderMaterial> VulkanRenderAssetFactory::createMaterial() {
-    return std::make_shared<LveMaterial>(device);
+    return std::make_shared<LveMaterial>(materialTextureLoader());
   }
 
   bool VulkanRenderAssetFactory::saveMaterial(
@@ -113,9 +530,9 @@ namespace lve::backend {
 
   std::shared_ptr<RenderTexture> VulkanRenderAssetFactory::loadTexture(const std::string &path) {
     try {
-      ImageData image{};
       std::string error;
-      if (!loadImageDataFromFile(path, image, &error)) {
+      auto texture = acquireTexture(path, TextureUsage::Color, &error);
+      if (!texture) {
         std::cerr << "Failed to load texture " << path;
         if (!error.empty()) {
           std::cerr << ": " << error;
@@ -123,12 +540,7 @@ namespace lve::backend {
         std::cerr << "\n";
         return {};
       }
-      auto uniqueTexture = LveTexture::createTextureFromRgba(
-        device,
-        image.pixels.data(),
-        image.width,
-        image.height);
-      return std::shared_ptr<LveTexture>(std::move(uniqueTexture));
+      return texture;
     } catch (const std::exception &e) {
       std::cerr << "Failed to load texture " << path << ": " << e.what() << "\n";
       return {};
@@ -2,15 +2,21 @@
 
 #include "Engine/Backend/render_assets.hpp"
 #include "Engine/Backend/Vulkan/Core/device.hpp"
+#include "Engine/Backend/Vulkan/Render/material.hpp"
+#include "Engine/Backend/Vulkan/Render/texture_streamer.hpp"
 
+#include <cstddef>
+#include <future>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace lve::backend {
 
   class VulkanRenderAssetFactory final : public RenderAssetFactory {
   public:
-    explicit VulkanRenderAssetFactory(LveDevice &device);
+    VulkanRenderAssetFactory(LveDevice &device, LveTextureStreamer &textureStreamer);
 
     std::shared_ptr<RenderModel> loadModel(const std::string &path) override;
     std::shared_ptr<RenderMaterial> loadMaterial(
@@ -24,10 +30,80 @@ namespace lve::backend {
       std::string *outError = nullptr) override;
     std::shared_ptr<RenderTexture> loadTexture(const std::string &path) override;
     std::shared_ptr<RenderTexture> getDefaultTexture() override;
+    void setTextureOptionsProvider(TextureOptionsProvider provider) override;
+    void setModelOptionsProvider(ModelOptionsProvider provider) override;
+    TextureCacheStats getTextureCacheStats() const override;
+
+    AssetHandle<RenderModel> loadModelAsync(const std::string &path) override;
+    AssetHandle<RenderMaterial> loadMaterialAsync(
+      const std::string &path,
+      const std::function<std::string(const std::string &)> &pathResolver = {}) override;
+    AssetHandle<RenderTexture> loadTextureAsync(const std::string &path) override;
+    void processAsyncLoads() override;
+    std::size_t getPendingAsyncLoads() const override;
 
   private:
+    // CPU side of loads, produced on worker threads
+    struct DecodedModel;
+    struct DecodedTexture;
+
+    struct TextureDecode {
+      std::string path;
+      TextureLoadOptions options;
+      std::future<std::shared_ptr<DecodedTexture>> result; // not valid while queued
+    };
+    struct PendingModel {
+      std::string path;
+      ModelLoadOptions options;
+      AssetHandle<RenderModel> handle;
+      std::future<std::shared_ptr<DecodedModel>> decode; // not valid while queued
+      std::shared_ptr<DecodedModel> decoded;
+      std::vector<std::string> textureKeys;
+    };
+    struct PendingMaterial {
+      std::string path;
+      AssetHandle<RenderMaterial> handle;
+      MaterialData data;
+      std::function<std::string(const std::string &)> pathResolver;
+      std::vector<std::string> textureKeys;
+    };
+    struct PendingTexture {
+      std::string path;
+      AssetHandle<RenderTexture> handle;
+      std::string textureKey;
+    };
+
+    // reads the cooked file when it opens, otherwise imports path; thread safe
+    static std::shared_ptr<DecodedModel> decodeModel(const std::string &path, const ModelLoadOptions &options);
+
+    TextureLoadOptions optionsFor(const std::string &path, TextureUsage usage) const;
+    // one GPU texture per path and import settings while anything still references it. A decode
+    // started by prefetchTexture is picked up here, so only the upload runs on this thread.
+    std::shared_ptr<LveTexture> acquireTexture(
+      const std::string &path,
+      TextureUsage usage,
+      std::string *outError = nullptr);
+    // returns the registry key to wait for, empty when the texture is already resident
+    std::string prefetchTexture(const std::string &path, TextureUsage usage, bool startNow);
+    std::vector<std::string> prefetchModelTextures(const DecodedModel &decoded, bool startNow);
+    bool texturesDecoded(const std::vector<std::string> &keys) const;
+    void startTextureDecode(TextureDecode &decode);
+    void startQueuedDecodes();
+    MaterialTextureLoader materialTextureLoader();
+    std::vector<std::shared_ptr<LveTexture>> loadModelTextures(const DecodedModel &decoded);
+    std::shared_ptr<RenderModel> buildModel(const std::string &path, const DecodedModel &decoded);
+
     LveDevice &device;
+    LveTextureStreamer &textureStreamer;
     std::shared_ptr<RenderTexture> defaultTexture;
+    TextureOptionsProvider textureOptions;
+    ModelOptionsProvider modelOptions;
+    std::unordered_map<std::string, std::weak_ptr<LveTexture>> textureRegistry;
+    TextureCacheStats textureCacheStats{};
+    std::unordered_map<std::string, TextureDecode> textureDecodes; // keyed like textureRegistry
+    std::vector<PendingModel> pendingModels;
+    std::vector<PendingMaterial> pendingMaterials;
+    std::vector<PendingTexture> pendingTextures;
   };
 
 } // namespace lve::backend
@@ -32,8 +32,10 @@ namespace lve{
         VkCommandBuffer commandBuffer;
         LveCamera &camera;
         VkDescriptorSet globalDescriptorSet;
-        LveDescriptorPool &frameDescriptorPool;  // pool for cached per-object descriptors
+        LveDescriptorAllocator &frameDescriptorPool;  // cached per-object sets of this frame index
         std::vector<LveGameObject*> &gameObjects;
+        backend::RenderView view;
+        float viewHeight;  // pixels, for screen size dependent choices such as LODs
     };
 } // namespace lve
 
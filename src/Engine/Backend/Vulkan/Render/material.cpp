@@ -1,6 +1,5 @@
 #include "Engine/Backend/Vulkan/Render/material.hpp"
 
-#include "Engine/IO/image_io.hpp"
 #include "Engine/IO/material_io.hpp"
 
 #include <deque>
@@ -11,21 +10,13 @@ namespace lve {
 
   namespace {
     std::shared_ptr<LveTexture> loadTexture(
-      LveDevice &device,
+      const MaterialTextureLoader &textureLoader,
       const std::string &path,
+      TextureUsage usage,
       std::string *outError) {
-      if (path.empty()) return {};
+      if (path.empty() || !textureLoader) return {};
       try {
-        ImageData image{};
-        if (!loadImageDataFromFile(path, image, outError)) {
-          return {};
-        }
-        auto tex = LveTexture::createTextureFromRgba(
-          device,
-          image.pixels.data(),
-          image.width,
-          image.height);
-        return std::shared_ptr<LveTexture>(std::move(tex));
+        return textureLoader(path, usage, outError);
       } catch (const std::exception &e) {
         if (outError) {
           *outError = e.what();
@@ -46,11 +37,11 @@ namespace lve {
     }
   } // namespace
 
-  LveMaterial::LveMaterial(LveDevice &device)
-    : device{device} {}
+  LveMaterial::LveMaterial(MaterialTextureLoader textureLoader)
+    : textureLoader{std::move(textureLoader)} {}
 
   std::shared_ptr<LveMaterial> LveMaterial::loadFromFile(
-    LveDevice &device,
+    MaterialTextureLoader textureLoader,
     const std::string &path,
     std::string *outError,
     const std::function<std::string(const std::string &)> &pathResolver) {
@@ -59,7 +50,7 @@ namespace lve {
       return {};
     }
 
-    auto material = std::make_shared<LveMaterial>(device);
+    auto material = std::make_shared<LveMaterial>(std::move(textureLoader));
     material->path = path;
     material->applyData(parsed, outError, pathResolver);
     return material;
@@ -85,6 +76,7 @@ namespace lve {
 
     auto updateTexture = [&](const std::string &newPath,
                              const std::string &oldPath,
+                             TextureUsage usage,
                              std::shared_ptr<LveTexture> &target) {
       if (newPath == oldPath) {
         return;
@@ -93,7 +85,7 @@ namespace lve {
       target.reset();
       if (!newPath.empty()) {
         std::string localError;
-        target = loadTexture(device, resolveTexturePath(newPath), &localError);
+        target = loadTexture(textureLoader, resolveTexturePath(newPath), usage, &localError);
         if (!target && !localError.empty()) {
           ok = false;
           if (firstError.empty()) {
@@ -106,11 +98,15 @@ namespace lve {
       }
     };
 
-    updateTexture(data.textures.baseColor, previous.textures.baseColor, baseColorTexture);
-    updateTexture(data.textures.normal, previous.textures.normal, normalTexture);
-    updateTexture(data.textures.metallicRoughness, previous.textures.metallicRoughness, metallicRoughnessTexture);
-    updateTexture(data.textures.occlusion, previous.textures.occlusion, occlusionTexture);
-    updateTexture(data.textures.emissive, previous.textures.emissive, emissiveTexture);
+    updateTexture(data.textures.baseColor, previous.textures.baseColor, TextureUsage::Color, baseColorTexture);
+    updateTexture(data.textures.normal, previous.textures.normal, TextureUsage::Normal, normalTexture);
+    updateTexture(
+      data.textures.metallicRoughness,
+      previous.textures.metallicRoughness,
+      TextureUsage::MetallicRoughness,
+      metallicRoughnessTexture);
+    updateTexture(data.textures.occlusion, previous.textures.occlusion, TextureUsage::Occlusion, occlusionTexture);
+    updateTexture(data.textures.emissive, previous.textures.emissive, TextureUsage::Color, emissiveTexture);
 
     if (!firstError.empty() && outError) {
       *outError = firstError;
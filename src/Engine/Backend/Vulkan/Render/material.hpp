@@ -1,7 +1,6 @@
 #pragma once
 
 #include "Engine/Backend/render_assets.hpp"
-#include "Engine/Backend/Vulkan/Core/device.hpp"
 #include "Engine/Backend/Vulkan/Render/texture.hpp"
 #include "Engine/material_data.hpp"
 
@@ -11,12 +10,18 @@
 
 namespace lve {
 
+  // loads the texture for one material slot, the factory hands out shared registry entries
+  using MaterialTextureLoader = std::function<std::shared_ptr<LveTexture>(
+    const std::string &path,
+    TextureUsage usage,
+    std::string *outError)>;
+
   class LveMaterial : public backend::RenderMaterial {
   public:
-    explicit LveMaterial(LveDevice &device);
+    explicit LveMaterial(MaterialTextureLoader textureLoader);
 
     static std::shared_ptr<LveMaterial> loadFromFile(
-      LveDevice &device,
+      MaterialTextureLoader textureLoader,
       const std::string &path,
       std::string *outError = nullptr,
       const std::function<std::string(const std::string &)> &pathResolver = {});
@@ -38,7 +43,7 @@ namespace lve {
     const backend::RenderTexture *getEmissiveTexture() const override { return emissiveTexture.get(); }
 
   private:
-    LveDevice &device;
+    MaterialTextureLoader textureLoader;
     MaterialData data{};
     std::string path{};
 
@@ -1,9 +1,12 @@
 #include "Engine/Backend/Vulkan/Render/model.hpp"
 
+#include "Engine/Backend/Vulkan/Core/upload_manager.hpp"
 #include "Engine/Backend/Vulkan/Render/texture.hpp"
 
 // std
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <limits>
 #include <stdexcept>
@@ -11,16 +14,84 @@
 
 namespace lve {
 
+  namespace {
+    std::uint16_t quantizeUnorm16(float value) {
+      return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.f, 1.f) * 65535.f));
+    }
+
+    // octahedral map of the unit sphere onto [-1, 1]^2, decoded in simple_shader.vert
+    glm::vec2 octEncode(const glm::vec3 &n) {
+      const float sum = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+      if (sum <= 0.f) {
+        return glm::vec2{0.f};
+      }
+      glm::vec2 p = glm::vec2{n.x, n.y} / sum;
+      if (n.z < 0.f) {
+        const glm::vec2 folded{1.f - std::abs(p.y), 1.f - std::abs(p.x)};
+        p = {p.x >= 0.f ? folded.x : -folded.x, p.y >= 0.f ? folded.y : -folded.y};
+      }
+      return p;
+    }
+
+    backend::CompactModelVertex compactVertex(
+      const backend::ModelVertex &vertex,
+      const glm::vec4 &tangent,
+      const glm::vec3 &origin,
+      const glm::vec3 &invExtent) {
+      backend::CompactModelVertex out{};
+      const glm::vec3 position = (vertex.position - origin) * invExtent;
+      out.position[0] = quantizeUnorm16(position.x);
+      out.position[1] = quantizeUnorm16(position.y);
+      out.position[2] = quantizeUnorm16(position.z);
+      out.position[3] = 0;
+      out.color = glm::packUnorm4x8(glm::vec4{vertex.color, 1.f});
+      out.normal = glm::packSnorm2x16(octEncode(vertex.normal));
+      out.uv = glm::packHalf2x16(vertex.uv);
+      out.tangent = glm::packSnorm4x8(tangent);
+      return out;
+    }
+  } // namespace
+
+  LveModel::LveModel(
+    LveDevice &device,
+    const backend::ModelData &data,
+    std::vector<std::shared_ptr<LveTexture>> materialTextures)
+    : LveModel{
+        device,
+        data,
+        backend::ModelGeometryView{
+          data.vertices.data(),
+          data.vertices.size(),
+          data.tangents.size() == data.vertices.size() ? data.tangents.data() : nullptr,
+          data.indices.data(),
+          data.indices.size()},
+        std::move(materialTextures)} {}
+
   LveModel::LveModel(
     LveDevice &device,
     const backend::ModelData &data,
+    const backend::ModelGeometryView &geometry,
     std::vector<std::shared_ptr<LveTexture>> materialTextures)
     : lveDevice{device}
     , subMeshes{data.subMeshes}
     , nodes{data.nodes}
     , materialDiffuseTextures{std::move(materialTextures)} {
-    createVertexBuffers(data.vertices);
-    createIndexBuffers(data.indices);
+    if (data.vertexFormat == backend::ModelVertexFormat::Compact) {
+      createCompactVertexBuffers(geometry.vertices, geometry.tangents, geometry.vertexCount);
+    } else {
+      createVertexBuffers(geometry.vertices, geometry.vertexCount);
+      if (geometry.tangents) {
+        createTangentBuffer(geometry.tangents, geometry.vertexCount);
+      }
+    }
+    createIndexBuffers(geometry.indices, geometry.indexCount);
+
+    // LOD ranges are appended after every submesh, a whole model draw stops before them
+    baseIndexCount = subMeshes.empty() ? indexCount : 0;
+    for (const auto &subMesh : subMeshes) {
+      baseIndexCount = std::max(baseIndexCount, subMesh.firstIndex + subMesh.indexCount);
+    }
+    baseIndexCount = std::min(baseIndexCount, indexCount);
 
     if (materialDiffuseTextures.size() < data.materials.size()) {
       materialDiffuseTextures.resize(data.materials.size());
@@ -37,59 +108,118 @@ namespace lve {
       materialPathInfo.push_back(std::move(info));
     }
 
-    calculateBoundingBox(data.vertices, data.indices);
+    calculateBoundingBox(geometry);
   }
 
-  LveModel::~LveModel() {}
+  LveModel::~LveModel() {
+    // the copy into our buffers may still be queued
+    lveDevice.uploads().wait(uploadTicket);
+  }
 
-  void LveModel::createVertexBuffers(const std::vector<backend::ModelVertex> &vertices) {
-    vertexCount = static_cast<uint32_t>(vertices.size());
+  void LveModel::createVertexBuffers(const backend::ModelVertex *vertices, std::size_t count) {
+    vertexCount = static_cast<uint32_t>(count);
     assert(vertexCount >= 3 && "Vertex count must be at least 3");
     VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
     uint32_t vertexSize = sizeof(vertices[0]);
 
-    LveBuffer stagingBuffer{
+    vertexBuffer = std::make_unique<LveBuffer>(
         lveDevice,
         vertexSize,
         vertexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    };
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    uploadTicket = lveDevice.uploads().uploadBuffer(
+        vertexBuffer->getBuffer(),
+        0,
+        vertices,
+        bufferSize,
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+  }
+
+  void LveModel::createTangentBuffer(const glm::vec4 *tangents, std::size_t count) {
+    tangentBuffer = std::make_unique<LveBuffer>(
+        lveDevice,
+        sizeof(glm::vec4),
+        static_cast<uint32_t>(count),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    uploadTicket = lveDevice.uploads().uploadBuffer(
+        tangentBuffer->getBuffer(),
+        0,
+        tangents,
+        sizeof(glm::vec4) * count,
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+  }
+
+  void LveModel::createCompactVertexBuffers(
+    const backend::ModelVertex *vertices,
+    const glm::vec4 *tangents,
+    std::size_t count) {
+    vertexCount = static_cast<uint32_t>(count);
+    assert(vertexCount >= 3 && "Vertex count must be at least 3");
+    vertexFormat = backend::ModelVertexFormat::Compact;
 
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)vertices.data());
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    for (std::size_t i = 0; i < count; ++i) {
+      min = glm::min(min, vertices[i].position);
+      max = glm::max(max, vertices[i].position);
+    }
+    // one extent for all axes keeps the decode a uniform scale, which normals and tangents can ignore
+    positionOrigin = min;
+    const glm::vec3 size = max - min;
+    positionExtent = std::max(size.x, std::max(size.y, size.z));
+    // a point cloud at one spot quantizes every vertex to 0, any extent decodes it back
+    if (!(positionExtent > 0.f)) {
+      positionExtent = 1.f;
+    }
+    const glm::vec3 invExtent{1.f / positionExtent};
+
+    std::vector<backend::CompactModelVertex> packed(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      packed[i] = compactVertex(vertices[i], tangents ? tangents[i] : glm::vec4{0.f}, positionOrigin, invExtent);
+    }
 
     vertexBuffer = std::make_unique<LveBuffer>(
         lveDevice,
-        vertexSize,
+        sizeof(backend::CompactModelVertex),
         vertexCount,
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    lveDevice.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
+    uploadTicket = lveDevice.uploads().uploadBuffer(
+        vertexBuffer->getBuffer(),
+        0,
+        packed.data(),
+        sizeof(backend::CompactModelVertex) * count,
+        VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
   }
 
-  void LveModel::createIndexBuffers(const std::vector<uint32_t> &indices) {
-    indexCount = static_cast<uint32_t>(indices.size());
+  void LveModel::createIndexBuffers(const uint32_t *indices, std::size_t count) {
+    indexCount = static_cast<uint32_t>(count);
     hasIndexBuffer = indexCount > 0;
 
     if (!hasIndexBuffer) {
       return;
     }
 
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
-    uint32_t indexSize = sizeof(indices[0]);
-
-    LveBuffer stagingBuffer{
-        lveDevice,
-        indexSize,
-        indexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    };
-
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void *)indices.data());
+    // every index of a model addresses the shared vertex buffer, so the vertex count decides the width
+    std::vector<uint16_t> narrowIndices;
+    const void *indexData = indices;
+    uint32_t indexSize = sizeof(uint32_t);
+    indexType = VK_INDEX_TYPE_UINT32;
+    if (vertexCount <= std::numeric_limits<uint16_t>::max() + 1u) {
+      narrowIndices.assign(indices, indices + count);
+      indexData = narrowIndices.data();
+      indexSize = sizeof(uint16_t);
+      indexType = VK_INDEX_TYPE_UINT16;
+    }
+    VkDeviceSize bufferSize = static_cast<VkDeviceSize>(indexSize) * indexCount;
 
     indexBuffer = std::make_unique<LveBuffer>(
         lveDevice,
@@ -98,22 +228,34 @@ namespace lve {
         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    lveDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
+    uploadTicket = lveDevice.uploads().uploadBuffer(
+        indexBuffer->getBuffer(),
+        0,
+        indexData,
+        bufferSize,
+        VK_ACCESS_INDEX_READ_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
   }
 
   void LveModel::draw(VkCommandBuffer commandBuffer) {
     if (hasIndexBuffer) {
-      vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+      vkCmdDrawIndexed(commandBuffer, baseIndexCount, 1, 0, 0, 0);
     } else {
       vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
     }
   }
 
-  void LveModel::drawSubMesh(VkCommandBuffer commandBuffer, const SubMesh &subMesh) {
-    if (!hasIndexBuffer || subMesh.indexCount == 0) {
+  void LveModel::drawSubMesh(VkCommandBuffer commandBuffer, const SubMesh &subMesh, std::size_t lod) {
+    uint32_t firstIndex = subMesh.firstIndex;
+    uint32_t count = subMesh.indexCount;
+    if (lod > 0 && lod <= subMesh.lods.size()) {
+      firstIndex = subMesh.lods[lod - 1].firstIndex;
+      count = subMesh.lods[lod - 1].indexCount;
+    }
+    if (!hasIndexBuffer || count == 0) {
       return;
     }
-    vkCmdDrawIndexed(commandBuffer, subMesh.indexCount, 1, subMesh.firstIndex, 0, 0);
+    vkCmdDrawIndexed(commandBuffer, count, 1, firstIndex, 0, 0);
   }
 
   void LveModel::computeNodeGlobals(
@@ -167,25 +309,23 @@ namespace lve {
   }
 
   void LveModel::bind(VkCommandBuffer commandBuffer) {
-    VkBuffer buffers[] = {vertexBuffer->getBuffer()};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+    VkBuffer buffers[] = {vertexBuffer->getBuffer(), tangentBuffer ? tangentBuffer->getBuffer() : VK_NULL_HANDLE};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, tangentBuffer ? 2 : 1, buffers, offsets);
 
     if (hasIndexBuffer) {
-      vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+      vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, indexType);
     }
   }
 
-  void LveModel::calculateBoundingBox(
-    const std::vector<backend::ModelVertex>& vertices,
-    const std::vector<uint32_t>& indices) {
+  void LveModel::calculateBoundingBox(const backend::ModelGeometryView &geometry) {
     glm::vec3 min(std::numeric_limits<float>::max());
     glm::vec3 max(std::numeric_limits<float>::lowest());
 
-    if (nodes.empty() || subMeshes.empty() || indices.empty()) {
-      for (const auto& vertex : vertices) {
-        min = glm::min(min, vertex.position);
-        max = glm::max(max, vertex.position);
+    if (nodes.empty() || subMeshes.empty() || geometry.indexCount == 0) {
+      for (std::size_t i = 0; i < geometry.vertexCount; ++i) {
+        min = glm::min(min, geometry.vertices[i].position);
+        max = glm::max(max, geometry.vertices[i].position);
       }
       boundingBox.min = min;
       boundingBox.max = max;
@@ -204,10 +344,10 @@ namespace lve {
         }
         const auto &subMesh = subMeshes[static_cast<std::size_t>(meshIndex)];
         const uint32_t end = subMesh.firstIndex + subMesh.indexCount;
-        for (uint32_t i = subMesh.firstIndex; i < end && i < indices.size(); ++i) {
-          const uint32_t vertexIndex = indices[i];
-          if (vertexIndex >= vertices.size()) continue;
-          const glm::vec4 pos = nodeTransform * glm::vec4(vertices[vertexIndex].position, 1.f);
+        for (uint32_t i = subMesh.firstIndex; i < end && i < geometry.indexCount; ++i) {
+          const uint32_t vertexIndex = geometry.indices[i];
+          if (vertexIndex >= geometry.vertexCount) continue;
+          const glm::vec4 pos = nodeTransform * glm::vec4(geometry.vertices[vertexIndex].position, 1.f);
           const glm::vec3 pos3{pos.x, pos.y, pos.z};
           min = glm::min(min, pos3);
           max = glm::max(max, pos3);
@@ -219,21 +359,47 @@ namespace lve {
     boundingBox.max = max;
   }
 
-  std::vector<VkVertexInputBindingDescription> LveModel::getBindingDescriptions() {
+  std::vector<VkVertexInputBindingDescription> LveModel::getBindingDescriptions(
+    backend::ModelVertexFormat format,
+    TangentInput tangents) {
     std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
     bindingDescriptions[0].binding = 0;
-    bindingDescriptions[0].stride = sizeof(backend::ModelVertex);
+    bindingDescriptions[0].stride = format == backend::ModelVertexFormat::Compact
+      ? sizeof(backend::CompactModelVertex)
+      : sizeof(backend::ModelVertex);
     bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    if (format != backend::ModelVertexFormat::Compact && tangents != TangentInput::None) {
+      bindingDescriptions.push_back({
+        1,
+        sizeof(glm::vec4),
+        tangents == TangentInput::PerVertex ? VK_VERTEX_INPUT_RATE_VERTEX : VK_VERTEX_INPUT_RATE_INSTANCE});
+    }
     return bindingDescriptions;
   }
 
-  std::vector<VkVertexInputAttributeDescription> LveModel::getAttributeDescriptions() {
+  std::vector<VkVertexInputAttributeDescription> LveModel::getAttributeDescriptions(
+    backend::ModelVertexFormat format,
+    TangentInput tangents) {
     std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
 
+    // same locations as the full layout, the shader decodes the octahedral normal
+    if (format == backend::ModelVertexFormat::Compact) {
+      using Compact = backend::CompactModelVertex;
+      attributeDescriptions.push_back({0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(Compact, position)});
+      attributeDescriptions.push_back({1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(Compact, color)});
+      attributeDescriptions.push_back({2, 0, VK_FORMAT_R16G16_SNORM, offsetof(Compact, normal)});
+      attributeDescriptions.push_back({3, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(Compact, uv)});
+      attributeDescriptions.push_back({4, 0, VK_FORMAT_R8G8B8A8_SNORM, offsetof(Compact, tangent)});
+      return attributeDescriptions;
+    }
+
     attributeDescriptions.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(backend::ModelVertex, position)});
     attributeDescriptions.push_back({1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(backend::ModelVertex, color)});
     attributeDescriptions.push_back({2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(backend::ModelVertex, normal)});
     attributeDescriptions.push_back({3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(backend::ModelVertex, uv)});
+    if (tangents != TangentInput::None) {
+      attributeDescriptions.push_back({4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, 0});
+    }
 
     return attributeDescriptions;
   }
@@ -3,6 +3,7 @@
 #include "Engine/Backend/render_assets.hpp"
 #include "Engine/Backend/Vulkan/Core/buffer.hpp"
 #include "Engine/Backend/Vulkan/Core/device.hpp"
+#include "Engine/Backend/Vulkan/Core/upload_manager.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -31,17 +32,36 @@ namespace lve {
       LveDevice &device,
       const backend::ModelData &data,
       std::vector<std::shared_ptr<LveTexture>> materialTextures);
+    // geometry is copied into staging during construction, data.vertices/indices are not used
+    LveModel(
+      LveDevice &device,
+      const backend::ModelData &data,
+      const backend::ModelGeometryView &geometry,
+      std::vector<std::shared_ptr<LveTexture>> materialTextures);
     ~LveModel();
 
     LveModel(const LveModel &) = delete;
     LveModel &operator=(const LveModel &) = delete;
 
-    static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
-    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+    // where the full layout's location 4 tangent comes from, the compact layout carries its own
+    enum class TangentInput {
+      None,       // no tangent attribute, for shaders that do not read one
+      PerVertex,  // binding 1, the model's tangent stream
+      Constant    // binding 1 at instance rate, one tangent for the whole draw
+    };
+
+    static std::vector<VkVertexInputBindingDescription> getBindingDescriptions(
+      backend::ModelVertexFormat format = backend::ModelVertexFormat::Full,
+      TangentInput tangents = TangentInput::None);
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(
+      backend::ModelVertexFormat format = backend::ModelVertexFormat::Full,
+      TangentInput tangents = TangentInput::None);
 
     void bind(VkCommandBuffer commandBuffer);
+    // every submesh at full detail
     void draw(VkCommandBuffer commandBuffer);
-    void drawSubMesh(VkCommandBuffer commandBuffer, const SubMesh &subMesh);
+    // lod 0 is the submesh itself, n selects subMesh.lods[n - 1]
+    void drawSubMesh(VkCommandBuffer commandBuffer, const SubMesh &subMesh, std::size_t lod = 0);
     void computeNodeGlobals(
       const std::vector<glm::mat4> &localOverrides,
       std::vector<glm::mat4> &outGlobals) const override;
@@ -56,20 +76,36 @@ namespace lve {
 
     const BoundingBox &getBoundingBox() const override { return boundingBox; }
 
+    backend::ModelVertexFormat getVertexFormat() const { return vertexFormat; }
+    // full layout models with a tangent stream, bind() puts it on binding 1
+    bool hasTangentStream() const { return tangentBuffer != nullptr; }
+    // compact positions are unorm16 in [0, 1], object space is origin + position * extent
+    const glm::vec3 &getPositionOrigin() const { return positionOrigin; }
+    float getPositionExtent() const { return positionExtent; }
+
   private:
-    void createVertexBuffers(const std::vector<backend::ModelVertex> &vertices);
-    void createIndexBuffers(const std::vector<uint32_t> &indices);
+    void createVertexBuffers(const backend::ModelVertex *vertices, std::size_t count);
+    void createTangentBuffer(const glm::vec4 *tangents, std::size_t count);
+    void createCompactVertexBuffers(const backend::ModelVertex *vertices, const glm::vec4 *tangents, std::size_t count);
+    void createIndexBuffers(const uint32_t *indices, std::size_t count);
 
-    void calculateBoundingBox(const std::vector<backend::ModelVertex> &vertices, const std::vector<uint32_t> &indices);
+    void calculateBoundingBox(const backend::ModelGeometryView &geometry);
 
     LveDevice &lveDevice;
 
     std::unique_ptr<LveBuffer> vertexBuffer;
+    std::unique_ptr<LveBuffer> tangentBuffer;
     uint32_t vertexCount;
+    backend::ModelVertexFormat vertexFormat{backend::ModelVertexFormat::Full};
+    glm::vec3 positionOrigin{0.f};
+    float positionExtent{1.f};
 
     bool hasIndexBuffer = false;
     std::unique_ptr<LveBuffer> indexBuffer;
     uint32_t indexCount;
+    uint32_t baseIndexCount{0};  // indices before the first LOD range
+    VkIndexType indexType{VK_INDEX_TYPE_UINT32};
+    UploadTicket uploadTicket{0};
 
     BoundingBox boundingBox;
     std::vector<SubMesh> subMeshes;
@@ -1,16 +1,66 @@
 #include "Engine/Backend/Vulkan/Render/render_backend.hpp"
 
 #include "Engine/Backend/Vulkan/Render/frame_info.hpp"
+#include "Engine/camera.hpp"
+#include "utils/game_object.hpp"
 
 #include <vulkan/vulkan.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace lve::backend {
 
-  VulkanRenderBackend::VulkanRenderBackend(LveWindow &window, LveDevice &device)
-    : renderer{window, device}, renderContext{device, renderer} {}
+  namespace {
+    // diameter in pixels of the object's bounding sphere; clip space spans 2 units per view height
+    float projectedSize(const LveCamera &camera, const LveGameObject &obj, float viewHeight) {
+      glm::vec3 center = obj.transform.translation;
+      float radius = 0.5f * std::max({obj.transform.scale.x, obj.transform.scale.y, obj.transform.scale.z});
+      if (obj.model) {
+        const ModelBoundingBox &bounds = obj.model->getBoundingBox();
+        center = glm::vec3(obj.transform.mat4() * glm::vec4(bounds.center(), 1.f));
+        radius = glm::length(bounds.halfSize() * glm::abs(obj.transform.scale));
+      }
+
+      const glm::mat4 &projection = camera.getProjection();
+      const float focal = std::abs(projection[1][1]);
+      if (projection[3][3] == 1.f) {
+        // orthographic, size does not depend on distance
+        return radius * focal * viewHeight;
+      }
+      const float distance = glm::length(glm::vec3(camera.getView() * glm::vec4(center, 1.f)));
+      if (distance <= radius) {
+        return viewHeight;
+      }
+      return radius * focal / distance * viewHeight;
+    }
+  } // namespace
+
+  VulkanRenderBackend::VulkanRenderBackend(
+    LveWindow &window,
+    LveDevice &device,
+    LveTextureStreamer &textureStreamer,
+    const FramePacingConfig &framePacing)
+    : renderer{window, device, framePacing},
+      renderContext{device, renderer},
+      textureStreamer{textureStreamer} {}
+
+  VulkanRenderBackend::VulkanRenderBackend(
+    LveDevice &device,
+    LveTextureStreamer &textureStreamer,
+    RenderExtent extent,
+    const FramePacingConfig &framePacing)
+    : renderer{device, VkExtent2D{extent.width, extent.height}, framePacing},
+      renderContext{device, renderer},
+      textureStreamer{textureStreamer} {}
 
   CommandBufferHandle VulkanRenderBackend::beginFrame() {
-    return reinterpret_cast<CommandBufferHandle>(renderContext.beginFrame());
+    VkCommandBuffer commandBuffer = renderContext.beginFrame();
+    if (commandBuffer != VK_NULL_HANDLE) {
+      // swaps streamed images before any descriptor of this frame is written
+      textureStreamer.update(renderer);
+    }
+    return reinterpret_cast<CommandBufferHandle>(commandBuffer);
   }
 
   void VulkanRenderBackend::endFrame() {
@@ -36,6 +86,10 @@ namespace lve::backend {
     renderContext.ensureOffscreenTargets(sceneWidth, sceneHeight, gameWidth, gameHeight);
   }
 
+  bool VulkanRenderBackend::readbackView(RenderView view, ImageData &outImage) {
+    return renderContext.readbackView(view, outImage);
+  }
+
   bool VulkanRenderBackend::wasSwapChainRecreated() const {
     return renderContext.wasSwapChainRecreated();
   }
@@ -64,6 +118,64 @@ namespace lve::backend {
     return renderer.getFrameindex();
   }
 
+  void VulkanRenderBackend::setFramePacing(const FramePacingConfig &config) {
+    renderer.setFramePacing(config);
+  }
+
+  FramePacingConfig VulkanRenderBackend::getFramePacing() const {
+    return renderer.getFramePacing();
+  }
+
+  const FramePacingStats &VulkanRenderBackend::getFramePacingStats() const {
+    return renderer.getFramePacingStats();
+  }
+
+  void VulkanRenderBackend::setTextureStreaming(const TextureStreamingConfig &config) {
+    textureStreamer.setConfig(config);
+  }
+
+  TextureStreamingConfig VulkanRenderBackend::getTextureStreaming() const {
+    return textureStreamer.getConfig();
+  }
+
+  const TextureStreamingStats &VulkanRenderBackend::getTextureStreamingStats() const {
+    return textureStreamer.getStats();
+  }
+
+  DescriptorStats VulkanRenderBackend::getDescriptorStats() const {
+    return renderContext.getDescriptorStats();
+  }
+
+  void VulkanRenderBackend::requestTextureLevels(
+    const LveCamera &camera,
+    const std::vector<LveGameObject*> &objects,
+    VkExtent2D viewExtent) {
+    const float viewHeight = static_cast<float>(viewExtent.height);
+    for (const LveGameObject *obj : objects) {
+      if (!obj || (!obj->model && !obj->diffuseMap)) {
+        continue;
+      }
+      float size = projectedSize(camera, *obj, viewHeight);
+      if (obj->isSprite) {
+        // one atlas cell covers the quad, the sheet is that many times larger
+        size *= static_cast<float>(std::max({obj->atlasColumns, obj->atlasRows, 1}));
+      }
+      textureStreamer.requestForScreenSize(obj->diffuseMap.get(), size);
+      if (obj->material) {
+        textureStreamer.requestForScreenSize(obj->material->getBaseColorTexture(), size);
+        textureStreamer.requestForScreenSize(obj->material->getNormalTexture(), size);
+        textureStreamer.requestForScreenSize(obj->material->getMetallicRoughnessTexture(), size);
+        textureStreamer.requestForScreenSize(obj->material->getOcclusionTexture(), size);
+        textureStreamer.requestForScreenSize(obj->material->getEmissiveTexture(), size);
+      }
+      if (obj->model) {
+        for (const auto &subMesh : obj->model->getSubMeshes()) {
+          textureStreamer.requestForScreenSize(obj->model->getDiffuseTextureForSubMesh(subMesh), size);
+        }
+      }
+    }
+  }
+
   void VulkanRenderBackend::setWireframe(bool enabled) {
     renderContext.simpleSystem().setWireframe(enabled);
   }
@@ -82,11 +194,14 @@ namespace lve::backend {
       return;
     }
 
+    requestTextureLevels(camera, objects, renderContext.getSceneViewExtent());
+
     FrameInfo frameInfo = renderContext.makeFrameInfo(
       frameTime,
       camera,
       objects,
-      vkCommandBuffer);
+      vkCommandBuffer,
+      RenderView::Scene);
 
     GlobalUbo ubo{};
     ubo.projection = camera.getProjection();
@@ -111,11 +226,14 @@ namespace lve::backend {
       return;
     }
 
+    requestTextureLevels(camera, objects, renderContext.getGameViewExtent());
+
     FrameInfo frameInfo = renderContext.makeFrameInfo(
       frameTime,
       camera,
       objects,
-      vkCommandBuffer);
+      vkCommandBuffer,
+      RenderView::Game);
 
     GlobalUbo ubo{};
     ubo.projection = camera.getProjection();
@@ -3,11 +3,22 @@
 #include "Engine/Backend/render_backend.hpp"
 #include "Engine/Backend/Vulkan/Render/render_context.hpp"
 #include "Engine/Backend/Vulkan/Render/renderer.hpp"
+#include "Engine/Backend/Vulkan/Render/texture_streamer.hpp"
 
 namespace lve::backend {
   class VulkanRenderBackend final : public RenderBackend {
   public:
-    VulkanRenderBackend(LveWindow &window, LveDevice &device);
+    VulkanRenderBackend(
+      LveWindow &window,
+      LveDevice &device,
+      LveTextureStreamer &textureStreamer,
+      const FramePacingConfig &framePacing = {});
+    // renders into the offscreen targets only; extent is what getAspectRatio reports
+    VulkanRenderBackend(
+      LveDevice &device,
+      LveTextureStreamer &textureStreamer,
+      RenderExtent extent,
+      const FramePacingConfig &framePacing = {});
 
     CommandBufferHandle beginFrame() override;
     void endFrame() override;
@@ -20,6 +31,7 @@ namespace lve::backend {
       std::uint32_t sceneHeight,
       std::uint32_t gameWidth,
       std::uint32_t gameHeight) override;
+    bool readbackView(RenderView view, ImageData &outImage) override;
 
     bool wasSwapChainRecreated() const override;
     RenderPassHandle getSwapChainRenderPass() const override;
@@ -29,6 +41,16 @@ namespace lve::backend {
     float getAspectRatio() const override;
     int getFrameIndex() const override;
 
+    void setFramePacing(const FramePacingConfig &config) override;
+    FramePacingConfig getFramePacing() const override;
+    const FramePacingStats &getFramePacingStats() const override;
+
+    void setTextureStreaming(const TextureStreamingConfig &config) override;
+    TextureStreamingConfig getTextureStreaming() const override;
+    const TextureStreamingStats &getTextureStreamingStats() const override;
+
+    DescriptorStats getDescriptorStats() const override;
+
     void setWireframe(bool enabled) override;
     void setNormalView(bool enabled) override;
 
@@ -44,7 +66,13 @@ namespace lve::backend {
       CommandBufferHandle commandBuffer) override;
 
   private:
+    void requestTextureLevels(
+      const LveCamera &camera,
+      const std::vector<LveGameObject*> &objects,
+      VkExtent2D viewExtent);
+
     LveRenderer renderer;
     RenderContext renderContext;
+    LveTextureStreamer &textureStreamer;
   };
 } // namespace lve::backend
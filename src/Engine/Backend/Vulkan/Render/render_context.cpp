@@ -1,11 +1,16 @@
 #include "render_context.hpp"
 
+#include "Engine/Backend/Vulkan/Core/sampler_cache.hpp"
 #include "utils/game_object.hpp"
 
 #include <backends/imgui_impl_vulkan.h>
 
 // std
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstring>
+#include <future>
 #include <stdexcept>
 
 namespace lve {
@@ -20,6 +25,7 @@ namespace lve {
 
   RenderContext::~RenderContext() {
     vkDeviceWaitIdle(lveDevice.device());
+    lveRenderer.releaseRetiredResources(true);
     destroyOffscreenTarget(sceneViewTarget);
     destroyOffscreenTarget(gameViewTarget);
     destroyOffscreenRenderPass();
@@ -31,15 +37,16 @@ namespace lve {
       .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
       .build();
 
-    const uint32_t maxObjectSets =
-      LveGameObjectManager::MAX_GAME_OBJECTS * LveSwapChain::MAX_FRAMES_IN_FLIGHT;
+    // sized for the material set, the largest per-object layout
     constexpr uint32_t kMaterialTextureCount = 5;
-    objectDescriptorPool = LveDescriptorPool::Builder(lveDevice)
-      .setMaxSets(maxObjectSets)
-      .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxObjectSets * kMaterialTextureCount)
-      .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxObjectSets)
-      .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
-      .build();
+    for (int i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+      objectDescriptorPools.push_back(LveDescriptorAllocator::Builder(lveDevice)
+        .addSetSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, kMaterialTextureCount)
+        .addSetSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1)
+        .setSetsPerPool(LveGameObjectManager::MAX_GAME_OBJECTS)
+        .build());
+    }
+    objectDescriptorBaselines.assign(LveSwapChain::MAX_FRAMES_IN_FLIGHT, 0);
 
     uboBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
     for (int i = 0; i < uboBuffers.size(); i++) {
@@ -68,37 +75,65 @@ namespace lve {
   }
 
   void RenderContext::createRenderSystems() {
-    simpleRenderSystem = std::make_unique<SimpleRenderSystem>(
-      lveDevice,
-      offscreenRenderPass,
-      globalSetLayout->getDescriptorSetLayout());
-    spriteRenderSystem = std::make_unique<SpriteRenderSystem>(
-      lveDevice,
-      offscreenRenderPass,
-      globalSetLayout->getDescriptorSetLayout());
-    pointLightSystemPtr = std::make_unique<PointLightSystem>(
-      lveDevice,
-      offscreenRenderPass,
-      globalSetLayout->getDescriptorSetLayout());
+    // pipeline creation is thread-safe per VkDevice and the pipeline cache is internally
+    // synchronized, so each system compiles its pipelines on its own job
+    const VkRenderPass renderPass = offscreenRenderPass;
+    const VkDescriptorSetLayout setLayout = globalSetLayout->getDescriptorSetLayout();
+    auto simpleJob = std::async(std::launch::async, [this, renderPass, setLayout] {
+      return std::make_unique<SimpleRenderSystem>(lveDevice, renderPass, setLayout);
+    });
+    auto spriteJob = std::async(std::launch::async, [this, renderPass, setLayout] {
+      return std::make_unique<SpriteRenderSystem>(lveDevice, renderPass, setLayout);
+    });
+    auto pointLightJob = std::async(std::launch::async, [this, renderPass, setLayout] {
+      return std::make_unique<PointLightSystem>(lveDevice, renderPass, setLayout);
+    });
+
+    simpleRenderSystem = simpleJob.get();
+    spriteRenderSystem = spriteJob.get();
+    pointLightSystemPtr = pointLightJob.get();
   }
 
   VkCommandBuffer RenderContext::beginFrame() {
     auto commandBuffer = lveRenderer.beginFrame();
+    if (commandBuffer != nullptr) {
+      resetFrameDescriptors(lveRenderer.getFrameindex());
+    }
     if (lveRenderer.wasSwapChainRecreated()) {
-      vkDeviceWaitIdle(lveDevice.device());
-      if (objectDescriptorPool) {
-        objectDescriptorPool->resetPool();
-      }
-      destroyOffscreenTarget(sceneViewTarget);
-      destroyOffscreenTarget(gameViewTarget);
-      destroyOffscreenRenderPass();
-      createOffscreenRenderPass();
-      createRenderSystems();
+      // the renderer keeps the surface format across recreation and offscreen targets follow the
+      // editor viewports, so the offscreen pass, render systems and descriptor sets all stay valid
       swapChainRecreated = true;
     }
     return commandBuffer;
   }
 
+  void RenderContext::resetFrameDescriptors(int frameIndex) {
+    // the frame's fence has been waited on, nothing in flight uses this index's sets.
+    // Cached sets of destroyed objects or replaced meshes are never freed one by one. Once the
+    // pool holds twice what it took to draw the frame after the last reset, it is reset as a whole
+    // and objects rebuild their sets on the next draw, keeping the rebuilds amortized O(1).
+    auto &objectPool = *objectDescriptorPools[frameIndex];
+    auto &baseline = objectDescriptorBaselines[frameIndex];
+    const uint64_t allocated = objectPool.getStats().allocatedSets;
+    if (baseline == 0) {
+      baseline = allocated;
+    } else if (allocated > 2 * std::max<uint64_t>(baseline, kMinObjectDescriptorRecycle)) {
+      objectPool.reset();
+      baseline = 0;
+      objectDescriptorRecycles++;
+    }
+  }
+
+  backend::DescriptorStats RenderContext::getDescriptorStats() const {
+    backend::DescriptorStats stats{};
+    for (const auto &pool : objectDescriptorPools) {
+      stats.pools += pool->getStats().pools;
+      stats.objectSets += pool->getStats().allocatedSets;
+    }
+    stats.objectRecycles = objectDescriptorRecycles;
+    return stats;
+  }
+
   void RenderContext::endFrame() {
     lveRenderer.endFrame();
   }
@@ -142,6 +177,7 @@ namespace lve {
   bool RenderContext::beginSceneViewRenderPass(VkCommandBuffer commandBuffer) {
     if (sceneViewTarget.framebuffer == VK_NULL_HANDLE) return false;
     beginOffscreenRenderPass(commandBuffer, sceneViewTarget);
+    sceneViewTarget.hasContents = true;
     return true;
   }
 
@@ -152,6 +188,7 @@ namespace lve {
   bool RenderContext::beginGameViewRenderPass(VkCommandBuffer commandBuffer) {
     if (gameViewTarget.framebuffer == VK_NULL_HANDLE) return false;
     beginOffscreenRenderPass(commandBuffer, gameViewTarget);
+    gameViewTarget.hasContents = true;
     return true;
   }
 
@@ -191,16 +228,20 @@ namespace lve {
     float frameTime,
     LveCamera &camera,
     std::vector<LveGameObject*> &gameObjects,
-    VkCommandBuffer commandBuffer) {
+    VkCommandBuffer commandBuffer,
+    backend::RenderView view) {
     int frameIndex = lveRenderer.getFrameindex();
+    const VkExtent2D extent = view == backend::RenderView::Scene ? getSceneViewExtent() : getGameViewExtent();
     return FrameInfo{
       frameIndex,
       frameTime,
       commandBuffer,
       camera,
       globalDescriptorSets[frameIndex],
-      *objectDescriptorPool,
-      gameObjects};
+      *objectDescriptorPools[frameIndex],
+      gameObjects,
+      view,
+      static_cast<float>(extent.height)};
   }
 
   void RenderContext::updateGlobalUbo(int frameIndex, const GlobalUbo &ubo) {
@@ -294,10 +335,8 @@ namespace lve {
       ImGui_ImplVulkan_RemoveTexture(target.imguiDescriptor);
       target.imguiDescriptor = VK_NULL_HANDLE;
     }
-    if (target.sampler != VK_NULL_HANDLE) {
-      vkDestroySampler(lveDevice.device(), target.sampler, nullptr);
-      target.sampler = VK_NULL_HANDLE;
-    }
+    // owned by the device's sampler cache
+    target.sampler = VK_NULL_HANDLE;
     if (target.framebuffer != VK_NULL_HANDLE) {
       vkDestroyFramebuffer(lveDevice.device(), target.framebuffer, nullptr);
       target.framebuffer = VK_NULL_HANDLE;
@@ -306,29 +345,25 @@ namespace lve {
       vkDestroyImageView(lveDevice.device(), target.colorView, nullptr);
       target.colorView = VK_NULL_HANDLE;
     }
-    if (target.colorImage != VK_NULL_HANDLE) {
-      vkDestroyImage(lveDevice.device(), target.colorImage, nullptr);
-      target.colorImage = VK_NULL_HANDLE;
-    }
-    if (target.colorMemory != VK_NULL_HANDLE) {
-      vkFreeMemory(lveDevice.device(), target.colorMemory, nullptr);
-      target.colorMemory = VK_NULL_HANDLE;
-    }
+    lveDevice.destroyImage(target.colorImage, target.colorMemory);
+    target.colorImage = VK_NULL_HANDLE;
     if (target.depthView != VK_NULL_HANDLE) {
       vkDestroyImageView(lveDevice.device(), target.depthView, nullptr);
       target.depthView = VK_NULL_HANDLE;
     }
-    if (target.depthImage != VK_NULL_HANDLE) {
-      vkDestroyImage(lveDevice.device(), target.depthImage, nullptr);
-      target.depthImage = VK_NULL_HANDLE;
-    }
-    if (target.depthMemory != VK_NULL_HANDLE) {
-      vkFreeMemory(lveDevice.device(), target.depthMemory, nullptr);
-      target.depthMemory = VK_NULL_HANDLE;
-    }
+    lveDevice.destroyImage(target.depthImage, target.depthMemory);
+    target.depthImage = VK_NULL_HANDLE;
     target.extent = {};
   }
 
+  void RenderContext::retireOffscreenTarget(OffscreenTarget &target) {
+    // in-flight frames may still sample or render into the old images
+    lveRenderer.retireResource([this, retired = target]() mutable {
+      destroyOffscreenTarget(retired);
+    });
+    target = OffscreenTarget{};
+  }
+
   void RenderContext::createOffscreenTarget(OffscreenTarget &target, VkExtent2D extent) {
     VkImageCreateInfo colorInfo{};
     colorInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -341,7 +376,8 @@ namespace lve {
     colorInfo.format = offscreenColorFormat;
     colorInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     colorInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    colorInfo.usage =
+      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
     colorInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     colorInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     lveDevice.createImageWithInfo(
@@ -424,15 +460,16 @@ namespace lve {
     samplerInfo.minLod = 0.0f;
     samplerInfo.maxLod = 1.0f;
     samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
-    if (vkCreateSampler(lveDevice.device(), &samplerInfo, nullptr, &target.sampler) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create offscreen sampler");
+    target.sampler = lveDevice.samplers().getSampler(samplerInfo);
+
+    // there is no ImGui backend to display the view without a window
+    if (!lveRenderer.isHeadless()) {
+      target.imguiDescriptor = ImGui_ImplVulkan_AddTexture(
+        target.sampler,
+        target.colorView,
+        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     }
 
-    target.imguiDescriptor = ImGui_ImplVulkan_AddTexture(
-      target.sampler,
-      target.colorView,
-      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
     target.extent = extent;
   }
 
@@ -446,23 +483,105 @@ namespace lve {
     const bool destroyScene = !wantScene && sceneViewTarget.framebuffer != VK_NULL_HANDLE;
     const bool destroyGame = !wantGame && gameViewTarget.framebuffer != VK_NULL_HANDLE;
 
-    if (rebuildScene || rebuildGame || destroyScene || destroyGame) {
-      vkDeviceWaitIdle(lveDevice.device());
-    }
-
     if (rebuildScene || destroyScene) {
-      destroyOffscreenTarget(sceneViewTarget);
+      retireOffscreenTarget(sceneViewTarget);
       if (rebuildScene) {
         createOffscreenTarget(sceneViewTarget, {sceneWidth, sceneHeight});
       }
     }
 
     if (rebuildGame || destroyGame) {
-      destroyOffscreenTarget(gameViewTarget);
+      retireOffscreenTarget(gameViewTarget);
       if (rebuildGame) {
         createOffscreenTarget(gameViewTarget, {gameWidth, gameHeight});
       }
     }
   }
 
+  bool RenderContext::readbackView(backend::RenderView view, ImageData &outImage) {
+    assert(!lveRenderer.isFrameInProgress() && "Can't read back a view while its frame is still recording");
+    const OffscreenTarget &target = view == backend::RenderView::Scene ? sceneViewTarget : gameViewTarget;
+    if (target.framebuffer == VK_NULL_HANDLE || !target.hasContents) {
+      return false;
+    }
+
+    bool swapRedBlue = false;
+    switch (offscreenColorFormat) {
+      case VK_FORMAT_R8G8B8A8_UNORM:
+      case VK_FORMAT_R8G8B8A8_SRGB:
+        break;
+      case VK_FORMAT_B8G8R8A8_UNORM:
+      case VK_FORMAT_B8G8R8A8_SRGB:
+        swapRedBlue = true;
+        break;
+      default:
+        return false;
+    }
+
+    const uint32_t pixelCount = target.extent.width * target.extent.height;
+    LveBuffer stagingBuffer{
+      lveDevice,
+      4,
+      pixelCount,
+      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+
+    // submitted on the graphics queue after the frame, so the barrier orders the copy behind
+    // the view's last render pass without waiting on the frame fences
+    VkCommandBuffer commandBuffer = lveDevice.beginSingleTimeCommands();
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = target.colorImage;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(
+      commandBuffer,
+      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {target.extent.width, target.extent.height, 1};
+    vkCmdCopyImageToBuffer(
+      commandBuffer,
+      target.colorImage,
+      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      stagingBuffer.getBuffer(),
+      1,
+      &region);
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(
+      commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+      0, 0, nullptr, 0, nullptr, 1, &barrier);
+    lveDevice.endSingleTimeCommands(commandBuffer);
+
+    if (stagingBuffer.map() != VK_SUCCESS) {
+      throw std::runtime_error("failed to map readback buffer");
+    }
+    outImage.width = static_cast<int>(target.extent.width);
+    outImage.height = static_cast<int>(target.extent.height);
+    outImage.channels = 4;
+    outImage.pixels.resize(static_cast<size_t>(pixelCount) * 4);
+    std::memcpy(outImage.pixels.data(), stagingBuffer.getMappedMemory(), outImage.pixels.size());
+    stagingBuffer.unmap();
+    if (swapRedBlue) {
+      for (size_t i = 0; i < outImage.pixels.size(); i += 4) {
+        std::swap(outImage.pixels[i], outImage.pixels[i + 2]);
+      }
+    }
+    return true;
+  }
+
 } // namespace lve
@@ -8,6 +8,7 @@
 #include "Engine/Backend/Vulkan/Render/renderer.hpp"
 #include "Engine/Backend/Vulkan/Render/simple_render_system.hpp"
 #include "Engine/Backend/Vulkan/Render/sprite_render_system.hpp"
+#include "Engine/IO/image_data.hpp"
 
 // std
 #include <cstdint>
@@ -29,6 +30,8 @@ namespace lve {
     bool beginGameViewRenderPass(VkCommandBuffer commandBuffer);
     void endGameViewRenderPass(VkCommandBuffer commandBuffer);
     void ensureOffscreenTargets(uint32_t sceneWidth, uint32_t sceneHeight, uint32_t gameWidth, uint32_t gameHeight);
+    // copies the view's last submitted frame into tightly packed RGBA8, blocking until the GPU is done
+    bool readbackView(backend::RenderView view, ImageData &outImage);
 
     bool wasSwapChainRecreated() const;
     void clearSwapChainRecreated();
@@ -39,31 +42,43 @@ namespace lve {
     VkExtent2D getSceneViewExtent() const;
     VkExtent2D getGameViewExtent() const;
 
-    FrameInfo makeFrameInfo(float frameTime, LveCamera &camera, std::vector<LveGameObject*> &gameObjects, VkCommandBuffer commandBuffer);
+    FrameInfo makeFrameInfo(
+      float frameTime,
+      LveCamera &camera,
+      std::vector<LveGameObject*> &gameObjects,
+      VkCommandBuffer commandBuffer,
+      backend::RenderView view);
     void updateGlobalUbo(int frameIndex, const GlobalUbo &ubo);
+    backend::DescriptorStats getDescriptorStats() const;
 
     SimpleRenderSystem &simpleSystem() { return *simpleRenderSystem; }
     SpriteRenderSystem &spriteSystem() { return *spriteRenderSystem; }
     PointLightSystem &pointLightSystem() { return *pointLightSystemPtr; }
 
   private:
+    // below this many cached sets a pool is never worth recycling
+    static constexpr std::uint64_t kMinObjectDescriptorRecycle = 256;
+
     struct OffscreenTarget {
       VkExtent2D extent{};
       VkImage colorImage{VK_NULL_HANDLE};
-      VkDeviceMemory colorMemory{VK_NULL_HANDLE};
+      LveAllocation colorMemory{};
       VkImageView colorView{VK_NULL_HANDLE};
       VkImage depthImage{VK_NULL_HANDLE};
-      VkDeviceMemory depthMemory{VK_NULL_HANDLE};
+      LveAllocation depthMemory{};
       VkImageView depthView{VK_NULL_HANDLE};
       VkFramebuffer framebuffer{VK_NULL_HANDLE};
       VkSampler sampler{VK_NULL_HANDLE};
       VkDescriptorSet imguiDescriptor{VK_NULL_HANDLE};
+      bool hasContents{false};  // rendered at least once, so the color image is in SHADER_READ_ONLY
     };
 
     void createBuffersAndDescriptors();
+    void resetFrameDescriptors(int frameIndex);
     void createOffscreenRenderPass();
     void destroyOffscreenRenderPass();
     void destroyOffscreenTarget(OffscreenTarget &target);
+    void retireOffscreenTarget(OffscreenTarget &target);
     void createOffscreenTarget(OffscreenTarget &target, VkExtent2D extent);
     void beginOffscreenRenderPass(VkCommandBuffer commandBuffer, const OffscreenTarget &target);
     void createRenderSystems();
@@ -72,7 +87,10 @@ namespace lve {
     LveRenderer &lveRenderer;
 
     std::unique_ptr<LveDescriptorPool> globalPool{};
-    std::unique_ptr<LveDescriptorPool> objectDescriptorPool{};
+    // one per frame in flight, so a pool is only reset once the frame that used it has finished
+    std::vector<std::unique_ptr<LveDescriptorAllocator>> objectDescriptorPools{};
+    std::vector<std::uint64_t> objectDescriptorBaselines{};
+    std::uint64_t objectDescriptorRecycles{0};
     std::vector<std::unique_ptr<LveBuffer>> uboBuffers;
     std::unique_ptr<LveDescriptorSetLayout> globalSetLayout;
     std::vector<VkDescriptorSet> globalDescriptorSets;
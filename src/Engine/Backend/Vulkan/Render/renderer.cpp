@@ -1,38 +1,177 @@
 #include "renderer.hpp"
 
+#include "Engine/Backend/Vulkan/Core/upload_manager.hpp"
+
 // std
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <stdexcept>
+#include <thread>
 
 namespace lve {
 
-  LveRenderer::LveRenderer(LveWindow &window, LveDevice &device) : lveWindow{window}, lveDevice{device}{
+  static_assert(backend::kMaxFramesInFlight <= LveSwapChain::MAX_FRAMES_IN_FLIGHT, "swap chain must fit every frame in flight");
+
+  namespace {
+    VkPresentModeKHR toVkPresentMode(backend::PresentMode mode) {
+      switch (mode) {
+        case backend::PresentMode::Mailbox:
+          return VK_PRESENT_MODE_MAILBOX_KHR;
+        case backend::PresentMode::Immediate:
+          return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        case backend::PresentMode::Fifo:
+        default:
+          return VK_PRESENT_MODE_FIFO_KHR;
+      }
+    }
+
+    backend::FramePacingConfig sanitizePacing(backend::FramePacingConfig pacing) {
+      pacing.framesInFlight = std::clamp(pacing.framesInFlight, 1, backend::kMaxFramesInFlight);
+      pacing.maxFrameRate = std::max(pacing.maxFrameRate, 0.f);
+      return pacing;
+    }
+
+    void accumulate(backend::FrameTimingSample &average, backend::FrameTimingSample &peak, const backend::FrameTimingSample &sample, bool first) {
+      constexpr double kSmoothing = 0.1;
+      auto blend = [&](double &avg, double &max, double value) {
+        avg = first ? value : avg + (value - avg) * kSmoothing;
+        max = std::max(max, value);
+      };
+      blend(average.fenceWaitMs, peak.fenceWaitMs, sample.fenceWaitMs);
+      blend(average.acquireMs, peak.acquireMs, sample.acquireMs);
+      blend(average.presentIntervalMs, peak.presentIntervalMs, sample.presentIntervalMs);
+      blend(average.limiterSleepMs, peak.limiterSleepMs, sample.limiterSleepMs);
+    }
+  } // namespace
+
+  LveRenderer::LveRenderer(LveWindow &window, LveDevice &device, const backend::FramePacingConfig &pacing)
+    : lveWindow{&window}, lveDevice{device}, framePacing{sanitizePacing(pacing)} {
     recreateSwapChain();
     createCommandBuffers();
   }
 
-  LveRenderer::~LveRenderer() { freeCommandBuffers(); }
+  LveRenderer::LveRenderer(LveDevice &device, VkExtent2D extent, const backend::FramePacingConfig &pacing)
+    : lveDevice{device}, headlessExtent{extent}, framePacing{sanitizePacing(pacing)} {
+    createHeadlessFences();
+    createCommandBuffers();
+  }
+
+  LveRenderer::~LveRenderer() {
+    vkDeviceWaitIdle(lveDevice.device());
+    releaseRetiredResources(true);
+    freeCommandBuffers();
+    destroyHeadlessFences();
+  }
+
+  float LveRenderer::getAspectRatio() const {
+    if (lveSwapChain) {
+      return lveSwapChain->extentAspectRatio();
+    }
+    return headlessExtent.height > 0
+      ? static_cast<float>(headlessExtent.width) / static_cast<float>(headlessExtent.height)
+      : 1.f;
+  }
 
   void LveRenderer::recreateSwapChain(){
-    auto extent = lveWindow.getExtent();
+    auto extent = lveWindow->getExtent();
     while (extent.width == 0 || extent.height == 0) {
-      extent = lveWindow.getExtent();
-      lveWindow.waitEvents();
+      extent = lveWindow->getExtent();
+      lveWindow->waitEvents();
     }
     const VkExtent2D swapExtent{extent.width, extent.height};
-    vkDeviceWaitIdle(lveDevice.device());
     swapChainRecreated = true;
 
+    SwapChainConfig swapChainConfig{};
+    swapChainConfig.framesInFlight = static_cast<uint32_t>(framePacing.framesInFlight);
+    swapChainConfig.presentMode = toVkPresentMode(framePacing.presentMode);
+
     if (lveSwapChain == nullptr) {
-      lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, swapExtent);
+      lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, swapExtent, swapChainConfig);
     } else {
       std::shared_ptr<LveSwapChain> oldSwapChain = std::move(lveSwapChain);
-      lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, swapExtent, oldSwapChain);
+      lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, swapExtent, oldSwapChain, swapChainConfig);
 
       if (!oldSwapChain->compareSwapFormats(*lveSwapChain.get())) {
         throw std::runtime_error("Swap chain image(or depth) format has changed!");
       }
+      // frames already submitted may still present from the old images
+      retireResource([oldSwapChain]() mutable { oldSwapChain.reset(); });
+    }
+  }
+
+  void LveRenderer::setFramePacing(const backend::FramePacingConfig &pacing) {
+    assert(!isFrameStarted && "Can't change frame pacing while a frame is in progress");
+    const backend::FramePacingConfig previous = framePacing;
+    framePacing = sanitizePacing(pacing);
+    nextFrameTime = Clock::time_point{};
+
+    if (framePacing.framesInFlight != previous.framesInFlight) {
+      // per-frame fences and command buffers are resized, so nothing may be in flight
+      vkDeviceWaitIdle(lveDevice.device());
+      releaseRetiredResources(true);
+      freeCommandBuffers();
+      currentFrameIndex = 0;
+      if (isHeadless()) {
+        destroyHeadlessFences();
+        createHeadlessFences();
+      } else {
+        lveSwapChain.reset();
+        recreateSwapChain();
+      }
+      createCommandBuffers();
+    } else if (framePacing.presentMode != previous.presentMode && !isHeadless()) {
+      recreateSwapChain();
+    }
+  }
+
+  void LveRenderer::limitFrameRate() {
+    pendingTiming.limiterSleepMs = 0.0;
+    if (framePacing.maxFrameRate <= 0.f) {
+      return;
+    }
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / static_cast<double>(framePacing.maxFrameRate)));
+    const auto now = Clock::now();
+    if (nextFrameTime > now) {
+      std::this_thread::sleep_until(nextFrameTime);
+      pendingTiming.limiterSleepMs =
+        std::chrono::duration<double, std::milli>(Clock::now() - now).count();
+    }
+    // don't try to catch up after a long frame, just restart the cadence
+    nextFrameTime = std::max(nextFrameTime, now) + period;
+  }
+
+  void LveRenderer::recordFrameTimings() {
+    const auto now = Clock::now();
+    pendingTiming.presentIntervalMs = lastPresentTime == Clock::time_point{}
+      ? 0.0
+      : std::chrono::duration<double, std::milli>(now - lastPresentTime).count();
+    lastPresentTime = now;
+
+    pacingStats.last = pendingTiming;
+    accumulate(pacingStats.average, pacingStats.peak, pendingTiming, pacingStats.frameCount == 0);
+    pacingStats.frameCount++;
+  }
+
+  void LveRenderer::retireResource(std::function<void()> release) {
+    retiredResources.push_back({submittedFrameCount, std::move(release)});
+  }
+
+  void LveRenderer::releaseRetiredResources(bool force) {
+    // called after the current slot's fence wait: every frame up to
+    // submittedFrameCount - framesInFlight has finished on the GPU
+    const uint64_t framesInFlight = static_cast<uint64_t>(framePacing.framesInFlight);
+    while (!retiredResources.empty()) {
+      auto &front = retiredResources.front();
+      if (!force && submittedFrameCount < front.retireFrame + framesInFlight) {
+        break;
+      }
+      auto release = std::move(front.release);
+      retiredResources.pop_front();
+      if (release) {
+        release();
+      }
     }
   }
 
@@ -45,7 +184,7 @@ namespace lve {
   }
 
   void LveRenderer::createCommandBuffers() {
-    commandBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    commandBuffers.resize(static_cast<size_t>(framePacing.framesInFlight));
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -66,9 +205,46 @@ namespace lve {
     commandBuffers.clear();
   }
 
+  void LveRenderer::createHeadlessFences() {
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    headlessFences.resize(static_cast<size_t>(framePacing.framesInFlight), VK_NULL_HANDLE);
+    for (auto &fence : headlessFences) {
+      if (vkCreateFence(lveDevice.device(), &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create headless frame fence!");
+      }
+    }
+  }
+
+  void LveRenderer::destroyHeadlessFences() {
+    for (VkFence fence : headlessFences) {
+      vkDestroyFence(lveDevice.device(), fence, nullptr);
+    }
+    headlessFences.clear();
+  }
+
+  void LveRenderer::waitHeadlessFence() {
+    const auto waitStart = Clock::now();
+    vkWaitForFences(lveDevice.device(), 1, &headlessFences[currentFrameIndex], VK_TRUE, UINT64_MAX);
+    pendingTiming.fenceWaitMs =
+      std::chrono::duration<double, std::milli>(Clock::now() - waitStart).count();
+    pendingTiming.acquireMs = 0.0;
+  }
+
   VkCommandBuffer LveRenderer::beginFrame() {
     assert(!isFrameStarted && "Can't call beginFrame while already in progress");
-    auto result = lveSwapChain->acquireNextImage(&currentImageIndex);
+    limitFrameRate();
+    VkResult result = VK_SUCCESS;
+    if (isHeadless()) {
+      waitHeadlessFence();
+    } else {
+      result = lveSwapChain->acquireNextImage(&currentImageIndex);
+      pendingTiming.fenceWaitMs = lveSwapChain->lastFenceWaitMs();
+      pendingTiming.acquireMs = lveSwapChain->lastAcquireMs();
+    }
+    releaseRetiredResources(false);
+    lveDevice.uploads().collect();
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
       recreateSwapChain();
       return nullptr;
@@ -94,22 +270,42 @@ namespace lve {
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
       throw std::runtime_error("failed to record command buffer!");
     }
-    auto result = lveSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || lveWindow.wasWindowResized()) {
-      lveWindow.resetWindowResizedFlag();
-      recreateSwapChain();
-    }
-    else if (result != VK_SUCCESS) {
-      throw std::runtime_error("failed to present swap chain image!");
+    // same queue, so uploads recorded so far are visible to this frame without a CPU wait
+    lveDevice.uploads().submit();
+    if (isHeadless()) {
+      VkSubmitInfo submitInfo{};
+      submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+      submitInfo.commandBufferCount = 1;
+      submitInfo.pCommandBuffers = &commandBuffer;
+      vkResetFences(lveDevice.device(), 1, &headlessFences[currentFrameIndex]);
+      if (vkQueueSubmit(lveDevice.graphicsQueue(), 1, &submitInfo, headlessFences[currentFrameIndex]) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit headless frame!");
+      }
+      submittedFrameCount++;
+      recordFrameTimings();
+    } else {
+      auto result = lveSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
+      submittedFrameCount++;
+      recordFrameTimings();
+      if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || lveWindow->wasWindowResized()) {
+        lveWindow->resetWindowResizedFlag();
+        recreateSwapChain();
+      }
+      else if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to present swap chain image!");
+      }
     }
 
     isFrameStarted = false;
-    currentFrameIndex = (currentFrameIndex + 1) % LveSwapChain::MAX_FRAMES_IN_FLIGHT;
+    currentFrameIndex = (currentFrameIndex + 1) % framePacing.framesInFlight;
   }
 
   void LveRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
     assert(isFrameStarted && "Can't call beginSwapChainRenderPass if frame is not in progress");
     assert(commandBuffer == getCurrentCommandBuffer() && "Can't begin render pass on command buffer from a different frame");
+    if (isHeadless()) {
+      return;
+    }
 
     VkRenderPassBeginInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -142,6 +338,9 @@ namespace lve {
   void LveRenderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer) {
     assert(isFrameStarted && "Can't call endSwapChainRenderPass if frame is not in progress");
     assert(commandBuffer == getCurrentCommandBuffer() && "Can't end render pass on command buffer from a different frame");
+    if (isHeadless()) {
+      return;
+    }
     vkCmdEndRenderPass(commandBuffer);
   }
 
@@ -3,27 +3,38 @@
 #include "Engine/Backend/Vulkan/Core/device.hpp"
 #include "Engine/Backend/Window/window.hpp"
 #include "Engine/Backend/Vulkan/Core/swap_chain.hpp"
+#include "Engine/Backend/render_types.hpp"
 
 // std
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <vector>
 
 namespace lve{
     class LveRenderer{
     public:
-        LveRenderer(LveWindow &window, LveDevice &device);
+        LveRenderer(LveWindow &window, LveDevice &device, const backend::FramePacingConfig &pacing = {});
+        // headless: frames are submitted with their own fences and never presented
+        LveRenderer(LveDevice &device, VkExtent2D extent, const backend::FramePacingConfig &pacing = {});
         ~LveRenderer();
 
         LveRenderer(const LveWindow &) = delete;
         LveRenderer &operator=(const LveWindow &) = delete;
 
-        VkRenderPass getSwapChainRenderPass() const { return lveSwapChain->getRenderPass(); }
-        float getAspectRatio() const { return lveSwapChain->extentAspectRatio(); }
-        VkExtent2D getSwapChainExtent() const { return lveSwapChain->getSwapChainExtent(); }
-        VkFormat getSwapChainImageFormat() const { return lveSwapChain->getSwapChainImageFormat(); }
-        size_t getSwapChainImageCount() const { return lveSwapChain->imageCount(); }
+        VkRenderPass getSwapChainRenderPass() const { return lveSwapChain ? lveSwapChain->getRenderPass() : VK_NULL_HANDLE; }
+        float getAspectRatio() const;
+        VkExtent2D getSwapChainExtent() const { return lveSwapChain ? lveSwapChain->getSwapChainExtent() : headlessExtent; }
+        VkFormat getSwapChainImageFormat() const { return lveSwapChain ? lveSwapChain->getSwapChainImageFormat() : HEADLESS_COLOR_FORMAT; }
+        size_t getSwapChainImageCount() const { return lveSwapChain ? lveSwapChain->imageCount() : 0; }
         bool isFrameInProgress() const { return isFrameStarted; }
+        bool isHeadless() const { return lveWindow == nullptr; }
+
+        // matches the sRGB encoding of the usual B8G8R8A8_SRGB surface, in a byte order readbacks can use directly
+        static constexpr VkFormat HEADLESS_COLOR_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
 
         VkCommandBuffer getCurrentCommandBuffer() const {
             assert(isFrameStarted && "Cannot get command buffer when frame not in progress");
@@ -41,18 +52,49 @@ namespace lve{
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
         bool wasSwapChainRecreated();
 
+        // frames in flight / present mode changes take effect through a swapchain rebuild
+        void setFramePacing(const backend::FramePacingConfig &pacing);
+        backend::FramePacingConfig getFramePacing() const { return framePacing; }
+        const backend::FramePacingStats &getFramePacingStats() const { return pacingStats; }
+
+        // Defers destruction until every frame that could still reference the resource has
+        // passed its in-flight fence (replaces vkDeviceWaitIdle on resize paths)
+        void retireResource(std::function<void()> release);
+        void releaseRetiredResources(bool force);
+
     private:
+        struct RetiredResource {
+            uint64_t retireFrame;
+            std::function<void()> release;
+        };
+
         void createCommandBuffers();
         void freeCommandBuffers();
+        void createHeadlessFences();
+        void destroyHeadlessFences();
+        void waitHeadlessFence();
         void recreateSwapChain();
+        void limitFrameRate();
+        void recordFrameTimings();
 
-        LveWindow& lveWindow;
+        LveWindow *lveWindow{nullptr};
         LveDevice& lveDevice;
         std::unique_ptr<LveSwapChain> lveSwapChain;
+        VkExtent2D headlessExtent{};
+        std::vector<VkFence> headlessFences;
         std::vector<VkCommandBuffer> commandBuffers;
+        std::deque<RetiredResource> retiredResources;
 
         uint32_t currentImageIndex;
         int currentFrameIndex{0};
+        uint64_t submittedFrameCount{0};
+
+        using Clock = std::chrono::steady_clock;
+        backend::FramePacingConfig framePacing{};
+        backend::FramePacingStats pacingStats{};
+        backend::FrameTimingSample pendingTiming{};
+        Clock::time_point nextFrameTime{};
+        Clock::time_point lastPresentTime{};
         bool isFrameStarted{false};
         bool swapChainRecreated{false};
     };
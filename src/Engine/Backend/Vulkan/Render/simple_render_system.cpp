@@ -10,8 +10,11 @@
 #include <glm/gtc/constants.hpp>
 
 // std
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
+#include <cstddef>
 #include <stdexcept>
 
 #include <iostream>
@@ -20,16 +23,108 @@ namespace lve {
 
   struct SimplePushConstantData {
     glm::mat4 modelMatrix{1.f};
-    glm::ivec4 flags0{0}; // textureMask, currentFrame, objectState, direction
+    glm::ivec4 flags0{0}; // textureMask and kCompactVertices, currentFrame, objectState, direction
     glm::vec4 baseColorFactor{1.f};
     glm::vec4 emissiveMetallic{0.f}; // emissive.rgb, metallic.a
     glm::vec4 miscFactors{1.f, 1.f, 1.f, 0.f}; // roughness, occlusionStrength, normalScale, debugView
   };
+  static_assert(sizeof(SimplePushConstantData) <= 128, "push constants beyond the guaranteed minimum");
+
+  // flags0.x bit telling the vertex shader to decode octahedral normals
+  constexpr int kCompactVertices = 1 << 5;
+
+  // Compact positions are dequantized by folding origin and extent into the model matrix. The
+  // extent is the same on every axis, so the shader's normalized directions are unaffected.
+  // Runs after flags0 is filled in.
+  static void setModelMatrix(SimplePushConstantData &push, const LveModel &model, const glm::mat4 &modelMatrix) {
+    push.modelMatrix = modelMatrix;
+    if (model.getVertexFormat() != backend::ModelVertexFormat::Compact) {
+      return;
+    }
+    push.flags0.x |= kCompactVertices;
+    const float extent = model.getPositionExtent();
+    push.modelMatrix[0] = modelMatrix[0] * extent;
+    push.modelMatrix[1] = modelMatrix[1] * extent;
+    push.modelMatrix[2] = modelMatrix[2] * extent;
+    push.modelMatrix[3] = modelMatrix * glm::vec4{model.getPositionOrigin(), 1.f};
+  }
+
+  // one material set as laid out for the descriptor updater
+  struct MaterialDescriptorData {
+    VkDescriptorBufferInfo object;
+    VkDescriptorImageInfo baseColor;
+    VkDescriptorImageInfo normal;
+    VkDescriptorImageInfo metallicRoughness;
+    VkDescriptorImageInfo occlusion;
+    VkDescriptorImageInfo emissive;
+  };
+
+  // a LOD is used while its error projects to at most this many pixels; a coarser level in use
+  // is kept until its error exceeds that by kLodHysteresis, so objects near a switch do not pop
+  constexpr float kLodPixelError = 1.f;
+  constexpr float kLodHysteresis = 1.5f;
+
+  static std::uint8_t selectLod(
+    const backend::ModelSubMesh &subMesh,
+    const glm::mat4 &modelMatrix,
+    const FrameInfo &frameInfo,
+    std::uint8_t current) {
+    if (subMesh.lods.empty() || !subMesh.hasBounds) {
+      return 0;
+    }
+    const glm::vec3 center{modelMatrix * glm::vec4((subMesh.boundsMin + subMesh.boundsMax) * 0.5f, 1.f)};
+    const float scale = std::max({
+      glm::length(glm::vec3{modelMatrix[0]}),
+      glm::length(glm::vec3{modelMatrix[1]}),
+      glm::length(glm::vec3{modelMatrix[2]})});
+    const float radius = glm::length(subMesh.boundsMax - subMesh.boundsMin) * 0.5f * scale;
+
+    // clip space spans 2 units per view height
+    const glm::mat4 &projection = frameInfo.camera.getProjection();
+    const float focal = std::abs(projection[1][1]);
+    float radiusPixels = radius * focal * 0.5f * frameInfo.viewHeight;
+    if (projection[3][3] != 1.f) {
+      const float distance = glm::length(glm::vec3{frameInfo.camera.getView() * glm::vec4(center, 1.f)});
+      if (distance <= radius) {
+        return 0;
+      }
+      radiusPixels /= distance;
+    }
+
+    std::uint8_t level = 0;
+    while (level < subMesh.lods.size() && subMesh.lods[level].error * radiusPixels <= kLodPixelError) {
+      ++level;
+    }
+    if (current > level && current <= subMesh.lods.size() &&
+        subMesh.lods[current - 1].error * radiusPixels <= kLodPixelError * kLodHysteresis) {
+      return current;
+    }
+    return level;
+  }
+
+  struct SimpleRenderSystem::DrawItem {
+    LveModel *model{nullptr};
+    const backend::ModelSubMesh *subMesh{nullptr}; // whole model when null
+    std::size_t lod{0};
+    VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+    SimplePushConstantData push{};
+  };
 
   SimpleRenderSystem::SimpleRenderSystem(LveDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
     : lveDevice{device}, renderPass{renderPass} {
     createPipelineLayout(globalSetLayout);
     createPipelines(renderPass);
+
+    zeroTangentBuffer = std::make_unique<LveBuffer>(
+      lveDevice,
+      sizeof(glm::vec4),
+      1,
+      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    glm::vec4 zero{0.f};
+    zeroTangentBuffer->map();
+    zeroTangentBuffer->writeToBuffer(&zero, sizeof(zero));
+    zeroTangentBuffer->unmap();
   }
 
   SimpleRenderSystem::~SimpleRenderSystem() {
@@ -55,6 +150,16 @@ namespace lve {
         .addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
         .build();
 
+    descriptorUpdater =
+      LveDescriptorUpdater::Builder(*renderSystemLayout, sizeof(MaterialDescriptorData))
+        .addEntry(0, offsetof(MaterialDescriptorData, object))
+        .addEntry(1, offsetof(MaterialDescriptorData, baseColor))
+        .addEntry(2, offsetof(MaterialDescriptorData, normal))
+        .addEntry(3, offsetof(MaterialDescriptorData, metallicRoughness))
+        .addEntry(4, offsetof(MaterialDescriptorData, occlusion))
+        .addEntry(5, offsetof(MaterialDescriptorData, emissive))
+        .build();
+
     std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
       globalSetLayout,
       renderSystemLayout->getDescriptorSetLayout()};
@@ -72,28 +177,45 @@ namespace lve {
 
   void SimpleRenderSystem::createPipelines(VkRenderPass renderPass) {
     assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout!");
+    fillPipeline = createPipeline(backend::ModelVertexFormat::Full, LveModel::TangentInput::Constant, false);
+  }
 
-    PipelineConfigInfo fillConfig{};
-    LvePipeline::defaultPipelineConfigInfo(fillConfig);
-    fillConfig.renderPass = renderPass;
-    fillConfig.pipelineLayout = pipelineLayout;
-    fillPipeline = std::make_unique<LvePipeline>(
-      lveDevice,
-      "Shaders/simple_shader.vert.spv",
-      "Shaders/simple_shader.frag.spv",
-      fillConfig);
-
-    PipelineConfigInfo wireConfig{};
-    LvePipeline::defaultPipelineConfigInfo(wireConfig);
-    wireConfig.renderPass = renderPass;
-    wireConfig.pipelineLayout = pipelineLayout;
-    wireConfig.rasterizationInfo.polygonMode = VK_POLYGON_MODE_LINE;
-    wireConfig.rasterizationInfo.lineWidth = 1.0f;
-    wireframePipeline = std::make_unique<LvePipeline>(
+  std::unique_ptr<LvePipeline> SimpleRenderSystem::createPipeline(
+    backend::ModelVertexFormat format,
+    LveModel::TangentInput tangents,
+    bool wireframe) {
+    PipelineConfigInfo config{};
+    LvePipeline::defaultPipelineConfigInfo(config);
+    config.renderPass = renderPass;
+    config.pipelineLayout = pipelineLayout;
+    config.bindingDescriptions = LveModel::getBindingDescriptions(format, tangents);
+    config.attributeDescriptions = LveModel::getAttributeDescriptions(format, tangents);
+    if (wireframe) {
+      config.rasterizationInfo.polygonMode = VK_POLYGON_MODE_LINE;
+      config.rasterizationInfo.lineWidth = 1.0f;
+    }
+    return std::make_unique<LvePipeline>(
       lveDevice,
       "Shaders/simple_shader.vert.spv",
       "Shaders/simple_shader.frag.spv",
-      wireConfig);
+      config);
+  }
+
+  LvePipeline *SimpleRenderSystem::getPipeline(const LveModel &model) {
+    // wireframe is a debug view, compact assets and tangent streams are not everywhere, so those compile on first use
+    const backend::ModelVertexFormat format = model.getVertexFormat();
+    const bool compact = format == backend::ModelVertexFormat::Compact;
+    const bool tangentStream = !compact && model.hasTangentStream();
+    std::unique_ptr<LvePipeline> &pipeline = wireframeEnabled
+      ? (compact ? compactWireframePipeline : tangentStream ? tangentWireframePipeline : wireframePipeline)
+      : (compact ? compactFillPipeline : tangentStream ? tangentFillPipeline : fillPipeline);
+    if (!pipeline) {
+      const LveModel::TangentInput tangents = compact
+        ? LveModel::TangentInput::None
+        : tangentStream ? LveModel::TangentInput::PerVertex : LveModel::TangentInput::Constant;
+      pipeline = createPipeline(format, tangents, wireframeEnabled);
+    }
+    return pipeline.get();
   }
 
   void SimpleRenderSystem::setWireframe(bool enabled) {
@@ -101,10 +223,6 @@ namespace lve {
   }
 
   void SimpleRenderSystem::renderGameObjects(FrameInfo &frameInfo) {
-    LvePipeline* activePipeline =
-      (wireframeEnabled && wireframePipeline) ? wireframePipeline.get() : fillPipeline.get();
-    activePipeline->bind(frameInfo.commandBuffer);
-
     vkCmdBindDescriptorSets(
       frameInfo.commandBuffer,
       VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -115,6 +233,7 @@ namespace lve {
       0,
       nullptr);
 
+    draws.clear();
     for (auto *objPtr : frameInfo.gameObjects) {
       if (!objPtr) continue;
       auto &obj = *objPtr;
@@ -177,12 +296,8 @@ namespace lve {
         emissiveTexture = fallbackTexture;
       }
 
-      model->bind(frameInfo.commandBuffer);
-
       const auto &nodes = obj.model->getNodes();
       if (nodes.empty()) {
-        auto &descriptorHandle = obj.descriptorSets[frameIndex];
-        VkDescriptorSet gameObjectDescriptorSet = reinterpret_cast<VkDescriptorSet>(descriptorHandle);
         const LveTexture *currentTexture = hasOverrideTexture
           ? overrideTexture
           : static_cast<const LveTexture*>(obj.diffuseMap.get());
@@ -203,49 +318,30 @@ namespace lve {
         bindings.metallicRoughness = metallicRoughnessTexture;
         bindings.occlusion = occlusionTexture;
         bindings.emissive = emissiveTexture;
-        auto &textureCache = obj.descriptorTextures[frameIndex];
-        if (gameObjectDescriptorSet == VK_NULL_HANDLE ||
-            textureCache != bindings) {
-          auto baseInfo = baseTexture->getImageInfo();
-          auto normalInfo = normalTexture->getImageInfo();
-          auto metallicInfo = metallicRoughnessTexture->getImageInfo();
-          auto occlusionInfo = occlusionTexture->getImageInfo();
-          auto emissiveInfo = emissiveTexture->getImageInfo();
-          LveDescriptorWriter writer(*renderSystemLayout, frameInfo.frameDescriptorPool);
-          writer.writeBuffer(0, &vkBufferInfo)
-            .writeImage(1, &baseInfo)
-            .writeImage(2, &normalInfo)
-            .writeImage(3, &metallicInfo)
-            .writeImage(4, &occlusionInfo)
-            .writeImage(5, &emissiveInfo);
-          if (gameObjectDescriptorSet == VK_NULL_HANDLE) {
-            if (!writer.build(gameObjectDescriptorSet)) {
-              throw std::runtime_error("failed to build game object descriptor set");
-            }
-          } else {
-            writer.overwrite(gameObjectDescriptorSet);
-          }
-          descriptorHandle = reinterpret_cast<backend::DescriptorSetHandle>(gameObjectDescriptorSet);
-          textureCache = bindings;
-        }
-
-        vkCmdBindDescriptorSets(
-          frameInfo.commandBuffer,
-          VK_PIPELINE_BIND_POINT_GRAPHICS,
-          pipelineLayout,
-          1, // starting set (0 is the globalDescriptorSet, 1 is the set specific to this system)
-          1, // set count
-          &gameObjectDescriptorSet,
-          0,
-          nullptr);
-
-        SimplePushConstantData push{};
-        push.modelMatrix = obj.transform.mat4();
+        bindings.revision = std::max({
+          baseTexture->getRevision(),
+          normalTexture->getRevision(),
+          metallicRoughnessTexture->getRevision(),
+          occlusionTexture->getRevision(),
+          emissiveTexture->getRevision()});
+        bindings.poolGeneration = frameInfo.frameDescriptorPool.generation();
+        const VkDescriptorSet gameObjectDescriptorSet = prepareDescriptorSet(
+          frameInfo,
+          obj.descriptorSets[frameIndex],
+          obj.descriptorTextures[frameIndex],
+          bindings,
+          vkBufferInfo);
+
+        DrawItem &draw = draws.emplace_back();
+        draw.model = model;
+        draw.descriptorSet = gameObjectDescriptorSet;
+        SimplePushConstantData &push = draw.push;
         push.flags0 = glm::ivec4(
           textureMask,
           obj.currentFrame,
           static_cast<int>(obj.objState),
           static_cast<int>(obj.directions));
+        setModelMatrix(push, *model, obj.transform.mat4());
         push.baseColorFactor = factors.baseColor;
         push.emissiveMetallic = glm::vec4(factors.emissive, factors.metallic);
         push.miscFactors = glm::vec4(
@@ -254,15 +350,6 @@ namespace lve {
           factors.normalScale,
           normalViewEnabled ? 1.f : 0.f);
 
-        vkCmdPushConstants(
-          frameInfo.commandBuffer,
-          pipelineLayout,
-          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-          0,
-          sizeof(SimplePushConstantData),
-          &push);
-
-        model->draw(frameInfo.commandBuffer);
         continue;
       }
 
@@ -321,51 +408,36 @@ namespace lve {
           bindings.metallicRoughness = metallicRoughnessTexture;
           bindings.occlusion = occlusionTexture;
           bindings.emissive = emissiveTexture;
+          bindings.revision = std::max({
+            baseTexture->getRevision(),
+            normalTexture->getRevision(),
+            metallicRoughnessTexture->getRevision(),
+            occlusionTexture->getRevision(),
+            emissiveTexture->getRevision()});
+          bindings.poolGeneration = frameInfo.frameDescriptorPool.generation();
           auto &cache = obj.subMeshDescriptors[static_cast<std::size_t>(meshIndex)];
-          auto &descriptorHandle = cache.sets[frameIndex];
-          VkDescriptorSet descriptorSet = reinterpret_cast<VkDescriptorSet>(descriptorHandle);
-          auto &textureCache = cache.textures[frameIndex];
-          if (descriptorSet == VK_NULL_HANDLE || textureCache != bindings) {
-            auto baseInfo = baseTexture->getImageInfo();
-            auto normalInfo = normalTexture->getImageInfo();
-            auto metallicInfo = metallicRoughnessTexture->getImageInfo();
-            auto occlusionInfo = occlusionTexture->getImageInfo();
-            auto emissiveInfo = emissiveTexture->getImageInfo();
-            LveDescriptorWriter writer(*renderSystemLayout, frameInfo.frameDescriptorPool);
-            writer.writeBuffer(0, &vkBufferInfo)
-              .writeImage(1, &baseInfo)
-              .writeImage(2, &normalInfo)
-              .writeImage(3, &metallicInfo)
-              .writeImage(4, &occlusionInfo)
-              .writeImage(5, &emissiveInfo);
-            if (descriptorSet == VK_NULL_HANDLE) {
-              if (!writer.build(descriptorSet)) {
-                throw std::runtime_error("failed to build submesh descriptor set");
-              }
-            } else {
-              writer.overwrite(descriptorSet);
-            }
-            descriptorHandle = reinterpret_cast<backend::DescriptorSetHandle>(descriptorSet);
-            textureCache = bindings;
-          }
-
-          vkCmdBindDescriptorSets(
-            frameInfo.commandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            pipelineLayout,
-            1,
-            1,
-            &descriptorSet,
-            0,
-            nullptr);
-
-          SimplePushConstantData push{};
-          push.modelMatrix = modelMatrix;
+          const VkDescriptorSet descriptorSet = prepareDescriptorSet(
+            frameInfo,
+            cache.sets[frameIndex],
+            cache.textures[frameIndex],
+            bindings,
+            vkBufferInfo);
+
+          std::uint8_t &lodLevel = cache.lodLevels[static_cast<std::size_t>(frameInfo.view)];
+          lodLevel = selectLod(subMesh, modelMatrix, frameInfo, lodLevel);
+
+          DrawItem &draw = draws.emplace_back();
+          draw.model = model;
+          draw.subMesh = &subMesh;
+          draw.lod = lodLevel;
+          draw.descriptorSet = descriptorSet;
+          SimplePushConstantData &push = draw.push;
           push.flags0 = glm::ivec4(
             textureMask,
             obj.currentFrame,
             static_cast<int>(obj.objState),
             static_cast<int>(obj.directions));
+          setModelMatrix(push, *model, modelMatrix);
           push.baseColorFactor = factors.baseColor;
           push.emissiveMetallic = glm::vec4(factors.emissive, factors.metallic);
           push.miscFactors = glm::vec4(
@@ -374,19 +446,92 @@ namespace lve {
             factors.normalScale,
             normalViewEnabled ? 1.f : 0.f);
 
-          vkCmdPushConstants(
-            frameInfo.commandBuffer,
-            pipelineLayout,
-            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-            0,
-            sizeof(SimplePushConstantData),
-            &push);
+        }
+      }
+    }
 
-          model->drawSubMesh(frameInfo.commandBuffer, subMesh);
+    // every set is written before the first one is bound, updating a bound set would invalidate
+    // the command buffer
+    descriptorUpdater->flush();
+
+    LvePipeline *boundPipeline = nullptr;
+    LveModel *boundModel = nullptr;
+    for (const DrawItem &draw : draws) {
+      LvePipeline *pipeline = getPipeline(*draw.model);
+      if (pipeline != boundPipeline) {
+        pipeline->bind(frameInfo.commandBuffer);
+        boundPipeline = pipeline;
+      }
+      if (draw.model != boundModel) {
+        draw.model->bind(frameInfo.commandBuffer);
+        boundModel = draw.model;
+        if (draw.model->getVertexFormat() == backend::ModelVertexFormat::Full && !draw.model->hasTangentStream()) {
+          VkBuffer tangentBuffer = zeroTangentBuffer->getBuffer();
+          VkDeviceSize offset = 0;
+          vkCmdBindVertexBuffers(frameInfo.commandBuffer, 1, 1, &tangentBuffer, &offset);
         }
       }
+
+      vkCmdBindDescriptorSets(
+        frameInfo.commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        1, // starting set (0 is the globalDescriptorSet, 1 is the set specific to this system)
+        1, // set count
+        &draw.descriptorSet,
+        0,
+        nullptr);
+
+      vkCmdPushConstants(
+        frameInfo.commandBuffer,
+        pipelineLayout,
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        0,
+        sizeof(SimplePushConstantData),
+        &draw.push);
+
+      if (draw.subMesh) {
+        draw.model->drawSubMesh(frameInfo.commandBuffer, *draw.subMesh, draw.lod);
+      } else {
+        draw.model->draw(frameInfo.commandBuffer);
+      }
     }
   }
+
+  VkDescriptorSet SimpleRenderSystem::prepareDescriptorSet(
+    FrameInfo &frameInfo,
+    backend::DescriptorSetHandle &descriptorHandle,
+    MaterialTextureBindings &textureCache,
+    const MaterialTextureBindings &bindings,
+    const VkDescriptorBufferInfo &bufferInfo) {
+    VkDescriptorSet descriptorSet = reinterpret_cast<VkDescriptorSet>(descriptorHandle);
+    // the set went away with a recycled pool
+    if (textureCache.poolGeneration != bindings.poolGeneration) {
+      descriptorSet = VK_NULL_HANDLE;
+    }
+    if (descriptorSet != VK_NULL_HANDLE && textureCache == bindings) {
+      return descriptorSet;
+    }
+
+    if (descriptorSet == VK_NULL_HANDLE &&
+        !frameInfo.frameDescriptorPool.allocateDescriptor(
+          renderSystemLayout->getDescriptorSetLayout(), descriptorSet)) {
+      throw std::runtime_error("failed to build game object descriptor set");
+    }
+
+    MaterialDescriptorData data{};
+    data.object = bufferInfo;
+    data.baseColor = static_cast<const LveTexture*>(bindings.baseColor)->getImageInfo();
+    data.normal = static_cast<const LveTexture*>(bindings.normal)->getImageInfo();
+    data.metallicRoughness = static_cast<const LveTexture*>(bindings.metallicRoughness)->getImageInfo();
+    data.occlusion = static_cast<const LveTexture*>(bindings.occlusion)->getImageInfo();
+    data.emissive = static_cast<const LveTexture*>(bindings.emissive)->getImageInfo();
+    descriptorUpdater->queue(descriptorSet, data);
+
+    descriptorHandle = reinterpret_cast<backend::DescriptorSetHandle>(descriptorSet);
+    textureCache = bindings;
+    return descriptorSet;
+  }
 } // namespace lve
 
 
@@ -5,6 +5,7 @@
 #include "Engine/Backend/Vulkan/Core/pipeline.hpp"
 #include "Engine/Backend/Vulkan/Render/frame_info.hpp"
 #include "Engine/Backend/Vulkan/Core/device.hpp"
+#include "Engine/Backend/Vulkan/Render/model.hpp"
 
 // std
 #include <memory>
@@ -29,14 +30,36 @@ namespace lve {
   private:
     void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
     void createPipelines(VkRenderPass renderPass);
+    std::unique_ptr<LvePipeline> createPipeline(
+      backend::ModelVertexFormat format,
+      LveModel::TangentInput tangents,
+      bool wireframe);
+    LvePipeline *getPipeline(const LveModel &model);
+    // returns the cached set for bindings, queueing a rewrite when it is stale
+    VkDescriptorSet prepareDescriptorSet(
+      FrameInfo &frameInfo,
+      backend::DescriptorSetHandle &descriptorHandle,
+      MaterialTextureBindings &textureCache,
+      const MaterialTextureBindings &bindings,
+      const VkDescriptorBufferInfo &bufferInfo);
 
     LveDevice &lveDevice;
     VkRenderPass renderPass;
     std::unique_ptr<LvePipeline> fillPipeline;
     std::unique_ptr<LvePipeline> wireframePipeline;
+    std::unique_ptr<LvePipeline> tangentFillPipeline;
+    std::unique_ptr<LvePipeline> tangentWireframePipeline;
+    std::unique_ptr<LvePipeline> compactFillPipeline;
+    std::unique_ptr<LvePipeline> compactWireframePipeline;
     VkPipelineLayout pipelineLayout;
+    // the tangent of full layout models without a tangent stream, zero selects the shader's fallback
+    std::unique_ptr<LveBuffer> zeroTangentBuffer;
 
     std::unique_ptr<LveDescriptorSetLayout> renderSystemLayout;
+    std::unique_ptr<LveDescriptorUpdater> descriptorUpdater;
+    // recorded after all descriptor updates of the pass, reused across frames
+    struct DrawItem;
+    std::vector<DrawItem> draws;
     bool wireframeEnabled{false};
     bool normalViewEnabled{false};
   };
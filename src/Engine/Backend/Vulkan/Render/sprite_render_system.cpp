@@ -11,6 +11,7 @@
 // std
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <stdexcept>
 
 namespace lve {
@@ -27,6 +28,17 @@ namespace lve {
     int rowIndex;
   };
 
+  struct SpriteDescriptorData {
+    VkDescriptorBufferInfo object;
+    VkDescriptorImageInfo sprite;
+  };
+
+  struct SpriteRenderSystem::DrawItem {
+    LveModel *model{nullptr};
+    VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+    SpritePushConstantData push{};
+  };
+
   SpriteRenderSystem::SpriteRenderSystem(LveDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout)
     : lveDevice{device}, renderPass{renderPass} {
     createPipelineLayout(globalSetLayout);
@@ -55,6 +67,12 @@ namespace lve {
         .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
         .build();
 
+    descriptorUpdater =
+      LveDescriptorUpdater::Builder(*renderSystemLayout, sizeof(SpriteDescriptorData))
+        .addEntry(0, offsetof(SpriteDescriptorData, object))
+        .addEntry(1, offsetof(SpriteDescriptorData, sprite))
+        .build();
+
     std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
       globalSetLayout,
       renderSystemLayout->getDescriptorSetLayout()};
@@ -112,13 +130,15 @@ namespace lve {
       0,
       nullptr);
 
+    draws.clear();
     for (auto *objPtr : frameInfo.gameObjects) {
       if (!objPtr) continue;
       auto &obj = *objPtr;
       if (!obj.isSprite) continue;
       if (obj.model == nullptr) continue;
       auto *model = static_cast<LveModel*>(obj.model.get());
-      if (!model) continue;
+      // the sprite pipeline only has the full vertex layout
+      if (!model || model->getVertexFormat() != backend::ModelVertexFormat::Full) continue;
 
       const int frameIndex = frameInfo.frameIndex;
       auto &descriptorHandle = obj.descriptorSets[frameIndex];
@@ -128,37 +148,33 @@ namespace lve {
         continue;
       }
       auto &textureCache = obj.descriptorTextures[frameIndex];
-      if (descriptorSet == VK_NULL_HANDLE || textureCache.baseColor != currentTexture) {
+      const uint64_t poolGeneration = frameInfo.frameDescriptorPool.generation();
+      if (textureCache.poolGeneration != poolGeneration) {
+        descriptorSet = VK_NULL_HANDLE;
+      }
+      if (descriptorSet == VK_NULL_HANDLE ||
+          textureCache.baseColor != currentTexture ||
+          textureCache.revision != currentTexture->getRevision()) {
         auto bufferInfo = obj.getBufferInfo(frameIndex);
         VkDescriptorBufferInfo vkBufferInfo{};
         vkBufferInfo.buffer = reinterpret_cast<VkBuffer>(bufferInfo.buffer);
         vkBufferInfo.offset = bufferInfo.offset;
         vkBufferInfo.range = bufferInfo.range;
-        auto imageInfo = currentTexture->getImageInfo();
-        LveDescriptorWriter writer(*renderSystemLayout, frameInfo.frameDescriptorPool);
-        writer.writeBuffer(0, &vkBufferInfo)
-          .writeImage(1, &imageInfo);
-        if (descriptorSet == VK_NULL_HANDLE) {
-          if (!writer.build(descriptorSet)) {
-            throw std::runtime_error("failed to build sprite descriptor set");
-          }
-        } else {
-          writer.overwrite(descriptorSet);
+        if (descriptorSet == VK_NULL_HANDLE &&
+            !frameInfo.frameDescriptorPool.allocateDescriptor(
+              renderSystemLayout->getDescriptorSetLayout(), descriptorSet)) {
+          throw std::runtime_error("failed to build sprite descriptor set");
         }
+        SpriteDescriptorData data{};
+        data.object = vkBufferInfo;
+        data.sprite = currentTexture->getImageInfo();
+        descriptorUpdater->queue(descriptorSet, data);
         descriptorHandle = reinterpret_cast<backend::DescriptorSetHandle>(descriptorSet);
         textureCache.baseColor = currentTexture;
+        textureCache.revision = currentTexture->getRevision();
+        textureCache.poolGeneration = poolGeneration;
       }
 
-      vkCmdBindDescriptorSets(
-        frameInfo.commandBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        pipelineLayout,
-        1,
-        1,
-        &descriptorSet,
-        0,
-        nullptr);
-
       glm::mat4 modelMat = obj.transform.mat4();
       if (obj.billboardMode != BillboardMode::None) {
         // build billboard rotation using camera inverse view (world basis)
@@ -188,7 +204,10 @@ namespace lve {
         modelMat = translate * rotation * scale;
       }
 
-      SpritePushConstantData push{};
+      DrawItem &draw = draws.emplace_back();
+      draw.model = model;
+      draw.descriptorSet = descriptorSet;
+      SpritePushConstantData &push = draw.push;
       push.modelMatrix = modelMat;
       push.useTexture = obj.enableTextureType;
       push.currentFrame = obj.currentFrame;
@@ -198,6 +217,21 @@ namespace lve {
       push.atlasCols = obj.atlasColumns;
       push.atlasRows = obj.atlasRows;
       push.rowIndex = obj.hasSpriteState ? obj.spriteState.row : 0;
+    }
+
+    // all sets are written before the first bind, see SimpleRenderSystem::renderGameObjects
+    descriptorUpdater->flush();
+
+    for (const DrawItem &draw : draws) {
+      vkCmdBindDescriptorSets(
+        frameInfo.commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipelineLayout,
+        1,
+        1,
+        &draw.descriptorSet,
+        0,
+        nullptr);
 
       vkCmdPushConstants(
         frameInfo.commandBuffer,
@@ -205,10 +239,10 @@ namespace lve {
         VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
         0,
         sizeof(SpritePushConstantData),
-        &push);
+        &draw.push);
 
-      model->bind(frameInfo.commandBuffer);
-      model->draw(frameInfo.commandBuffer);
+      draw.model->bind(frameInfo.commandBuffer);
+      draw.model->draw(frameInfo.commandBuffer);
     }
   }
 } // namespace lve
@@ -32,6 +32,9 @@ namespace lve {
     VkPipelineLayout pipelineLayout{VK_NULL_HANDLE};
 
     std::unique_ptr<LveDescriptorSetLayout> renderSystemLayout;
+    std::unique_ptr<LveDescriptorUpdater> descriptorUpdater;
+    struct DrawItem;
+    std::vector<DrawItem> draws;
     BillboardMode billboardMode{BillboardMode::None};
   };
 } // namespace lve
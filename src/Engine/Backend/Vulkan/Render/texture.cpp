@@ -1,14 +1,113 @@
 #include "texture.hpp"
 
+#include "Engine/Backend/Vulkan/Core/sampler_cache.hpp"
+#include "Engine/IO/image_io.hpp"
+#include "Engine/IO/ktx_io.hpp"
+#include "Engine/IO/texture_compression.hpp"
+
 // std
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace lve {
-LveTexture::LveTexture(LveDevice &device, const unsigned char *rgbaPixels, int width, int height)
+namespace {
+VkFormat toVkFormat(BlockFormat format, bool sRGB) {
+  return static_cast<VkFormat>(blockFormatToVkFormat(format, sRGB));
+}
+
+VkFormat pixelFormat(int channels, bool sRGB) {
+  switch (channels) {
+    case 1:
+      return VK_FORMAT_R8_UNORM;
+    case 2:
+      return VK_FORMAT_R8G8_UNORM;
+    case 4:
+      return sRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    default:
+      return VK_FORMAT_UNDEFINED;
+  }
+}
+
+std::uint64_t nextRevision() {
+  static std::atomic<std::uint64_t> counter{0};
+  return ++counter;
+}
+
+// RGBA8 in, downscaled to the size budget and reduced to the channels the usage samples
+bool prepareImage(ImageData &image, const backend::TextureLoadOptions &options, std::string *outError) {
+  const bool sRGB = options.sRGB && options.usage == TextureUsage::Color;
+  if (!downscaleToFit(image, options.maxSize, sRGB, outError)) {
+    return false;
+  }
+  if (options.usage == TextureUsage::Color) {
+    return true;
+  }
+  ImageData packed{};
+  if (!packImageForUsage(image, options.usage, packed, outError)) {
+    return false;
+  }
+  image = std::move(packed);
+  return true;
+}
+}  // namespace
+
+LveTexture::LveTexture(
+    LveDevice &device, const CompressedImageData &image, const backend::TextureLoadOptions &options)
+    : mDevice{device} {
+  createTextureImageFromBlocks(image);
+  createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
+  createTextureSampler(options);
+  updateDescriptor();
+}
+
+LveTexture::LveTexture(
+    LveDevice &device,
+    const TextureMipChain &chain,
+    uint32_t firstLevel,
+    const backend::TextureLoadOptions &options)
+    : mDevice{device} {
+  createTextureImageFromChain(chain, firstLevel);
+  createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
+  createTextureSampler(options);
+  updateDescriptor();
+}
+
+LveTexture::LveTexture(
+    LveDevice &device, const ImageData &image, const backend::TextureLoadOptions &options)
+    : mDevice{device} {
+  createTextureImageFromPixels(
+      image.pixels.data(), image.width, image.height, image.channels, options);
+  createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
+  createTextureSampler(options);
+  updateDescriptor();
+}
+
+LveTexture::LveTexture(
+    LveDevice &device,
+    const unsigned char *rgbaPixels,
+    int width,
+    int height,
+    const backend::TextureLoadOptions &options)
     : mDevice{device} {
-  createTextureImageFromPixels(rgbaPixels, width, height);
+  const bool fitsBudget = options.maxSize <= 0 || std::max(width, height) <= options.maxSize;
+  if (options.usage == TextureUsage::Color && fitsBudget) {
+    createTextureImageFromPixels(rgbaPixels, width, height, 4, options);
+  } else {
+    ImageData image{};
+    std::string error;
+    if (!loadImageDataFromRgba(rgbaPixels, width, height, image, &error) ||
+        !prepareImage(image, options, &error)) {
+      throw std::runtime_error("invalid texture pixel data: " + error);
+    }
+    createTextureImageFromPixels(
+        image.pixels.data(), image.width, image.height, image.channels, options);
+  }
   createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
-  createTextureSampler();
+  createTextureSampler(options);
   updateDescriptor();
 }
 
@@ -83,10 +182,7 @@ LveTexture::LveTexture(
     samplerInfo.minLod = 0.0f;
     samplerInfo.maxLod = 1.0f;
     samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
-
-    if (vkCreateSampler(device.device(), &samplerInfo, nullptr, &mTextureSampler) != VK_SUCCESS) {
-      throw std::runtime_error("failed to create sampler!");
-    }
+    mTextureSampler = device.samplers().getSampler(samplerInfo);
 
     VkImageLayout samplerImageLayout = imageLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
                                            ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
@@ -98,15 +194,113 @@ LveTexture::LveTexture(
 }
 
 LveTexture::~LveTexture() {
-  vkDestroySampler(mDevice.device(), mTextureSampler, nullptr);
+  mDevice.uploads().wait(mUploadTicket);
   vkDestroyImageView(mDevice.device(), mTextureImageView, nullptr);
-  vkDestroyImage(mDevice.device(), mTextureImage, nullptr);
-  vkFreeMemory(mDevice.device(), mTextureImageMemory, nullptr);
+  mDevice.destroyImage(mTextureImage, mTextureImageMemory);
 }
 
 std::unique_ptr<LveTexture> LveTexture::createTextureFromRgba(
-    LveDevice &device, const unsigned char *rgbaPixels, int width, int height) {
-  return std::make_unique<LveTexture>(device, rgbaPixels, width, height);
+    LveDevice &device,
+    const unsigned char *rgbaPixels,
+    int width,
+    int height,
+    const backend::TextureLoadOptions &options) {
+  return std::make_unique<LveTexture>(device, rgbaPixels, width, height, options);
+}
+
+std::unique_ptr<LveTexture> LveTexture::createTextureFromFile(
+    LveDevice &device,
+    const std::string &path,
+    const backend::TextureLoadOptions &options,
+    std::string *outError) {
+  if (!options.compressedPath.empty() && device.hasBlockCompression()) {
+    CompressedImageData compressed{};
+    if (loadKtxFile(options.compressedPath, compressed, nullptr, outError) &&
+        device.formatSupportsFeatures(
+            toVkFormat(compressed.format, compressed.sRGB),
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+      return std::make_unique<LveTexture>(device, compressed, options);
+    }
+  }
+
+  // uncompressed fallback
+  ImageData image{};
+  if (!loadImageDataFromFile(path, image, outError) || !prepareImage(image, options, outError)) {
+    return nullptr;
+  }
+  return std::make_unique<LveTexture>(device, image, options);
+}
+
+bool LveTexture::loadMipChain(
+    LveDevice &device,
+    const std::string &path,
+    const backend::TextureLoadOptions &options,
+    TextureMipChain &outChain,
+    std::string *outError) {
+  if (!options.compressedPath.empty() && device.hasBlockCompression()) {
+    CompressedImageData compressed{};
+    if (loadKtxFile(options.compressedPath, compressed, nullptr, outError)) {
+      const VkFormat format = toVkFormat(compressed.format, compressed.sRGB);
+      if (device.formatSupportsFeatures(
+              format,
+              VK_IMAGE_TILING_OPTIMAL,
+              VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                  VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+        outChain.format = format;
+        outChain.width = static_cast<uint32_t>(compressed.width);
+        outChain.height = static_cast<uint32_t>(compressed.height);
+        outChain.levels = std::move(compressed.levels);
+        return true;
+      }
+    }
+  }
+
+  ImageData image{};
+  if (!loadImageDataFromFile(path, image, outError) || !prepareImage(image, options, outError)) {
+    return false;
+  }
+  const bool sRGB = options.sRGB && options.usage == TextureUsage::Color;
+  std::vector<ImageData> mips;
+  if (options.generateMipmaps && !generateMipChain(image, sRGB, mips, outError)) {
+    return false;
+  }
+
+  outChain.format = pixelFormat(image.channels, sRGB);
+  outChain.width = static_cast<uint32_t>(image.width);
+  outChain.height = static_cast<uint32_t>(image.height);
+  outChain.levels.clear();
+  outChain.levels.reserve(mips.size() + 1);
+  outChain.levels.push_back(std::move(image.pixels));
+  for (auto &mip : mips) {
+    outChain.levels.push_back(std::move(mip.pixels));
+  }
+  return true;
+}
+
+void LveTexture::setResidentLevels(
+    const TextureMipChain &chain,
+    uint32_t firstLevel,
+    const std::function<void(std::function<void()>)> &retire) {
+  VkImage oldImage = mTextureImage;
+  LveAllocation oldMemory = mTextureImageMemory;
+  VkImageView oldView = mTextureImageView;
+  const UploadTicket oldTicket = mUploadTicket;
+
+  mTextureImage = nullptr;
+  mTextureImageMemory = {};
+  mTextureImageView = nullptr;
+  createTextureImageFromChain(chain, firstLevel);
+  createTextureImageView(VK_IMAGE_VIEW_TYPE_2D);
+  updateDescriptor();
+  mRevision = nextRevision();
+
+  LveDevice &device = mDevice;
+  retire([&device, oldImage, oldMemory, oldView, oldTicket]() mutable {
+    device.uploads().wait(oldTicket);
+    vkDestroyImageView(device.device(), oldView, nullptr);
+    device.destroyImage(oldImage, oldMemory);
+  });
 }
 
 void LveTexture::updateDescriptor() {
@@ -115,31 +309,100 @@ void LveTexture::updateDescriptor() {
   mDescriptor.imageLayout = mTextureLayout;
 }
 
-void LveTexture::createTextureImageFromPixels(const unsigned char *pixels, int texWidth, int texHeight) {
+void LveTexture::createTextureImageFromPixels(
+    const unsigned char *pixels,
+    int texWidth,
+    int texHeight,
+    int channels,
+    const backend::TextureLoadOptions &options) {
   if (!pixels || texWidth <= 0 || texHeight <= 0) {
     throw std::runtime_error("invalid texture pixel data!");
   }
 
-  VkDeviceSize imageSize = static_cast<VkDeviceSize>(texWidth) * texHeight * 4;
-  mMipLevels = 1;
+  VkDeviceSize imageSize = static_cast<VkDeviceSize>(texWidth) * texHeight * channels;
+  mMipLevels = options.generateMipmaps
+                   ? static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1
+                   : 1;
+
+  // data maps are linear, only color textures honour the sRGB flag
+  const bool sRGB = options.sRGB && options.usage == TextureUsage::Color;
+  mFormat = pixelFormat(channels, sRGB);
+  if (mFormat == VK_FORMAT_UNDEFINED) {
+    throw std::runtime_error("unsupported texture channel count!");
+  }
+  mExtent = {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1};
+
+  VkImageCreateInfo imageInfo{};
+  imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  imageInfo.imageType = VK_IMAGE_TYPE_2D;
+  imageInfo.extent = mExtent;
+  imageInfo.mipLevels = mMipLevels;
+  imageInfo.arrayLayers = mLayerCount;
+  imageInfo.format = mFormat;
+  imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                    VK_IMAGE_USAGE_SAMPLED_BIT;
+  imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+  imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  mDevice.createImageWithInfo(
+      imageInfo,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+      mTextureImage,
+      mTextureImageMemory);
+
+  VkImageSubresourceRange range{};
+  range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  range.baseMipLevel = 0;
+  range.levelCount = mMipLevels;
+  range.baseArrayLayer = 0;
+  range.layerCount = mLayerCount;
+
+  // recorded into the shared upload batch, the renderer submits it before the next frame
+  mTextureLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  if (mMipLevels > 1) {
+    const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+                                              VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                              VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if (mDevice.formatSupportsFeatures(mFormat, VK_IMAGE_TILING_OPTIMAL, blitFeatures)) {
+      mUploadTicket = mDevice.uploads().uploadImageAndGenerateMips(
+          mTextureImage,
+          {mExtent.width, mExtent.height},
+          range,
+          pixels,
+          imageSize);
+    } else {
+      uploadMipChainFromCpu(pixels, channels, range, sRGB);
+    }
+    return;
+  }
 
-  VkBuffer stagingBuffer;
-  VkDeviceMemory stagingBufferMemory;
+  VkBufferImageCopy region{};
+  region.bufferOffset = 0;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = mLayerCount;
+  region.imageExtent = mExtent;
 
-  mDevice.createBuffer(
+  mUploadTicket = mDevice.uploads().uploadImage(
+      mTextureImage,
+      range,
+      pixels,
       imageSize,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-      stagingBuffer,
-      stagingBufferMemory);
+      {region},
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
 
-  void *data;
-  vkMapMemory(mDevice.device(), stagingBufferMemory, 0, imageSize, 0, &data);
-  memcpy(data, pixels, static_cast<size_t>(imageSize));
-  vkUnmapMemory(mDevice.device(), stagingBufferMemory);
+void LveTexture::createTextureImageFromBlocks(const CompressedImageData &image) {
+  if (image.width <= 0 || image.height <= 0 || image.levels.empty()) {
+    throw std::runtime_error("invalid compressed texture data!");
+  }
 
-  mFormat = VK_FORMAT_R8G8B8A8_SRGB;
-  mExtent = {static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1};
+  mFormat = toVkFormat(image.format, image.sRGB);
+  mExtent = {static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height), 1};
+  mMipLevels = static_cast<uint32_t>(image.levels.size());
 
   VkImageCreateInfo imageInfo{};
   imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -150,8 +413,7 @@ void LveTexture::createTextureImageFromPixels(const unsigned char *pixels, int t
   imageInfo.format = mFormat;
   imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
   imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                    VK_IMAGE_USAGE_SAMPLED_BIT;
+  imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
   imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
   imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -160,35 +422,153 @@ void LveTexture::createTextureImageFromPixels(const unsigned char *pixels, int t
       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
       mTextureImage,
       mTextureImageMemory);
-  mDevice.transitionImageLayout(
+
+  VkImageSubresourceRange range{};
+  range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  range.baseMipLevel = 0;
+  range.levelCount = mMipLevels;
+  range.baseArrayLayer = 0;
+  range.layerCount = mLayerCount;
+
+  // level sizes are whole blocks, so every offset stays block aligned
+  std::vector<unsigned char> packed;
+  std::vector<VkBufferImageCopy> regions;
+  regions.reserve(mMipLevels);
+  for (uint32_t level = 0; level < mMipLevels; ++level) {
+    VkBufferImageCopy region{};
+    region.bufferOffset = packed.size();
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = mLayerCount;
+    region.imageExtent = {
+        std::max(1u, mExtent.width >> level), std::max(1u, mExtent.height >> level), 1};
+    regions.push_back(region);
+    packed.insert(packed.end(), image.levels[level].begin(), image.levels[level].end());
+  }
+
+  mUploadTicket = mDevice.uploads().uploadImage(
       mTextureImage,
-      VK_FORMAT_R8G8B8A8_SRGB,
-      VK_IMAGE_LAYOUT_UNDEFINED,
-      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      mMipLevels,
-      mLayerCount);
-  mDevice.copyBufferToImage(
-      stagingBuffer,
+      range,
+      packed.data(),
+      packed.size(),
+      regions,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  mTextureLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+void LveTexture::createTextureImageFromChain(const TextureMipChain &chain, uint32_t firstLevel) {
+  if (chain.width == 0 || chain.height == 0 || firstLevel >= chain.levels.size()) {
+    throw std::runtime_error("invalid texture mip chain!");
+  }
+
+  mFormat = chain.format;
+  mFirstLevel = firstLevel;
+  mExtent = {std::max(1u, chain.width >> firstLevel), std::max(1u, chain.height >> firstLevel), 1};
+  mMipLevels = static_cast<uint32_t>(chain.levels.size()) - firstLevel;
+
+  VkImageCreateInfo imageInfo{};
+  imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+  imageInfo.imageType = VK_IMAGE_TYPE_2D;
+  imageInfo.extent = mExtent;
+  imageInfo.mipLevels = mMipLevels;
+  imageInfo.arrayLayers = mLayerCount;
+  imageInfo.format = mFormat;
+  imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+  imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+  imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+  imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  mDevice.createImageWithInfo(
+      imageInfo,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
       mTextureImage,
-      static_cast<uint32_t>(texWidth),
-      static_cast<uint32_t>(texHeight),
-      mLayerCount);
+      mTextureImageMemory);
 
-  // comment this out if using mips
-  mDevice.transitionImageLayout(
+  VkImageSubresourceRange range{};
+  range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  range.baseMipLevel = 0;
+  range.levelCount = mMipLevels;
+  range.baseArrayLayer = 0;
+  range.layerCount = mLayerCount;
+
+  // 16 byte offsets satisfy both texel and block alignment
+  std::vector<unsigned char> packed;
+  std::vector<VkBufferImageCopy> regions;
+  regions.reserve(mMipLevels);
+  for (uint32_t level = 0; level < mMipLevels; ++level) {
+    const auto &data = chain.levels[firstLevel + level];
+    if (data.empty()) {
+      throw std::runtime_error("texture mip level is not loaded!");
+    }
+    packed.resize((packed.size() + 15) & ~static_cast<std::size_t>(15), 0);
+    VkBufferImageCopy region{};
+    region.bufferOffset = packed.size();
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = mLayerCount;
+    region.imageExtent = {
+        std::max(1u, mExtent.width >> level), std::max(1u, mExtent.height >> level), 1};
+    regions.push_back(region);
+    packed.insert(packed.end(), data.begin(), data.end());
+  }
+
+  mUploadTicket = mDevice.uploads().uploadImage(
       mTextureImage,
-      VK_FORMAT_R8G8B8A8_SRGB,
-      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-      mMipLevels,
-      mLayerCount);
-
-  // If we generate mip maps then the final image will alerady be READ_ONLY_OPTIMAL
-  // mDevice.generateMipmaps(mTextureImage, mFormat, texWidth, texHeight, mMipLevels);
+      range,
+      packed.data(),
+      packed.size(),
+      regions,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   mTextureLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
 
-  vkDestroyBuffer(mDevice.device(), stagingBuffer, nullptr);
-  vkFreeMemory(mDevice.device(), stagingBufferMemory, nullptr);
+void LveTexture::uploadMipChainFromCpu(
+    const unsigned char *pixels, int channels, const VkImageSubresourceRange &range, bool sRGB) {
+  ImageData base{};
+  base.width = static_cast<int>(mExtent.width);
+  base.height = static_cast<int>(mExtent.height);
+  base.channels = channels;
+  base.pixels.assign(
+      pixels, pixels + static_cast<std::size_t>(base.width) * base.height * channels);
+  std::vector<ImageData> levels;
+  std::string error;
+  if (!generateMipChain(base, sRGB, levels, &error)) {
+    throw std::runtime_error("failed to generate texture mip chain: " + error);
+  }
+
+  // level 0 followed by every generated level, one copy region each
+  std::vector<unsigned char> packed = std::move(base.pixels);
+  std::vector<VkBufferImageCopy> regions;
+  regions.reserve(mMipLevels);
+
+  VkBufferImageCopy region{};
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = mLayerCount;
+  region.imageExtent = mExtent;
+  regions.push_back(region);
+
+  for (std::size_t i = 0; i < levels.size() && i + 1 < mMipLevels; ++i) {
+    // buffer offsets must stay 4 byte aligned for 1 and 2 channel formats
+    packed.resize((packed.size() + 3) & ~static_cast<std::size_t>(3), 0);
+    region.bufferOffset = packed.size();
+    region.imageSubresource.mipLevel = static_cast<uint32_t>(i + 1);
+    region.imageExtent = {
+        static_cast<uint32_t>(levels[i].width), static_cast<uint32_t>(levels[i].height), 1};
+    regions.push_back(region);
+    packed.insert(packed.end(), levels[i].pixels.begin(), levels[i].pixels.end());
+  }
+
+  mUploadTicket = mDevice.uploads().uploadImage(
+      mTextureImage,
+      range,
+      packed.data(),
+      packed.size(),
+      regions,
+      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
 void LveTexture::createTextureImageView(VkImageViewType viewType) {
@@ -196,7 +576,7 @@ void LveTexture::createTextureImageView(VkImageViewType viewType) {
   viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
   viewInfo.image = mTextureImage;
   viewInfo.viewType = viewType;
-  viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+  viewInfo.format = mFormat;
   viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
   viewInfo.subresourceRange.baseMipLevel = 0;
   viewInfo.subresourceRange.levelCount = mMipLevels;
@@ -208,18 +588,26 @@ void LveTexture::createTextureImageView(VkImageViewType viewType) {
   }
 }
 
-void LveTexture::createTextureSampler() {
+void LveTexture::createTextureSampler(const backend::TextureLoadOptions &options) {
+  const bool linear = options.filter == TextureFilter::Linear;
+  VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  if (options.wrap == TextureWrap::ClampToEdge) {
+    addressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  } else if (options.wrap == TextureWrap::MirroredRepeat) {
+    addressMode = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+  }
+
   VkSamplerCreateInfo samplerInfo{};
   samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-  samplerInfo.magFilter = VK_FILTER_NEAREST;
-  samplerInfo.minFilter = VK_FILTER_NEAREST;
+  samplerInfo.magFilter = linear ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+  samplerInfo.minFilter = linear ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
 
-  samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-  samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-  samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+  samplerInfo.addressModeU = addressMode;
+  samplerInfo.addressModeV = addressMode;
+  samplerInfo.addressModeW = addressMode;
 
-  samplerInfo.anisotropyEnable = VK_TRUE;
-  samplerInfo.maxAnisotropy = 16.0f;
+  samplerInfo.anisotropyEnable = linear ? VK_TRUE : VK_FALSE;
+  samplerInfo.maxAnisotropy = linear ? std::min(16.0f, mDevice.properties.limits.maxSamplerAnisotropy) : 1.0f;
   samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
   samplerInfo.unnormalizedCoordinates = VK_FALSE;
 
@@ -227,14 +615,14 @@ void LveTexture::createTextureSampler() {
   samplerInfo.compareEnable = VK_FALSE;
   samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
 
-  samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+  samplerInfo.mipmapMode = linear ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
   samplerInfo.mipLodBias = 0.0f;
   samplerInfo.minLod = 0.0f;
-  samplerInfo.maxLod = static_cast<float>(mMipLevels);
+  // unclamped so one sampler fits every chain length, including streamed textures whose level
+  // count changes
+  samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
-  if (vkCreateSampler(mDevice.device(), &samplerInfo, nullptr, &mTextureSampler) != VK_SUCCESS) {
-    throw std::runtime_error("failed to create texture sampler!");
-  }
+  mTextureSampler = mDevice.samplers().getSampler(samplerInfo);
 }
 
 void LveTexture::transitionLayout(
@@ -2,17 +2,49 @@
 
 #include "Engine/Backend/render_assets.hpp"
 #include "Engine/Backend/Vulkan/Core/device.hpp"
+#include "Engine/Backend/Vulkan/Core/upload_manager.hpp"
+#include "Engine/IO/image_data.hpp"
 
 // libs
 #include <vulkan/vulkan.h>
 
 // std
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace lve {
+// every level of a texture as tightly packed texels or blocks, levels[0] is full resolution.
+// An empty level is not held on the CPU.
+struct TextureMipChain {
+  VkFormat format{VK_FORMAT_UNDEFINED};
+  uint32_t width{0};
+  uint32_t height{0};
+  std::vector<std::vector<unsigned char>> levels{};
+};
+
 class LveTexture : public backend::RenderTexture {
  public:
-  LveTexture(LveDevice &device, const unsigned char *rgbaPixels, int width, int height);
+  LveTexture(
+      LveDevice &device,
+      const unsigned char *rgbaPixels,
+      int width,
+      int height,
+      const backend::TextureLoadOptions &options = {});
+  // image is uploaded as is: 1, 2 or 4 channels, already packed for options.usage
+  LveTexture(LveDevice &device, const ImageData &image, const backend::TextureLoadOptions &options);
+  LveTexture(
+      LveDevice &device,
+      const CompressedImageData &image,
+      const backend::TextureLoadOptions &options = {});
+  // only levels [firstLevel, chain.levels.size()) are created, see setResidentLevels
+  LveTexture(
+      LveDevice &device,
+      const TextureMipChain &chain,
+      uint32_t firstLevel,
+      const backend::TextureLoadOptions &options = {});
   LveTexture(
       LveDevice &device,
       VkFormat format,
@@ -33,24 +65,64 @@ class LveTexture : public backend::RenderTexture {
   VkImageLayout getImageLayout() const { return mTextureLayout; }
   VkExtent3D getExtent() const { return mExtent; }
   VkFormat getFormat() const { return mFormat; }
+  std::uint64_t getRevision() const override { return mRevision; }
+  // index of the resident top level within the full chain, 0 unless streamed
+  uint32_t getFirstResidentLevel() const { return mFirstLevel; }
 
   void updateDescriptor();
+  // rebuilds the image with levels [firstLevel, end) of chain. The replaced image, view and memory
+  // go to retire, which must keep them alive until frames that sampled them have finished.
+  void setResidentLevels(
+      const TextureMipChain &chain,
+      uint32_t firstLevel,
+      const std::function<void(std::function<void()>)> &retire);
   void transitionLayout(
       VkCommandBuffer commandBuffer, VkImageLayout oldLayout, VkImageLayout newLayout);
 
   static std::unique_ptr<LveTexture> createTextureFromRgba(
-      LveDevice &device, const unsigned char *rgbaPixels, int width, int height);
+      LveDevice &device,
+      const unsigned char *rgbaPixels,
+      int width,
+      int height,
+      const backend::TextureLoadOptions &options = {});
+  // uploads options.compressedPath when the device can sample it, otherwise decodes path
+  static std::unique_ptr<LveTexture> createTextureFromFile(
+      LveDevice &device,
+      const std::string &path,
+      const backend::TextureLoadOptions &options = {},
+      std::string *outError = nullptr);
+  // decodes path (or options.compressedPath) into a full mip chain without touching the GPU,
+  // safe to call from worker threads
+  static bool loadMipChain(
+      LveDevice &device,
+      const std::string &path,
+      const backend::TextureLoadOptions &options,
+      TextureMipChain &outChain,
+      std::string *outError = nullptr);
 
  private:
-  void createTextureImageFromPixels(const unsigned char *pixels, int texWidth, int texHeight);
+  void createTextureImageFromPixels(
+      const unsigned char *pixels,
+      int texWidth,
+      int texHeight,
+      int channels,
+      const backend::TextureLoadOptions &options);
+  void createTextureImageFromBlocks(const CompressedImageData &image);
+  void createTextureImageFromChain(const TextureMipChain &chain, uint32_t firstLevel);
+  void uploadMipChainFromCpu(
+      const unsigned char *pixels,
+      int channels,
+      const VkImageSubresourceRange &range,
+      bool sRGB);
   void createTextureImageView(VkImageViewType viewType);
-  void createTextureSampler();
+  // filter and wrap come from options, the sampler itself is shared through the device cache
+  void createTextureSampler(const backend::TextureLoadOptions &options);
 
   VkDescriptorImageInfo mDescriptor{};
 
   LveDevice &mDevice;
   VkImage mTextureImage = nullptr;
-  VkDeviceMemory mTextureImageMemory = nullptr;
+  LveAllocation mTextureImageMemory{};
   VkImageView mTextureImageView = nullptr;
   VkSampler mTextureSampler = nullptr;
   VkFormat mFormat;
@@ -58,6 +130,9 @@ class LveTexture : public backend::RenderTexture {
   uint32_t mMipLevels{1};
   uint32_t mLayerCount{1};
   VkExtent3D mExtent{};
+  UploadTicket mUploadTicket{0};
+  uint32_t mFirstLevel{0};
+  std::uint64_t mRevision{0};
 };
 
 }  // namespace lve
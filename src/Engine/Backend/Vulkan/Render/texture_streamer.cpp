@@ -0,0 +1,279 @@
+#include "Engine/Backend/Vulkan/Render/texture_streamer.hpp"
+
+#include "Engine/Backend/Vulkan/Render/renderer.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+namespace lve {
+
+  namespace {
+    bool isReady(const std::future<std::shared_ptr<TextureMipChain>> &load) {
+      return load.valid() && load.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+  } // namespace
+
+  LveTextureStreamer::LveTextureStreamer(LveDevice &device, const backend::TextureStreamingConfig &config)
+    : device{device}, config{config} {}
+
+  std::shared_ptr<LveTexture> LveTextureStreamer::loadTexture(
+    const std::string &path,
+    const backend::TextureLoadOptions &options,
+    std::string *outError) {
+    if (!config.enabled || !options.generateMipmaps) {
+      return std::shared_ptr<LveTexture>(LveTexture::createTextureFromFile(device, path, options, outError));
+    }
+
+    TextureMipChain chain{};
+    if (!LveTexture::loadMipChain(device, path, options, chain, outError)) {
+      return {};
+    }
+    return createTexture(path, options, std::move(chain));
+  }
+
+  std::shared_ptr<LveTexture> LveTextureStreamer::createTexture(
+    const std::string &path,
+    const backend::TextureLoadOptions &options,
+    TextureMipChain chain) {
+    if (!config.enabled || !options.generateMipmaps) {
+      return std::make_shared<LveTexture>(device, chain, 0, options);
+    }
+
+    const uint32_t levelCount = static_cast<uint32_t>(chain.levels.size());
+    uint32_t tailLevel = 0;
+    while (tailLevel + 1 < levelCount &&
+           std::max(chain.width >> tailLevel, chain.height >> tailLevel) > config.residentTailSize) {
+      ++tailLevel;
+    }
+    if (tailLevel == 0) {
+      return std::make_shared<LveTexture>(device, chain, 0, options);
+    }
+
+    auto texture = std::make_shared<LveTexture>(device, chain, tailLevel, options);
+
+    Entry entry{};
+    entry.texture = texture;
+    entry.path = path;
+    entry.options = options;
+    entry.tailLevel = tailLevel;
+    entry.residentLevel = tailLevel;
+    entry.requestedLevel = tailLevel;
+    entry.levelBytes.reserve(levelCount);
+    for (auto &level : chain.levels) {
+      entry.levelBytes.push_back(static_cast<VkDeviceSize>(level.size()));
+    }
+    // keep only the tail on the CPU, it is what evicted textures fall back to
+    for (uint32_t level = 0; level < tailLevel; ++level) {
+      std::vector<unsigned char>().swap(chain.levels[level]);
+    }
+    entry.tail = std::move(chain);
+
+    // a destroyed texture's address can be reused before update() drops its entry
+    auto stale = entries.find(texture.get());
+    if (stale != entries.end()) {
+      stats.residentBytes -= bytesFrom(stale->second, stale->second.residentLevel);
+      entries.erase(stale);
+    }
+    stats.residentBytes += bytesFrom(entry, tailLevel);
+    entries.emplace(texture.get(), std::move(entry));
+    return texture;
+  }
+
+  void LveTextureStreamer::requestForScreenSize(const backend::RenderTexture *texture, float screenPixels) {
+    if (!texture || screenPixels <= 0.f) {
+      return;
+    }
+    auto it = entries.find(static_cast<const LveTexture*>(texture));
+    if (it == entries.end() || it->second.texture.expired()) {
+      return;
+    }
+    Entry &entry = it->second;
+    const float textureSize = static_cast<float>(std::max(entry.tail.width, entry.tail.height));
+    const float wanted = std::floor(std::log2(textureSize / screenPixels) + config.mipBias);
+    const uint32_t level = static_cast<uint32_t>(
+      std::clamp(wanted, 0.f, static_cast<float>(entry.tailLevel)));
+    entry.frameRequest = std::min(entry.frameRequest, level);
+  }
+
+  void LveTextureStreamer::update(LveRenderer &renderer) {
+    ++frameCount;
+    for (auto it = entries.begin(); it != entries.end();) {
+      Entry &entry = it->second;
+      if (entry.texture.expired()) {
+        stats.residentBytes -= bytesFrom(entry, entry.residentLevel);
+        it = entries.erase(it);
+        continue;
+      }
+      if (entry.frameRequest != kNoRequest) {
+        entry.requestedLevel = entry.frameRequest;
+        entry.lastUsedFrame = frameCount;
+      } else {
+        entry.requestedLevel = entry.tailLevel;
+      }
+      entry.frameRequest = kNoRequest;
+      ++it;
+    }
+
+    finishLoads(renderer);
+    // a lowered budget is enforced as soon as there is something to evict
+    makeRoom(0, nullptr, renderer);
+    startLoads();
+    updateStats();
+  }
+
+  VkDeviceSize LveTextureStreamer::bytesFrom(const Entry &entry, uint32_t level) const {
+    VkDeviceSize bytes = 0;
+    for (std::size_t i = level; i < entry.levelBytes.size(); ++i) {
+      bytes += entry.levelBytes[i];
+    }
+    return bytes;
+  }
+
+  VkDeviceSize LveTextureStreamer::evictableBytes(const Entry *keep) const {
+    VkDeviceSize bytes = 0;
+    for (const auto &[texture, entry] : entries) {
+      if (&entry != keep && entry.lastUsedFrame < frameCount) {
+        bytes += bytesFrom(entry, entry.residentLevel) - bytesFrom(entry, entry.tailLevel);
+      }
+    }
+    return bytes;
+  }
+
+  void LveTextureStreamer::finishLoads(LveRenderer &renderer) {
+    for (auto &[key, entry] : entries) {
+      if (!isReady(entry.load)) {
+        continue;
+      }
+      std::shared_ptr<TextureMipChain> chain = entry.load.get();
+      auto texture = entry.texture.lock();
+      if (!texture) {
+        continue;
+      }
+      // a file changed on disk no longer matches the resident tail, keep what is there
+      if (!chain || chain->format != entry.tail.format || chain->width != entry.tail.width ||
+          chain->height != entry.tail.height || chain->levels.size() != entry.levelBytes.size()) {
+        entry.loadFailed = true;
+        continue;
+      }
+
+      // the request may have moved while loading, use the latest one the budget allows
+      uint32_t level = entry.requestedLevel;
+      const VkDeviceSize resident = bytesFrom(entry, entry.residentLevel);
+      while (level < entry.residentLevel &&
+             !makeRoom(bytesFrom(entry, level) - resident, &entry, renderer)) {
+        ++level;
+      }
+      if (level < entry.residentLevel) {
+        setResidentLevel(entry, *texture, *chain, level, renderer);
+      }
+    }
+  }
+
+  void LveTextureStreamer::startLoads() {
+    int inFlight = 0;
+    std::vector<Entry*> candidates;
+    for (auto &[key, entry] : entries) {
+      if (entry.load.valid()) {
+        ++inFlight;
+      } else if (
+        !entry.loadFailed &&
+        entry.lastUsedFrame == frameCount &&
+        entry.requestedLevel < entry.residentLevel) {
+        candidates.push_back(&entry);
+      }
+    }
+    if (candidates.empty() || inFlight >= config.maxConcurrentLoads) {
+      return;
+    }
+
+    // largest quality gap first
+    std::sort(candidates.begin(), candidates.end(), [](const Entry *a, const Entry *b) {
+      return a->residentLevel - a->requestedLevel > b->residentLevel - b->requestedLevel;
+    });
+
+    for (Entry *entry : candidates) {
+      if (inFlight >= config.maxConcurrentLoads) {
+        break;
+      }
+      // don't decode a file when not even one more level could be made resident
+      const VkDeviceSize extra =
+        bytesFrom(*entry, entry->residentLevel - 1) - bytesFrom(*entry, entry->residentLevel);
+      if (stats.residentBytes - evictableBytes(entry) + extra > config.budgetBytes) {
+        continue;
+      }
+      LveDevice &loadDevice = device;
+      entry->load = std::async(
+        std::launch::async,
+        [&loadDevice, path = entry->path, options = entry->options]() -> std::shared_ptr<TextureMipChain> {
+          auto chain = std::make_shared<TextureMipChain>();
+          std::string error;
+          if (!LveTexture::loadMipChain(loadDevice, path, options, *chain, &error)) {
+            std::cerr << "Failed to stream texture " << path;
+            if (!error.empty()) {
+              std::cerr << ": " << error;
+            }
+            std::cerr << "\n";
+            return {};
+          }
+          return chain;
+        });
+      ++inFlight;
+    }
+  }
+
+  bool LveTextureStreamer::makeRoom(VkDeviceSize bytes, const Entry *keep, LveRenderer &renderer) {
+    while (stats.residentBytes + bytes > config.budgetBytes) {
+      // least recently seen texture that still has levels above its tail, never one in view
+      Entry *victim = nullptr;
+      for (auto &[key, entry] : entries) {
+        if (&entry == keep || entry.residentLevel >= entry.tailLevel || entry.lastUsedFrame >= frameCount) {
+          continue;
+        }
+        if (!victim || entry.lastUsedFrame < victim->lastUsedFrame) {
+          victim = &entry;
+        }
+      }
+      if (!victim) {
+        return false;
+      }
+      auto texture = victim->texture.lock();
+      if (!texture) {
+        return false;
+      }
+      setResidentLevel(*victim, *texture, victim->tail, victim->tailLevel, renderer);
+      stats.evictions++;
+    }
+    return true;
+  }
+
+  void LveTextureStreamer::setResidentLevel(
+    Entry &entry,
+    LveTexture &texture,
+    const TextureMipChain &chain,
+    uint32_t level,
+    LveRenderer &renderer) {
+    texture.setResidentLevels(chain, level, [&renderer](std::function<void()> release) {
+      renderer.retireResource(std::move(release));
+    });
+    stats.residentBytes -= bytesFrom(entry, entry.residentLevel);
+    stats.residentBytes += bytesFrom(entry, level);
+    entry.residentLevel = level;
+  }
+
+  void LveTextureStreamer::updateStats() {
+    stats.requestedBytes = 0;
+    stats.pendingLoads = 0;
+    for (const auto &[key, entry] : entries) {
+      stats.requestedBytes += bytesFrom(entry, entry.requestedLevel);
+      if (entry.load.valid()) {
+        stats.pendingLoads++;
+      }
+    }
+    stats.streamedTextures = static_cast<uint32_t>(entries.size());
+  }
+
+} // namespace lve
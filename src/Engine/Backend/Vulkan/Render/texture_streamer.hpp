@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Engine/Backend/render_assets.hpp"
+#include "Engine/Backend/render_types.hpp"
+#include "Engine/Backend/Vulkan/Core/device.hpp"
+#include "Engine/Backend/Vulkan/Render/texture.hpp"
+
+// std
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+  class LveRenderer;
+
+  // File textures start with only their tail mips (<= residentTailSize) resident. The render
+  // backend reports how large each texture appears on screen while recording a frame; update()
+  // then decodes the wanted levels on worker threads and swaps them in, evicting the high mips of
+  // the least recently seen textures when the budget would be exceeded. update() has to run
+  // before any draw of the frame is recorded, replaced images are retired through the renderer.
+  class LveTextureStreamer {
+  public:
+    explicit LveTextureStreamer(LveDevice &device, const backend::TextureStreamingConfig &config = {});
+
+    LveTextureStreamer(const LveTextureStreamer &) = delete;
+    LveTextureStreamer &operator=(const LveTextureStreamer &) = delete;
+
+    // registers the texture for streaming, or loads it whole when streaming is off or the image
+    // has no levels above the tail
+    std::shared_ptr<LveTexture> loadTexture(
+      const std::string &path,
+      const backend::TextureLoadOptions &options,
+      std::string *outError = nullptr);
+    // same as loadTexture for a chain already decoded by LveTexture::loadMipChain
+    std::shared_ptr<LveTexture> createTexture(
+      const std::string &path,
+      const backend::TextureLoadOptions &options,
+      TextureMipChain chain);
+
+    // screenPixels is the longest side the full texture would cover on screen; textures that
+    // were not loaded through the streamer are ignored
+    void requestForScreenSize(const backend::RenderTexture *texture, float screenPixels);
+    void update(LveRenderer &renderer);
+
+    void setConfig(const backend::TextureStreamingConfig &newConfig) { config = newConfig; }
+    const backend::TextureStreamingConfig &getConfig() const { return config; }
+    const backend::TextureStreamingStats &getStats() const { return stats; }
+
+  private:
+    static constexpr uint32_t kNoRequest = ~0u;
+
+    struct Entry {
+      std::weak_ptr<LveTexture> texture;
+      std::string path;
+      backend::TextureLoadOptions options;
+      TextureMipChain tail; // only levels >= tailLevel hold data
+      std::vector<VkDeviceSize> levelBytes;
+      uint32_t tailLevel{0};
+      uint32_t residentLevel{0};
+      uint32_t requestedLevel{0}; // finest level asked for during the last frame
+      uint32_t frameRequest{kNoRequest}; // accumulates the current frame
+      uint64_t lastUsedFrame{0};
+      bool loadFailed{false};
+      // std::async future, destroying an entry mid load waits for the worker
+      std::future<std::shared_ptr<TextureMipChain>> load;
+    };
+
+    VkDeviceSize bytesFrom(const Entry &entry, uint32_t level) const;
+    VkDeviceSize evictableBytes(const Entry *keep) const;
+    void finishLoads(LveRenderer &renderer);
+    void startLoads();
+    bool makeRoom(VkDeviceSize bytes, const Entry *keep, LveRenderer &renderer);
+    void setResidentLevel(Entry &entry, LveTexture &texture, const TextureMipChain &chain, uint32_t level, LveRenderer &renderer);
+    void updateStats();
+
+    LveDevice &device;
+    backend::TextureStreamingConfig config;
+    backend::TextureStreamingStats stats{};
+    std::unordered_map<const LveTexture*, Entry> entries;
+    uint64_t frameCount{0};
+  };
+} // namespace lve
@@ -4,6 +4,7 @@ layout (location = 0) in vec3 fragColor;
 layout (location = 1) in vec3 fragPosWorld;
 layout (location = 2) in vec3 fragNormalWorld;
 layout (location = 3) in vec2 fragUv;
+layout (location = 4) in vec4 fragTangentWorld;
 
 layout (location = 0) out vec4 outColor;
 
@@ -35,6 +36,13 @@ layout(push_constant) uniform Push {
   vec4 misc; // roughness, occlusionStrength, normalScale, debugView
 } push;
 
+mat3 vertexTangentFrame(vec3 normal, vec4 tangent) {
+  vec3 t = normalize(tangent.xyz - normal * dot(normal, tangent.xyz));
+  vec3 b = cross(normal, t) * tangent.w;
+  return mat3(t, b, normal);
+}
+
+// fallback for meshes without vertex tangents
 mat3 cotangentFrame(vec3 normal, vec3 position, vec2 uv) {
   vec3 dp1 = dFdx(position);
   vec3 dp2 = dFdy(position);
@@ -76,9 +84,18 @@ void main() {
   bool hasEmissive = (push.flags0.x & (1 << 4)) != 0;
 
   if (hasNormal) {
-    vec3 tangentNormal = texture(normalMap, animatedUv).xyz * 2.0 - 1.0;
+    // normal maps are stored as two channels (RG8 / BC5), z is rebuilt
+    vec2 normalXy = texture(normalMap, animatedUv).xy * 2.0 - 1.0;
+    vec3 tangentNormal = vec3(normalXy, sqrt(max(1.0 - dot(normalXy, normalXy), 0.0)));
     tangentNormal.xy *= push.misc.z;
-    mat3 tbn = cotangentFrame(surfaceNormal, fragPosWorld, animatedUv);
+    mat3 tbn;
+    if (fragTangentWorld.w != 0.0) {
+      // mirroring U reverses the tangent only; negating w keeps the bitangent
+      vec4 tangent = push.flags0.w == 2 ? -fragTangentWorld : fragTangentWorld;
+      tbn = vertexTangentFrame(surfaceNormal, tangent);
+    } else {
+      tbn = cotangentFrame(surfaceNormal, fragPosWorld, animatedUv);
+    }
     surfaceNormal = normalize(tbn * tangentNormal);
   }
 
@@ -105,9 +122,10 @@ void main() {
   albedo *= push.baseColor.rgb;
 
   if (hasMetallicRoughness) {
-    vec4 mrSample = texture(metallicRoughnessMap, animatedUv);
-    metallic = clamp(metallic * mrSample.b, 0.0, 1.0);
-    roughness = clamp(roughness * mrSample.g, 0.0, 1.0);
+    // packed at load: r = roughness, g = metallic
+    vec2 mrSample = texture(metallicRoughnessMap, animatedUv).rg;
+    metallic = clamp(metallic * mrSample.g, 0.0, 1.0);
+    roughness = clamp(roughness * mrSample.r, 0.0, 1.0);
   }
   if (hasOcclusion) {
     float occSample = texture(occlusionMap, animatedUv).r;
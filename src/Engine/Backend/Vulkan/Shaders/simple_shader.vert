@@ -4,11 +4,13 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 color;
 layout(location = 2) in vec3 normal;
 layout(location = 3) in vec2 uv;
+layout(location = 4) in vec4 tangent;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
 layout(location = 3) out vec2 fragUv;
+layout(location = 4) out vec4 fragTangentWorld;
 
 struct PointLight {
   vec4 position; // ignore w
@@ -26,18 +28,32 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
 
 layout(push_constant) uniform Push {
   mat4 modelMatrix;
-  ivec4 flags0;
+  ivec4 flags0; // x bit 5 marks compact vertices
   vec4 baseColor;
   vec4 emissiveMetallic;
   vec4 misc;
 } push;
 
+vec3 octDecode(vec2 e) {
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0);
+  n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+  return normalize(n);
+}
+
 void main() {
   vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
   gl_Position = ubo.projection * ubo.view * positionWorld;
-  mat3 normalMatrix = transpose(inverse(mat3(push.modelMatrix)));
-  fragNormalWorld = normalize(normalMatrix * normal);
+  // compact positions come with a uniform extent folded into modelMatrix, which only scales
+  // directions that get normalized anyway
+  mat3 modelLinear = mat3(push.modelMatrix);
+  vec3 objectNormal = (push.flags0.x & (1 << 5)) != 0 ? octDecode(normal.xy) : normal;
+  mat3 normalMatrix = transpose(inverse(modelLinear));
+  fragNormalWorld = normalize(normalMatrix * objectNormal);
   fragPosWorld = positionWorld.xyz;
   fragColor = color;
   fragUv = uv;
+  // w == 0 marks meshes imported without tangents, mirroring transforms flip the handedness
+  float mirror = determinant(modelLinear) < 0.0 ? -1.0 : 1.0;
+  fragTangentWorld = vec4(modelLinear * tangent.xyz, tangent.w * mirror);
 }
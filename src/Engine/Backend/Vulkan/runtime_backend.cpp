@@ -5,19 +5,42 @@
 
 namespace lve::backend {
 
-  VulkanRuntimeBackend::VulkanRuntimeBackend(int width, int height, std::string title)
+  VulkanRuntimeBackend::VulkanRuntimeBackend(
+    int width,
+    int height,
+    std::string title,
+    const FramePacingConfig &framePacing,
+    const TextureStreamingConfig &textureStreaming)
     : windowImpl{width, height, std::move(title), WindowClientApi::Vulkan}
     , inputProvider{windowImpl}
     , windowBackend{windowImpl, inputProvider}
     , device{windowImpl}
-    , assetFactory{device}
+    , textureStreamer{device, textureStreaming}
+    , assetFactory{device, textureStreamer}
     , sceneSystemImpl{
         assetFactory,
         std::make_unique<VulkanObjectBufferPool>(
           device,
           LveGameObjectManager::MAX_GAME_OBJECTS,
           sizeof(GameObjectBufferData))}
-    , renderBackendImpl{windowImpl, device}
+    , renderBackendImpl{windowImpl, device, textureStreamer, framePacing}
     , editorBackendImpl{windowImpl, device} {}
 
+  VulkanHeadlessRuntimeBackend::VulkanHeadlessRuntimeBackend(
+    int width,
+    int height,
+    const FramePacingConfig &framePacing,
+    const TextureStreamingConfig &textureStreaming)
+    : windowBackend{RenderExtent{static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height)}}
+    , device{}
+    , textureStreamer{device, textureStreaming}
+    , assetFactory{device, textureStreamer}
+    , sceneSystemImpl{
+        assetFactory,
+        std::make_unique<VulkanObjectBufferPool>(
+          device,
+          LveGameObjectManager::MAX_GAME_OBJECTS,
+          sizeof(GameObjectBufferData))}
+    , renderBackendImpl{device, textureStreamer, windowBackend.getExtent(), framePacing} {}
+
 } // namespace lve::backend
@@ -1,12 +1,15 @@
 #pragma once
 
+#include "Engine/Backend/headless_editor_backend.hpp"
 #include "Engine/Backend/runtime_backend.hpp"
 #include "Engine/Backend/Vulkan/Core/device.hpp"
 #include "Engine/Backend/Window/glfw_input.hpp"
+#include "Engine/Backend/Window/headless_window.hpp"
 #include "Engine/Backend/Window/window_backend.hpp"
 #include "Engine/Backend/Vulkan/Editor/editor_render_backend.hpp"
 #include "Engine/Backend/Vulkan/Render/asset_factory.hpp"
 #include "Engine/Backend/Vulkan/Render/render_backend.hpp"
+#include "Engine/Backend/Vulkan/Render/texture_streamer.hpp"
 #include "Engine/scene_system.hpp"
 
 #include <memory>
@@ -15,7 +18,12 @@
 namespace lve::backend {
   class VulkanRuntimeBackend final : public RuntimeBackend {
   public:
-    VulkanRuntimeBackend(int width, int height, std::string title);
+    VulkanRuntimeBackend(
+      int width,
+      int height,
+      std::string title,
+      const FramePacingConfig &framePacing = {},
+      const TextureStreamingConfig &textureStreaming = {});
 
     WindowBackend &window() override { return windowBackend; }
     RenderBackend &renderBackend() override { return renderBackendImpl; }
@@ -27,9 +35,34 @@ namespace lve::backend {
     GlfwInputProvider inputProvider;
     GlfwWindowBackend windowBackend;
     LveDevice device;
+    LveTextureStreamer textureStreamer;
     VulkanRenderAssetFactory assetFactory;
     SceneSystem sceneSystemImpl;
     VulkanRenderBackend renderBackendImpl;
     VulkanEditorRenderBackend editorBackendImpl;
   };
+
+  // no window, surface or swapchain: scene and game views render offscreen for readback
+  class VulkanHeadlessRuntimeBackend final : public RuntimeBackend {
+  public:
+    VulkanHeadlessRuntimeBackend(
+      int width,
+      int height,
+      const FramePacingConfig &framePacing = {},
+      const TextureStreamingConfig &textureStreaming = {});
+
+    WindowBackend &window() override { return windowBackend; }
+    RenderBackend &renderBackend() override { return renderBackendImpl; }
+    EditorRenderBackend &editorBackend() override { return editorBackendImpl; }
+    SceneSystem &sceneSystem() override { return sceneSystemImpl; }
+
+  private:
+    HeadlessWindowBackend windowBackend;
+    LveDevice device;
+    LveTextureStreamer textureStreamer;
+    VulkanRenderAssetFactory assetFactory;
+    SceneSystem sceneSystemImpl;
+    VulkanRenderBackend renderBackendImpl;
+    HeadlessEditorRenderBackend editorBackendImpl;
+  };
 } // namespace lve::backend
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Engine/Backend/runtime_window.hpp"
+
+namespace lve::backend {
+  class HeadlessInputProvider final : public InputProvider {
+  public:
+    bool isKeyPressed(KeyCode) const override { return false; }
+  };
+
+  // fixed extent and no events; the caller decides how many frames to render
+  class HeadlessWindowBackend final : public WindowBackend {
+  public:
+    explicit HeadlessWindowBackend(RenderExtent extent) : extent{extent} {}
+
+    void pollEvents() override {}
+    bool shouldClose() const override { return false; }
+    RenderExtent getExtent() const override { return extent; }
+    InputProvider &input() override { return inputProvider; }
+    const InputProvider &input() const override { return inputProvider; }
+
+  private:
+    RenderExtent extent;
+    HeadlessInputProvider inputProvider;
+  };
+} // namespace lve::backend
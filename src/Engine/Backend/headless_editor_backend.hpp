@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Engine/Backend/editor_render_backend.hpp"
+
+namespace lve::backend {
+  // stands in for the editor UI when there is no window to draw it into
+  class HeadlessEditorRenderBackend final : public EditorRenderBackend {
+  public:
+    void init(RenderPassHandle, std::uint32_t) override {}
+    void onRenderPassChanged(RenderPassHandle, std::uint32_t) override {}
+    void shutdown() override {}
+    void newFrame() override {}
+    void buildUI(
+      float,
+      const glm::vec3 &,
+      const glm::vec3 &,
+      bool &,
+      bool &,
+      bool &,
+      bool &) override {}
+    void render(CommandBufferHandle) override {}
+    void renderPlatformWindows() override {}
+    void waitIdle() override {}
+    DescriptorSetHandle getTexturePreview(const std::string &, RenderExtent &outExtent) override {
+      outExtent = {};
+      return nullptr;
+    }
+  };
+} // namespace lve::backend
@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -19,6 +20,30 @@ namespace lve::backend {
     }
   };
 
+  // GPU layout of a model's vertices, the CPU side always works on ModelVertex
+  enum class ModelVertexFormat : std::uint32_t {
+    Full,    // ModelVertex as is, 44 bytes, plus a 16 byte tangent stream when the model has tangents
+    Compact  // CompactModelVertex, quantized when the vertex buffer is built
+  };
+
+  // 24 bytes: unorm16 position inside the cube over the model's vertex bounds, rgba8 color, octahedral snorm16 normal,
+  // half uv and snorm8 tangent with the bitangent sign in w, zero without a tangent stream
+  struct CompactModelVertex {
+    std::uint16_t position[4];
+    std::uint32_t color;
+    std::uint32_t normal;
+    std::uint32_t uv;
+    std::uint32_t tangent;
+  };
+  static_assert(sizeof(CompactModelVertex) == 24, "CompactModelVertex must stay tightly packed");
+
+  // a simplified index range over the submesh's own vertices
+  struct ModelLod {
+    std::uint32_t firstIndex{0};
+    std::uint32_t indexCount{0};
+    float error{0.f};  // largest deviation from the full mesh, relative to the bounds' radius
+  };
+
   struct ModelSubMesh {
     std::uint32_t firstIndex{0};
     std::uint32_t indexCount{0};
@@ -26,6 +51,7 @@ namespace lve::backend {
     glm::vec3 boundsMin{0.f};
     glm::vec3 boundsMax{0.f};
     bool hasBounds{false};
+    std::vector<ModelLod> lods{};  // coarser levels, finest first
   };
 
   struct ModelTextureSource {
@@ -62,12 +88,25 @@ namespace lve::backend {
     glm::vec3 halfSize() const { return (max - min) * 0.5f; }
   };
 
+  // vertex and index ranges owned elsewhere, a ModelData or a mapped cooked model
+  struct ModelGeometryView {
+    const ModelVertex *vertices{nullptr};
+    std::size_t vertexCount{0};
+    const glm::vec4 *tangents{nullptr};  // vertexCount entries, or null
+    const std::uint32_t *indices{nullptr};
+    std::size_t indexCount{0};
+  };
+
   struct ModelData {
     std::vector<ModelVertex> vertices{};
+    // xyz along +U, w is the bitangent sign and zero where a vertex has none. Either empty or one
+    // per vertex, only meshes that need normal mapping frames pay for it.
+    std::vector<glm::vec4> tangents{};
     std::vector<std::uint32_t> indices{};
     std::vector<ModelSubMesh> subMeshes{};
     std::vector<ModelNode> nodes{};
     std::vector<ModelMaterialSource> materials{};
+    ModelVertexFormat vertexFormat{ModelVertexFormat::Full};
   };
 
 } // namespace lve::backend
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "Engine/Backend/model_data.hpp"
+#include "Engine/IO/model_io.hpp"
 #include "Engine/material_data.hpp"
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -12,9 +15,42 @@
 
 namespace lve::backend {
 
+  struct TextureLoadOptions {
+    TextureUsage usage{TextureUsage::Color};
+    bool sRGB{true};  // ignored for data usages, they are always linear
+    bool generateMipmaps{true};
+    int maxSize{0};  // longest side, larger images are halved until they fit
+    TextureFilter filter{TextureFilter::Nearest};
+    TextureWrap wrap{TextureWrap::Repeat};
+    // pre-encoded KTX2 uploaded as is when the device supports its format
+    std::string compressedPath{};
+  };
+
+  // maps a resolved texture path and the slot it is loaded for to its per-asset import options
+  using TextureOptionsProvider =
+    std::function<TextureLoadOptions(const std::string &path, TextureUsage usage)>;
+
+  struct ModelLoadOptions {
+    // cooked binary copy of the model, mapped instead of importing the source when valid
+    std::string cookedPath{};
+    ModelImportSettings importSettings{};
+  };
+
+  using ModelOptionsProvider = std::function<ModelLoadOptions(const std::string &path)>;
+
+  struct TextureCacheStats {
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::size_t liveTextures{0}; // registry entries still referenced somewhere
+  };
+
   class RenderTexture {
   public:
     virtual ~RenderTexture() = default;
+
+    // changes whenever the texture is backed by a different image (mip streaming), so cached
+    // descriptors can be rebuilt. Values come from one increasing counter across all textures.
+    virtual std::uint64_t getRevision() const { return 0; }
   };
 
   class RenderMaterial {
@@ -53,6 +89,48 @@ namespace lve::backend {
     virtual const ModelBoundingBox &getBoundingBox() const = 0;
   };
 
+  enum class AssetLoadState { Pending, Ready, Failed };
+
+  // Result of a background load. The factory only resolves it from processAsyncLoads() on the
+  // main thread, so holders poll it without locking and use a placeholder until it is ready.
+  template <typename T>
+  class AssetHandle {
+  public:
+    static AssetHandle pending() {
+      AssetHandle handle{};
+      handle.slot = std::make_shared<Slot>();
+      return handle;
+    }
+    static AssetHandle ready(std::shared_ptr<T> asset) {
+      AssetHandle handle = pending();
+      handle.resolve(std::move(asset));
+      return handle;
+    }
+
+    bool valid() const { return slot != nullptr; }
+    AssetLoadState state() const { return slot ? slot->state : AssetLoadState::Failed; }
+    bool isPending() const { return state() == AssetLoadState::Pending; }
+    bool isReady() const { return state() == AssetLoadState::Ready; }
+    std::shared_ptr<T> get() const { return slot ? slot->asset : std::shared_ptr<T>{}; }
+    std::shared_ptr<T> getOr(const std::shared_ptr<T> &placeholder) const {
+      return isReady() ? slot->asset : placeholder;
+    }
+
+    // a null asset marks the load as failed
+    void resolve(std::shared_ptr<T> asset) {
+      if (!slot) return;
+      slot->state = asset ? AssetLoadState::Ready : AssetLoadState::Failed;
+      slot->asset = std::move(asset);
+    }
+
+  private:
+    struct Slot {
+      AssetLoadState state{AssetLoadState::Pending};
+      std::shared_ptr<T> asset{};
+    };
+    std::shared_ptr<Slot> slot{};
+  };
+
   class RenderAssetFactory {
   public:
     virtual ~RenderAssetFactory() = default;
@@ -69,6 +147,20 @@ namespace lve::backend {
       std::string *outError = nullptr) = 0;
     virtual std::shared_ptr<RenderTexture> loadTexture(const std::string &path) = 0;
     virtual std::shared_ptr<RenderTexture> getDefaultTexture() = 0;
+    virtual void setTextureOptionsProvider(TextureOptionsProvider provider) = 0;
+    virtual void setModelOptionsProvider(ModelOptionsProvider provider) = 0;
+    virtual TextureCacheStats getTextureCacheStats() const = 0;
+
+    // Files are decoded on worker threads, GPU resources are created by processAsyncLoads().
+    // Options and path resolvers are evaluated on the calling thread.
+    virtual AssetHandle<RenderModel> loadModelAsync(const std::string &path) = 0;
+    virtual AssetHandle<RenderMaterial> loadMaterialAsync(
+      const std::string &path,
+      const std::function<std::string(const std::string &)> &pathResolver = {}) = 0;
+    virtual AssetHandle<RenderTexture> loadTextureAsync(const std::string &path) = 0;
+    // main thread only, outside of frame recording; uploads go through the regular upload batch
+    virtual void processAsyncLoads() = 0;
+    virtual std::size_t getPendingAsyncLoads() const = 0;
   };
 
 } // namespace lve::backend
@@ -8,6 +8,7 @@
 namespace lve {
   class LveCamera;
   class LveGameObject;
+  struct ImageData;
 }
 
 namespace lve::backend {
@@ -26,6 +27,8 @@ namespace lve::backend {
       std::uint32_t sceneHeight,
       std::uint32_t gameWidth,
       std::uint32_t gameHeight) = 0;
+    // RGBA8 pixels of the view's last finished frame; call outside beginFrame/endFrame
+    virtual bool readbackView(RenderView view, ImageData &outImage) = 0;
 
     virtual bool wasSwapChainRecreated() const = 0;
     virtual RenderPassHandle getSwapChainRenderPass() const = 0;
@@ -35,6 +38,16 @@ namespace lve::backend {
     virtual float getAspectRatio() const = 0;
     virtual int getFrameIndex() const = 0;
 
+    virtual void setFramePacing(const FramePacingConfig &config) = 0;
+    virtual FramePacingConfig getFramePacing() const = 0;
+    virtual const FramePacingStats &getFramePacingStats() const = 0;
+
+    virtual void setTextureStreaming(const TextureStreamingConfig &config) = 0;
+    virtual TextureStreamingConfig getTextureStreaming() const = 0;
+    virtual const TextureStreamingStats &getTextureStreamingStats() const = 0;
+
+    virtual DescriptorStats getDescriptorStats() const = 0;
+
     virtual void setWireframe(bool enabled) = 0;
     virtual void setNormalView(bool enabled) = 0;
 
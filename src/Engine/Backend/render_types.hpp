@@ -4,7 +4,62 @@
 #include <cstdint>
 
 namespace lve::backend {
-  constexpr int kMaxFramesInFlight = 2;
+  // upper bound for per-frame arrays; the active count comes from FramePacingConfig
+  constexpr int kMaxFramesInFlight = 3;
+
+  enum class PresentMode {
+    Fifo,
+    Mailbox,
+    Immediate
+  };
+
+  struct FramePacingConfig {
+    int framesInFlight{2}; // clamped to [1, kMaxFramesInFlight]
+    PresentMode presentMode{PresentMode::Fifo}; // falls back to Fifo when unsupported
+    float maxFrameRate{0.f}; // CPU frame limiter, 0 disables it
+  };
+
+  struct FrameTimingSample {
+    double fenceWaitMs{0.0};
+    double acquireMs{0.0};
+    double presentIntervalMs{0.0};
+    double limiterSleepMs{0.0};
+  };
+
+  struct FramePacingStats {
+    FrameTimingSample last{};
+    FrameTimingSample average{}; // exponential moving average
+    FrameTimingSample peak{};
+    std::uint64_t frameCount{0};
+  };
+
+  struct TextureStreamingConfig {
+    bool enabled{true};
+    std::uint64_t budgetBytes{256ull * 1024 * 1024}; // streamed texture memory, tails included
+    std::uint32_t residentTailSize{64}; // mips at or below this size stay resident
+    int maxConcurrentLoads{2};
+    float mipBias{0.f}; // added to the screen size based level, positive favours lower mips
+  };
+
+  struct TextureStreamingStats {
+    std::uint64_t residentBytes{0};
+    std::uint64_t requestedBytes{0}; // what the visible textures would need without a budget
+    std::uint32_t streamedTextures{0};
+    std::uint32_t pendingLoads{0};
+    std::uint64_t evictions{0};
+  };
+
+  struct DescriptorStats {
+    std::uint32_t pools{0};  // descriptor pools created so far
+    std::uint64_t objectSets{0};  // cached per-object sets, including ones awaiting a recycle
+    std::uint64_t objectRecycles{0};  // object pools reset to drop sets of destroyed objects
+  };
+
+  enum class RenderView {
+    Scene,
+    Game
+  };
+  constexpr std::size_t kRenderViewCount = 2;
 
   struct RenderExtent {
     std::uint32_t width{0};
@@ -0,0 +1,425 @@
+#include "Engine/IO/cooked_model_io.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace lve {
+
+  namespace {
+    static_assert(std::is_trivially_copyable<backend::ModelVertex>::value, "vertices are stored as raw bytes");
+
+    constexpr char kCookedModelMagic[4] = {'L', 'V', 'E', 'M'};
+    constexpr std::uint32_t kCookedModelVersion = 5;
+    constexpr std::uint64_t kBlockAlignment = 16;
+
+    struct CookedModelHeader {
+      char magic[4];
+      std::uint32_t version;
+      std::uint32_t vertexStride;
+      std::uint32_t reserved;
+      CookedModelKey key;
+      std::uint64_t metadataOffset;
+      std::uint64_t metadataSize;
+      std::uint64_t vertexOffset;
+      std::uint64_t vertexCount;
+      std::uint64_t tangentOffset;
+      std::uint64_t tangentCount;  // 0 or vertexCount
+      std::uint64_t indexOffset;
+      std::uint64_t indexCount;
+    };
+    static_assert(std::is_trivially_copyable<CookedModelHeader>::value, "header is stored as raw bytes");
+
+    void setError(std::string *outError, const std::string &message) {
+      if (outError) {
+        *outError = message;
+      }
+    }
+
+    std::uint64_t alignUp(std::uint64_t value) {
+      return (value + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+    }
+
+    class ByteWriter {
+    public:
+      template <typename T>
+      void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw bytes only");
+        const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+      }
+
+      void putVec3(const glm::vec3 &value) {
+        put(value.x);
+        put(value.y);
+        put(value.z);
+      }
+
+      void putBytes(const std::vector<unsigned char> &bytes) {
+        put(static_cast<std::uint64_t>(bytes.size()));
+        out.insert(out.end(), bytes.begin(), bytes.end());
+      }
+
+      void putString(const std::string &value) {
+        put(static_cast<std::uint64_t>(value.size()));
+        out.insert(out.end(), value.begin(), value.end());
+      }
+
+      void putInts(const std::vector<int> &values) {
+        put(static_cast<std::uint64_t>(values.size()));
+        for (int value : values) put(static_cast<std::int32_t>(value));
+      }
+
+      std::vector<unsigned char> out;
+    };
+
+    // every read is bounds checked; a failed read leaves the reader failed for good
+    class ByteReader {
+    public:
+      ByteReader(const unsigned char *data, std::size_t size) : data{data}, size{size} {}
+
+      template <typename T>
+      bool get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw bytes only");
+        if (!take(sizeof(T))) return false;
+        std::memcpy(&value, data + offset - sizeof(T), sizeof(T));
+        return true;
+      }
+
+      bool getVec3(glm::vec3 &value) {
+        return get(value.x) && get(value.y) && get(value.z);
+      }
+
+      bool getCount(std::uint64_t &count, std::size_t elementSize) {
+        // a count can never describe more bytes than are left
+        return get(count) && count <= (size - offset) / std::max<std::size_t>(elementSize, 1);
+      }
+
+      bool getBytes(std::vector<unsigned char> &bytes) {
+        std::uint64_t count = 0;
+        if (!getCount(count, 1)) return fail();
+        bytes.assign(data + offset, data + offset + count);
+        offset += static_cast<std::size_t>(count);
+        return true;
+      }
+
+      bool getString(std::string &value) {
+        std::uint64_t count = 0;
+        if (!getCount(count, 1)) return fail();
+        value.assign(reinterpret_cast<const char *>(data + offset), static_cast<std::size_t>(count));
+        offset += static_cast<std::size_t>(count);
+        return true;
+      }
+
+      bool getInts(std::vector<int> &values) {
+        std::uint64_t count = 0;
+        if (!getCount(count, sizeof(std::int32_t))) return fail();
+        values.resize(static_cast<std::size_t>(count));
+        for (int &value : values) {
+          std::int32_t stored = 0;
+          if (!get(stored)) return false;
+          value = stored;
+        }
+        return true;
+      }
+
+      bool ok() const { return !failed; }
+
+    private:
+      bool take(std::size_t bytes) {
+        if (failed || bytes > size - offset) return fail();
+        offset += bytes;
+        return true;
+      }
+
+      bool fail() {
+        failed = true;
+        return false;
+      }
+
+      const unsigned char *data;
+      std::size_t size;
+      std::size_t offset{0};
+      bool failed{false};
+    };
+
+    std::vector<unsigned char> writeMetadata(const backend::ModelData &data) {
+      ByteWriter writer;
+      writer.put(static_cast<std::uint64_t>(data.subMeshes.size()));
+      for (const auto &subMesh : data.subMeshes) {
+        writer.put(subMesh.firstIndex);
+        writer.put(subMesh.indexCount);
+        writer.put(static_cast<std::int32_t>(subMesh.materialIndex));
+        writer.putVec3(subMesh.boundsMin);
+        writer.putVec3(subMesh.boundsMax);
+        writer.put(static_cast<std::uint8_t>(subMesh.hasBounds ? 1 : 0));
+        writer.put(static_cast<std::uint64_t>(subMesh.lods.size()));
+        for (const auto &lod : subMesh.lods) {
+          writer.put(lod.firstIndex);
+          writer.put(lod.indexCount);
+          writer.put(lod.error);
+        }
+      }
+
+      writer.put(static_cast<std::uint64_t>(data.nodes.size()));
+      for (const auto &node : data.nodes) {
+        writer.putString(node.name);
+        writer.put(static_cast<std::int32_t>(node.parent));
+        writer.putInts(node.children);
+        writer.putInts(node.meshes);
+        for (int column = 0; column < 4; ++column) {
+          for (int row = 0; row < 4; ++row) {
+            writer.put(node.localTransform[column][row]);
+          }
+        }
+      }
+
+      writer.put(static_cast<std::uint64_t>(data.materials.size()));
+      for (const auto &material : data.materials) {
+        const auto &source = material.diffuse;
+        writer.put(static_cast<std::uint32_t>(source.kind));
+        writer.putString(source.path);
+        writer.putBytes(source.data);
+        writer.put(static_cast<std::int32_t>(source.width));
+        writer.put(static_cast<std::int32_t>(source.height));
+      }
+      writer.put(static_cast<std::uint32_t>(data.vertexFormat));
+      return std::move(writer.out);
+    }
+
+    bool readMetadata(ByteReader &reader, backend::ModelData &outData) {
+      std::uint64_t count = 0;
+      if (!reader.getCount(count, 1)) return false;
+      outData.subMeshes.resize(static_cast<std::size_t>(count));
+      for (auto &subMesh : outData.subMeshes) {
+        std::int32_t materialIndex = -1;
+        std::uint8_t hasBounds = 0;
+        reader.get(subMesh.firstIndex);
+        reader.get(subMesh.indexCount);
+        reader.get(materialIndex);
+        reader.getVec3(subMesh.boundsMin);
+        reader.getVec3(subMesh.boundsMax);
+        if (!reader.get(hasBounds)) return false;
+        subMesh.materialIndex = materialIndex;
+        subMesh.hasBounds = hasBounds != 0;
+        std::uint64_t lodCount = 0;
+        if (!reader.getCount(lodCount, 3 * sizeof(std::uint32_t))) return false;
+        subMesh.lods.resize(static_cast<std::size_t>(lodCount));
+        for (auto &lod : subMesh.lods) {
+          reader.get(lod.firstIndex);
+          reader.get(lod.indexCount);
+          if (!reader.get(lod.error)) return false;
+        }
+      }
+
+      if (!reader.getCount(count, 1)) return false;
+      outData.nodes.resize(static_cast<std::size_t>(count));
+      for (auto &node : outData.nodes) {
+        std::int32_t parent = -1;
+        reader.getString(node.name);
+        reader.get(parent);
+        reader.getInts(node.children);
+        reader.getInts(node.meshes);
+        for (int column = 0; column < 4; ++column) {
+          for (int row = 0; row < 4; ++row) {
+            reader.get(node.localTransform[column][row]);
+          }
+        }
+        if (!reader.ok()) return false;
+        node.parent = parent;
+      }
+
+      if (!reader.getCount(count, 1)) return false;
+      outData.materials.resize(static_cast<std::size_t>(count));
+      for (auto &material : outData.materials) {
+        auto &source = material.diffuse;
+        std::uint32_t kind = 0;
+        std::int32_t width = 0;
+        std::int32_t height = 0;
+        reader.get(kind);
+        reader.getString(source.path);
+        reader.getBytes(source.data);
+        reader.get(width);
+        if (!reader.get(height)) return false;
+        if (kind > static_cast<std::uint32_t>(backend::ModelTextureSource::Kind::EmbeddedRaw)) return false;
+        source.kind = static_cast<backend::ModelTextureSource::Kind>(kind);
+        source.width = width;
+        source.height = height;
+      }
+      std::uint32_t vertexFormat = 0;
+      if (!reader.get(vertexFormat)) return false;
+      if (vertexFormat > static_cast<std::uint32_t>(backend::ModelVertexFormat::Compact)) return false;
+      outData.vertexFormat = static_cast<backend::ModelVertexFormat>(vertexFormat);
+      return reader.ok();
+    }
+
+    bool readHeader(std::istream &file, CookedModelHeader &header) {
+      file.read(reinterpret_cast<char *>(&header), sizeof(header));
+      return file && std::memcmp(header.magic, kCookedModelMagic, sizeof(kCookedModelMagic)) == 0 &&
+        header.version == kCookedModelVersion && header.vertexStride == sizeof(backend::ModelVertex);
+    }
+  } // namespace
+
+  bool saveCookedModelFile(
+    const std::string &path,
+    const backend::ModelData &data,
+    const CookedModelKey &key,
+    std::string *outError) {
+    const std::vector<unsigned char> metadata = writeMetadata(data);
+
+    CookedModelHeader header{};
+    std::memcpy(header.magic, kCookedModelMagic, sizeof(kCookedModelMagic));
+    header.version = kCookedModelVersion;
+    header.vertexStride = sizeof(backend::ModelVertex);
+    header.key = key;
+    header.metadataOffset = sizeof(CookedModelHeader);
+    header.metadataSize = metadata.size();
+    header.vertexOffset = alignUp(header.metadataOffset + header.metadataSize);
+    header.vertexCount = data.vertices.size();
+    header.tangentOffset = alignUp(header.vertexOffset + header.vertexCount * sizeof(backend::ModelVertex));
+    header.tangentCount = data.tangents.size() == data.vertices.size() ? data.tangents.size() : 0;
+    header.indexOffset = alignUp(header.tangentOffset + header.tangentCount * sizeof(glm::vec4));
+    header.indexCount = data.indices.size();
+
+    // written next to the target and renamed, a crash never leaves a half written file behind
+    const std::string tempPath = path + ".tmp";
+    {
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if (!file) {
+        setError(outError, "failed to open " + tempPath);
+        return false;
+      }
+      const char padding[kBlockAlignment] = {};
+      auto padTo = [&](std::uint64_t offset) {
+        const std::uint64_t position = static_cast<std::uint64_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(offset - position));
+      };
+      file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char *>(metadata.data()), static_cast<std::streamsize>(metadata.size()));
+      padTo(header.vertexOffset);
+      file.write(
+        reinterpret_cast<const char *>(data.vertices.data()),
+        static_cast<std::streamsize>(data.vertices.size() * sizeof(backend::ModelVertex)));
+      padTo(header.tangentOffset);
+      file.write(
+        reinterpret_cast<const char *>(data.tangents.data()),
+        static_cast<std::streamsize>(header.tangentCount * sizeof(glm::vec4)));
+      padTo(header.indexOffset);
+      file.write(
+        reinterpret_cast<const char *>(data.indices.data()),
+        static_cast<std::streamsize>(data.indices.size() * sizeof(std::uint32_t)));
+      if (!file) {
+        setError(outError, "failed to write " + tempPath);
+        return false;
+      }
+    }
+    std::remove(path.c_str());
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+      setError(outError, "failed to replace " + path);
+      std::remove(tempPath.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool readCookedModelKey(const std::string &path, CookedModelKey &outKey) {
+    std::ifstream file(path, std::ios::binary);
+    CookedModelHeader header{};
+    if (!file || !readHeader(file, header)) {
+      return false;
+    }
+    outKey = header.key;
+    return true;
+  }
+
+  bool writeCookedModelKey(const std::string &path, const CookedModelKey &key) {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    CookedModelHeader header{};
+    if (!file || !readHeader(file, header)) {
+      return false;
+    }
+    file.seekp(static_cast<std::streamoff>(offsetof(CookedModelHeader, key)));
+    file.write(reinterpret_cast<const char *>(&key), sizeof(key));
+    return static_cast<bool>(file);
+  }
+
+  bool CookedModel::open(const std::string &path, std::string *outError) {
+    close();
+    if (!file_.open(path, outError)) {
+      return false;
+    }
+
+    auto invalid = [&](const char *reason) {
+      setError(outError, path + ": " + reason);
+      close();
+      return false;
+    };
+
+    CookedModelHeader header{};
+    if (file_.size() < sizeof(header)) return invalid("truncated header");
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, kCookedModelMagic, sizeof(kCookedModelMagic)) != 0 ||
+        header.version != kCookedModelVersion ||
+        header.vertexStride != sizeof(backend::ModelVertex)) {
+      return invalid("not a cooked model of this version");
+    }
+
+    const std::uint64_t size = file_.size();
+    if (header.metadataOffset > size || header.metadataSize > size - header.metadataOffset ||
+        header.vertexOffset > size || header.vertexCount > (size - header.vertexOffset) / sizeof(backend::ModelVertex) ||
+        (header.tangentCount != 0 && header.tangentCount != header.vertexCount) ||
+        header.tangentOffset > size || header.tangentCount > (size - header.tangentOffset) / sizeof(glm::vec4) ||
+        header.indexOffset > size || header.indexCount > (size - header.indexOffset) / sizeof(std::uint32_t) ||
+        header.vertexOffset % alignof(backend::ModelVertex) != 0 ||
+        header.tangentOffset % alignof(glm::vec4) != 0 ||
+        header.indexOffset % alignof(std::uint32_t) != 0) {
+      return invalid("blocks out of range");
+    }
+
+    ByteReader reader{file_.data() + header.metadataOffset, static_cast<std::size_t>(header.metadataSize)};
+    metadata_ = backend::ModelData{};
+    if (!readMetadata(reader, metadata_)) {
+      return invalid("corrupt metadata");
+    }
+
+    geometry_.vertices = reinterpret_cast<const backend::ModelVertex *>(file_.data() + header.vertexOffset);
+    geometry_.vertexCount = static_cast<std::size_t>(header.vertexCount);
+    geometry_.tangents = header.tangentCount != 0
+      ? reinterpret_cast<const glm::vec4 *>(file_.data() + header.tangentOffset)
+      : nullptr;
+    geometry_.indices = reinterpret_cast<const std::uint32_t *>(file_.data() + header.indexOffset);
+    geometry_.indexCount = static_cast<std::size_t>(header.indexCount);
+
+    // the indices go to the GPU as they are, so a damaged file must not reference past the vertices
+    const std::uint32_t *indicesEnd = geometry_.indices + geometry_.indexCount;
+    if (geometry_.indexCount > 0 &&
+        *std::max_element(geometry_.indices, indicesEnd) >= geometry_.vertexCount) {
+      return invalid("index out of range");
+    }
+    for (const auto &subMesh : metadata_.subMeshes) {
+      if (static_cast<std::uint64_t>(subMesh.firstIndex) + subMesh.indexCount > geometry_.indexCount) {
+        return invalid("submesh out of range");
+      }
+      for (const auto &lod : subMesh.lods) {
+        if (static_cast<std::uint64_t>(lod.firstIndex) + lod.indexCount > geometry_.indexCount) {
+          return invalid("submesh lod out of range");
+        }
+      }
+    }
+
+    key_ = header.key;
+    return true;
+  }
+
+  void CookedModel::close() {
+    file_.close();
+    geometry_ = backend::ModelGeometryView{};
+    metadata_ = backend::ModelData{};
+    key_ = CookedModelKey{};
+  }
+
+} // namespace lve
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Engine/Backend/model_data.hpp"
+#include "Engine/IO/mapped_file.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace lve {
+
+  // identifies what a cooked model was built from; a change in any field means it is stale
+  struct CookedModelKey {
+    std::uint64_t sourceHash{0};  // FNV-1a of the source file contents
+    std::uint64_t settingsHash{0};  // import settings and cooker version
+    // size and write time of the hashed source, lets an untouched source skip rehashing
+    std::uint64_t sourceSize{0};
+    std::int64_t sourceModified{0};
+  };
+
+  // Binary ModelData: vertices, tangents and indices are stored as they are uploaded, so a load is a
+  // mapping plus a copy into staging memory. Files from another vertex layout fail to open.
+  bool saveCookedModelFile(
+    const std::string &path,
+    const backend::ModelData &data,
+    const CookedModelKey &key,
+    std::string *outError = nullptr);
+
+  // reads only the header
+  bool readCookedModelKey(const std::string &path, CookedModelKey &outKey);
+  // rewrites the key in place, for sources that were touched without changing
+  bool writeCookedModelKey(const std::string &path, const CookedModelKey &key);
+
+  class CookedModel {
+  public:
+    bool open(const std::string &path, std::string *outError = nullptr);
+    void close();
+
+    const CookedModelKey &key() const { return key_; }
+    // submeshes, nodes and materials; vertices and indices stay empty, see geometry()
+    const backend::ModelData &metadata() const { return metadata_; }
+    // points into the mapping, valid until close()
+    backend::ModelGeometryView geometry() const { return geometry_; }
+
+  private:
+    MappedFile file_{};
+    CookedModelKey key_{};
+    backend::ModelData metadata_{};
+    backend::ModelGeometryView geometry_{};
+  };
+
+} // namespace lve
@@ -0,0 +1,1210 @@
+#include "Engine/IO/gltf_io.hpp"
+
+#include "Engine/IO/mapped_file.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lve {
+
+  namespace {
+    constexpr std::uint32_t kGlbMagic = 0x46546C67;  // "glTF"
+    constexpr std::uint32_t kGlbChunkJson = 0x4E4F534A;
+    constexpr std::uint32_t kGlbChunkBin = 0x004E4942;
+    constexpr int kMaxJsonDepth = 64;
+
+    constexpr int kComponentByte = 5120;
+    constexpr int kComponentUnsignedByte = 5121;
+    constexpr int kComponentShort = 5122;
+    constexpr int kComponentUnsignedShort = 5123;
+    constexpr int kComponentUnsignedInt = 5125;
+    constexpr int kComponentFloat = 5126;
+
+    constexpr int kModeTriangles = 4;
+    constexpr int kModeTriangleStrip = 5;
+    constexpr int kModeTriangleFan = 6;
+
+    void setError(std::string *outError, const std::string &message) {
+      if (outError) {
+        *outError = message;
+      }
+    }
+
+    std::uint32_t get32(const unsigned char *data) {
+      return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+        static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24;
+    }
+
+    struct JsonValue {
+      enum class Type { Null, Bool, Number, String, Array, Object };
+      Type type{Type::Null};
+      bool boolean{false};
+      double number{0.0};
+      std::string string{};
+      std::vector<std::string> keys{};  // objects only, parallel to items
+      std::vector<JsonValue> items{};
+
+      // glTF objects are small, a linear scan beats building a map per object
+      const JsonValue *find(const char *key) const {
+        if (type != Type::Object) {
+          return nullptr;
+        }
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+          if (keys[i] == key) {
+            return &items[i];
+          }
+        }
+        return nullptr;
+      }
+    };
+
+    class JsonParser {
+    public:
+      JsonParser(const char *begin, const char *end) : cursor{begin}, begin{begin}, end{end} {}
+
+      bool parse(JsonValue &out, std::string *outError) {
+        if (end - cursor >= 3 && std::memcmp(cursor, "\xEF\xBB\xBF", 3) == 0) {
+          cursor += 3;
+        }
+        bool valid = parseValue(out, 0);
+        if (valid) {
+          skipWhitespace();
+          valid = cursor == end;
+        }
+        if (!valid) {
+          setError(outError, "invalid JSON near byte " + std::to_string(cursor - begin));
+        }
+        return valid;
+      }
+
+    private:
+      void skipWhitespace() {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+          ++cursor;
+        }
+      }
+
+      bool consume(char c) {
+        skipWhitespace();
+        if (cursor < end && *cursor == c) {
+          ++cursor;
+          return true;
+        }
+        return false;
+      }
+
+      bool literal(const char *word) {
+        const std::size_t length = std::strlen(word);
+        if (static_cast<std::size_t>(end - cursor) < length || std::memcmp(cursor, word, length) != 0) {
+          return false;
+        }
+        cursor += length;
+        return true;
+      }
+
+      bool parseValue(JsonValue &out, int depth) {
+        skipWhitespace();
+        if (cursor == end || depth > kMaxJsonDepth) {
+          return false;
+        }
+        switch (*cursor) {
+          case '{': return parseObject(out, depth);
+          case '[': return parseArray(out, depth);
+          case '"': out.type = JsonValue::Type::String; return parseString(out.string);
+          case 't': out.type = JsonValue::Type::Bool; out.boolean = true; return literal("true");
+          case 'f': out.type = JsonValue::Type::Bool; out.boolean = false; return literal("false");
+          case 'n': out.type = JsonValue::Type::Null; return literal("null");
+          default: out.type = JsonValue::Type::Number; return parseNumber(out.number);
+        }
+      }
+
+      bool parseObject(JsonValue &out, int depth) {
+        ++cursor;
+        out.type = JsonValue::Type::Object;
+        if (consume('}')) {
+          return true;
+        }
+        do {
+          skipWhitespace();
+          std::string key;
+          if (cursor == end || *cursor != '"' || !parseString(key) || !consume(':')) {
+            return false;
+          }
+          out.keys.push_back(std::move(key));
+          out.items.emplace_back();
+          if (!parseValue(out.items.back(), depth + 1)) {
+            return false;
+          }
+        } while (consume(','));
+        return consume('}');
+      }
+
+      bool parseArray(JsonValue &out, int depth) {
+        ++cursor;
+        out.type = JsonValue::Type::Array;
+        if (consume(']')) {
+          return true;
+        }
+        do {
+          out.items.emplace_back();
+          if (!parseValue(out.items.back(), depth + 1)) {
+            return false;
+          }
+        } while (consume(','));
+        return consume(']');
+      }
+
+      bool parseHex4(std::uint32_t &out) {
+        if (end - cursor < 4) {
+          return false;
+        }
+        out = 0;
+        for (int i = 0; i < 4; ++i) {
+          const char c = *cursor++;
+          out <<= 4;
+          if (c >= '0' && c <= '9') out |= static_cast<std::uint32_t>(c - '0');
+          else if (c >= 'a' && c <= 'f') out |= static_cast<std::uint32_t>(c - 'a' + 10);
+          else if (c >= 'A' && c <= 'F') out |= static_cast<std::uint32_t>(c - 'A' + 10);
+          else return false;
+        }
+        return true;
+      }
+
+      static void appendUtf8(std::string &out, std::uint32_t code) {
+        if (code < 0x80) {
+          out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+          out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+          out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+          out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+          out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+          out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+          out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+          out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+          out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+          out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+      }
+
+      bool parseString(std::string &out) {
+        ++cursor;
+        while (cursor < end) {
+          const char c = *cursor++;
+          if (c == '"') {
+            return true;
+          }
+          if (c != '\\') {
+            out.push_back(c);
+            continue;
+          }
+          if (cursor == end) {
+            return false;
+          }
+          const char escape = *cursor++;
+          switch (escape) {
+            case '"':
+            case '\\':
+            case '/': out.push_back(escape); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+              std::uint32_t code = 0;
+              if (!parseHex4(code)) {
+                return false;
+              }
+              if (code >= 0xD800 && code < 0xDC00) {
+                std::uint32_t low = 0;
+                if (end - cursor < 2 || cursor[0] != '\\' || cursor[1] != 'u') {
+                  return false;
+                }
+                cursor += 2;
+                if (!parseHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                  return false;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+              }
+              appendUtf8(out, code);
+              break;
+            }
+            default: return false;
+          }
+        }
+        return false;
+      }
+
+      bool parseNumber(double &out) {
+        const char *start = cursor;
+        while (cursor < end && ((*cursor >= '0' && *cursor <= '9') || *cursor == '-' || *cursor == '+' ||
+                                *cursor == '.' || *cursor == 'e' || *cursor == 'E')) {
+          ++cursor;
+        }
+        // the mapped text is not null terminated
+        char buffer[64];
+        const std::size_t length = static_cast<std::size_t>(cursor - start);
+        if (length == 0 || length >= sizeof(buffer)) {
+          return false;
+        }
+        std::memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        char *parsed = nullptr;
+        out = std::strtod(buffer, &parsed);
+        return parsed == buffer + length;
+      }
+
+      const char *cursor;
+      const char *begin;
+      const char *end;
+    };
+
+    int intOf(const JsonValue *value, int fallback) {
+      return value && value->type == JsonValue::Type::Number ? static_cast<int>(value->number) : fallback;
+    }
+
+    double numberOf(const JsonValue *value, double fallback) {
+      return value && value->type == JsonValue::Type::Number ? value->number : fallback;
+    }
+
+    std::string stringOf(const JsonValue *value) {
+      return value && value->type == JsonValue::Type::String ? value->string : std::string{};
+    }
+
+    const JsonValue *arrayOf(const JsonValue &object, const char *key) {
+      const JsonValue *value = object.find(key);
+      return value && value->type == JsonValue::Type::Array ? value : nullptr;
+    }
+
+    const JsonValue *element(const JsonValue *array, int index) {
+      if (!array || index < 0 || static_cast<std::size_t>(index) >= array->items.size()) {
+        return nullptr;
+      }
+      return &array->items[static_cast<std::size_t>(index)];
+    }
+
+    void readNumbers(const JsonValue *array, float *out, std::size_t count) {
+      if (!array || array->type != JsonValue::Type::Array || array->items.size() < count) {
+        return;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        out[i] = static_cast<float>(numberOf(&array->items[i], out[i]));
+      }
+    }
+
+    bool isDataUri(const std::string &uri) {
+      return uri.compare(0, 5, "data:") == 0;
+    }
+
+    // data:[<mime>];base64,<payload>
+    bool decodeDataUri(const std::string &uri, std::vector<unsigned char> &out) {
+      const std::size_t comma = uri.find(',');
+      if (comma == std::string::npos || comma < 7 || uri.compare(comma - 7, 7, ";base64") != 0) {
+        return false;
+      }
+      auto sextet = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+      };
+      out.clear();
+      out.reserve((uri.size() - comma) / 4 * 3);
+      std::uint32_t accumulator = 0;
+      int bits = 0;
+      for (std::size_t i = comma + 1; i < uri.size() && uri[i] != '='; ++i) {
+        const int value = sextet(uri[i]);
+        if (value < 0) {
+          return false;
+        }
+        accumulator = (accumulator << 6) | static_cast<std::uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+          bits -= 8;
+          out.push_back(static_cast<unsigned char>(accumulator >> bits));
+          accumulator &= (1u << bits) - 1;
+        }
+      }
+      return true;
+    }
+
+    // relative uris are percent encoded and resolve against the file's directory
+    std::string resolveUri(const std::filesystem::path &baseDir, const std::string &uri) {
+      std::string decoded;
+      decoded.reserve(uri.size());
+      for (std::size_t i = 0; i < uri.size(); ++i) {
+        if (uri[i] == '%' && i + 2 < uri.size()) {
+          const std::string hex = uri.substr(i + 1, 2);
+          char *parsed = nullptr;
+          const long value = std::strtol(hex.c_str(), &parsed, 16);
+          if (parsed == hex.c_str() + 2) {
+            decoded.push_back(static_cast<char>(value));
+            i += 2;
+            continue;
+          }
+        }
+        decoded.push_back(uri[i]);
+      }
+      std::filesystem::path path{decoded};
+      if (path.is_relative()) {
+        path = baseDir / path;
+      }
+      return path.generic_string();
+    }
+
+    struct GltfBuffer {
+      const unsigned char *data{nullptr};
+      std::size_t size{0};
+    };
+
+    struct GltfBufferView {
+      std::size_t buffer{0};
+      std::size_t offset{0};
+      std::size_t length{0};
+      std::size_t stride{0};
+    };
+
+    // buffers point into the mapped files or the decoded data uris, all owned here
+    struct GltfDocument {
+      JsonValue json{};
+      std::filesystem::path baseDir{};
+      MappedFile file{};
+      std::vector<MappedFile> externalFiles{};
+      std::vector<std::vector<unsigned char>> decodedBuffers{};
+      std::vector<GltfBuffer> buffers{};
+      std::vector<GltfBufferView> bufferViews{};
+    };
+
+    bool loadBuffers(GltfDocument &doc, GltfBuffer glbBinary, std::string *outError) {
+      const JsonValue *buffers = arrayOf(doc.json, "buffers");
+      const std::size_t bufferCount = buffers ? buffers->items.size() : 0;
+      for (std::size_t i = 0; i < bufferCount; ++i) {
+        const JsonValue &buffer = buffers->items[i];
+        const double byteLength = numberOf(buffer.find("byteLength"), -1.0);
+        const JsonValue *uri = buffer.find("uri");
+        GltfBuffer resolved{};
+        if (!uri) {
+          // only the first buffer of a .glb may leave out its uri, it is the BIN chunk
+          if (i != 0 || !glbBinary.data) {
+            setError(outError, "buffer " + std::to_string(i) + " has no data");
+            return false;
+          }
+          resolved = glbBinary;
+        } else if (isDataUri(uri->string)) {
+          std::vector<unsigned char> decoded;
+          if (!decodeDataUri(uri->string, decoded)) {
+            setError(outError, "buffer " + std::to_string(i) + " has an invalid data uri");
+            return false;
+          }
+          resolved = {decoded.data(), decoded.size()};
+          doc.decodedBuffers.push_back(std::move(decoded));
+        } else {
+          MappedFile mapped;
+          if (!mapped.open(resolveUri(doc.baseDir, uri->string), outError)) {
+            return false;
+          }
+          resolved = {mapped.data(), mapped.size()};
+          doc.externalFiles.push_back(std::move(mapped));
+        }
+        if (byteLength < 0.0 || static_cast<double>(resolved.size) < byteLength) {
+          setError(outError, "buffer " + std::to_string(i) + " is shorter than its byteLength");
+          return false;
+        }
+        resolved.size = static_cast<std::size_t>(byteLength);
+        doc.buffers.push_back(resolved);
+      }
+
+      const JsonValue *views = arrayOf(doc.json, "bufferViews");
+      const std::size_t viewCount = views ? views->items.size() : 0;
+      doc.bufferViews.reserve(viewCount);
+      for (std::size_t i = 0; i < viewCount; ++i) {
+        const JsonValue &view = views->items[i];
+        GltfBufferView resolved{};
+        const int buffer = intOf(view.find("buffer"), -1);
+        const double offset = numberOf(view.find("byteOffset"), 0.0);
+        const double length = numberOf(view.find("byteLength"), -1.0);
+        if (buffer < 0 || static_cast<std::size_t>(buffer) >= doc.buffers.size() || offset < 0.0 || length < 0.0 ||
+            offset + length > static_cast<double>(doc.buffers[static_cast<std::size_t>(buffer)].size)) {
+          setError(outError, "buffer view " + std::to_string(i) + " is out of range");
+          return false;
+        }
+        resolved.buffer = static_cast<std::size_t>(buffer);
+        resolved.offset = static_cast<std::size_t>(offset);
+        resolved.length = static_cast<std::size_t>(length);
+        resolved.stride = static_cast<std::size_t>(std::max(0, intOf(view.find("byteStride"), 0)));
+        doc.bufferViews.push_back(resolved);
+      }
+      return true;
+    }
+
+    struct AccessorView {
+      const unsigned char *data{nullptr};  // accessors without a buffer view read as zeros
+      std::size_t count{0};
+      std::size_t stride{0};
+      int componentType{0};
+      int components{0};
+      bool normalized{false};
+    };
+
+    std::size_t componentSize(int componentType) {
+      switch (componentType) {
+        case kComponentByte:
+        case kComponentUnsignedByte: return 1;
+        case kComponentShort:
+        case kComponentUnsignedShort: return 2;
+        case kComponentUnsignedInt:
+        case kComponentFloat: return 4;
+        default: return 0;
+      }
+    }
+
+    int componentCount(const std::string &type) {
+      if (type == "SCALAR") return 1;
+      if (type == "VEC2") return 2;
+      if (type == "VEC3") return 3;
+      if (type == "VEC4" || type == "MAT2") return 4;
+      if (type == "MAT3") return 9;
+      if (type == "MAT4") return 16;
+      return 0;
+    }
+
+    bool resolveAccessor(const GltfDocument &doc, int index, AccessorView &out, std::string *outError) {
+      const JsonValue *accessor = element(arrayOf(doc.json, "accessors"), index);
+      if (!accessor) {
+        setError(outError, "accessor " + std::to_string(index) + " does not exist");
+        return false;
+      }
+      if (accessor->find("sparse")) {
+        setError(outError, "sparse accessors are not supported");
+        return false;
+      }
+      out.count = static_cast<std::size_t>(std::max(0.0, numberOf(accessor->find("count"), 0.0)));
+      out.componentType = intOf(accessor->find("componentType"), 0);
+      out.components = componentCount(stringOf(accessor->find("type")));
+      const JsonValue *normalized = accessor->find("normalized");
+      out.normalized = normalized && normalized->type == JsonValue::Type::Bool && normalized->boolean;
+      const std::size_t elementSize = componentSize(out.componentType) * static_cast<std::size_t>(out.components);
+      if (elementSize == 0) {
+        setError(outError, "accessor " + std::to_string(index) + " has an unknown type");
+        return false;
+      }
+
+      const JsonValue *viewIndex = accessor->find("bufferView");
+      if (!viewIndex) {
+        out.data = nullptr;
+        out.stride = elementSize;
+        return true;
+      }
+      const int view = intOf(viewIndex, -1);
+      if (view < 0 || static_cast<std::size_t>(view) >= doc.bufferViews.size()) {
+        setError(outError, "accessor " + std::to_string(index) + " uses a missing buffer view");
+        return false;
+      }
+      const GltfBufferView &bufferView = doc.bufferViews[static_cast<std::size_t>(view)];
+      const std::size_t offset = static_cast<std::size_t>(std::max(0.0, numberOf(accessor->find("byteOffset"), 0.0)));
+      out.stride = bufferView.stride ? bufferView.stride : elementSize;
+      if (out.count > 0 &&
+          (offset > bufferView.length || bufferView.length - offset < elementSize ||
+           (out.count - 1) > (bufferView.length - offset - elementSize) / out.stride)) {
+        setError(outError, "accessor " + std::to_string(index) + " exceeds its buffer view");
+        return false;
+      }
+      out.data = doc.buffers[bufferView.buffer].data + bufferView.offset + offset;
+      return true;
+    }
+
+    // element i as floats, normalized integers map to [0, 1] or [-1, 1]; missing components are left alone
+    void readFloats(const AccessorView &view, std::size_t i, float *out, int count) {
+      const int components = std::min(count, view.components);
+      if (!view.data) {
+        std::fill(out, out + components, 0.f);
+        return;
+      }
+      const unsigned char *source = view.data + i * view.stride;
+      if (view.componentType == kComponentFloat) {
+        std::memcpy(out, source, static_cast<std::size_t>(components) * sizeof(float));
+        return;
+      }
+      for (int c = 0; c < components; ++c) {
+        switch (view.componentType) {
+          case kComponentByte: {
+            const float value = static_cast<float>(static_cast<std::int8_t>(source[c]));
+            out[c] = view.normalized ? std::max(value / 127.f, -1.f) : value;
+            break;
+          }
+          case kComponentUnsignedByte: {
+            const float value = static_cast<float>(source[c]);
+            out[c] = view.normalized ? value / 255.f : value;
+            break;
+          }
+          case kComponentShort: {
+            std::int16_t raw = 0;
+            std::memcpy(&raw, source + c * 2, sizeof(raw));
+            const float value = static_cast<float>(raw);
+            out[c] = view.normalized ? std::max(value / 32767.f, -1.f) : value;
+            break;
+          }
+          case kComponentUnsignedShort: {
+            std::uint16_t raw = 0;
+            std::memcpy(&raw, source + c * 2, sizeof(raw));
+            const float value = static_cast<float>(raw);
+            out[c] = view.normalized ? value / 65535.f : value;
+            break;
+          }
+          case kComponentUnsignedInt: {
+            std::uint32_t raw = 0;
+            std::memcpy(&raw, source + c * 4, sizeof(raw));
+            out[c] = static_cast<float>(raw);
+            break;
+          }
+          default: break;
+        }
+      }
+    }
+
+    std::uint32_t readIndex(const AccessorView &view, std::size_t i) {
+      if (!view.data) {
+        return 0;
+      }
+      const unsigned char *source = view.data + i * view.stride;
+      switch (view.componentType) {
+        case kComponentUnsignedByte: return source[0];
+        case kComponentUnsignedShort: {
+          std::uint16_t value = 0;
+          std::memcpy(&value, source, sizeof(value));
+          return value;
+        }
+        default: {
+          std::uint32_t value = 0;
+          std::memcpy(&value, source, sizeof(value));
+          return value;
+        }
+      }
+    }
+
+    struct PositionKey {
+      std::uint32_t bits[3];
+      bool operator==(const PositionKey &other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+      }
+    };
+
+    struct PositionKeyHash {
+      std::size_t operator()(const PositionKey &key) const {
+        std::uint64_t hash = 0x9E3779B97F4A7C15ull;
+        for (std::uint32_t bits : key.bits) {
+          hash = (hash ^ bits) * 0xFF51AFD7ED558CCDull;
+          hash ^= hash >> 29;
+        }
+        return static_cast<std::size_t>(hash);
+      }
+    };
+
+    // area weighted, vertices sharing a position share the normal so uv seams stay smooth
+    void generateSmoothNormals(
+      backend::ModelVertex *vertices,
+      std::size_t vertexCount,
+      const std::uint32_t *indices,
+      std::size_t indexCount) {
+      std::vector<std::uint32_t> canonical(vertexCount);
+      std::unordered_map<PositionKey, std::uint32_t, PositionKeyHash> firstAtPosition;
+      firstAtPosition.reserve(vertexCount);
+      for (std::size_t i = 0; i < vertexCount; ++i) {
+        PositionKey key{};
+        for (int c = 0; c < 3; ++c) {
+          const float value = vertices[i].position[c] + 0.f;
+          std::memcpy(&key.bits[c], &value, sizeof(float));
+        }
+        canonical[i] = firstAtPosition.emplace(key, static_cast<std::uint32_t>(i)).first->second;
+      }
+
+      std::vector<glm::vec3> sums(vertexCount, glm::vec3{0.f});
+      for (std::size_t i = 0; i + 2 < indexCount; i += 3) {
+        const glm::vec3 &p0 = vertices[indices[i]].position;
+        const glm::vec3 &p1 = vertices[indices[i + 1]].position;
+        const glm::vec3 &p2 = vertices[indices[i + 2]].position;
+        const glm::vec3 areaNormal = glm::cross(p1 - p0, p2 - p0);
+        sums[canonical[indices[i]]] += areaNormal;
+        sums[canonical[indices[i + 1]]] += areaNormal;
+        sums[canonical[indices[i + 2]]] += areaNormal;
+      }
+      for (std::size_t i = 0; i < vertexCount; ++i) {
+        const glm::vec3 &sum = sums[canonical[i]];
+        const float length = glm::length(sum);
+        vertices[i].normal = length > 0.f ? sum / length : glm::vec3{0.f, 0.f, 1.f};
+      }
+    }
+
+    // glTF asks for flat normals when a primitive has none, which needs a vertex per corner
+    void generateFlatNormals(backend::ModelData &data, std::size_t vertexStart, std::size_t indexStart) {
+      std::vector<backend::ModelVertex> corners;
+      corners.reserve(data.indices.size() - indexStart);
+      for (std::size_t i = indexStart; i < data.indices.size(); ++i) {
+        corners.push_back(data.vertices[vertexStart + data.indices[i]]);
+        data.indices[i] = static_cast<std::uint32_t>(i - indexStart);
+      }
+      for (std::size_t i = 0; i + 2 < corners.size(); i += 3) {
+        const glm::vec3 areaNormal =
+          glm::cross(corners[i + 1].position - corners[i].position, corners[i + 2].position - corners[i].position);
+        const float length = glm::length(areaNormal);
+        const glm::vec3 normal = length > 0.f ? areaNormal / length : glm::vec3{0.f, 0.f, 1.f};
+        corners[i].normal = normal;
+        corners[i + 1].normal = normal;
+        corners[i + 2].normal = normal;
+      }
+      data.vertices.resize(vertexStart);
+      data.vertices.insert(data.vertices.end(), corners.begin(), corners.end());
+    }
+
+    // per-vertex frames along +U and +V of the final uvs, degenerate mappings keep a zero tangent
+    void generateTangents(
+      const backend::ModelVertex *vertices,
+      glm::vec4 *outTangents,
+      std::size_t vertexCount,
+      const std::uint32_t *indices,
+      std::size_t indexCount) {
+      std::vector<glm::vec3> tangents(vertexCount, glm::vec3{0.f});
+      std::vector<glm::vec3> bitangents(vertexCount, glm::vec3{0.f});
+      for (std::size_t i = 0; i + 2 < indexCount; i += 3) {
+        const backend::ModelVertex &v0 = vertices[indices[i]];
+        const backend::ModelVertex &v1 = vertices[indices[i + 1]];
+        const backend::ModelVertex &v2 = vertices[indices[i + 2]];
+        const glm::vec3 edge1 = v1.position - v0.position;
+        const glm::vec3 edge2 = v2.position - v0.position;
+        const glm::vec2 duv1 = v1.uv - v0.uv;
+        const glm::vec2 duv2 = v2.uv - v0.uv;
+        const float determinant = duv1.x * duv2.y - duv2.x * duv1.y;
+        if (!(std::fabs(determinant) > 1e-20f)) {
+          continue;
+        }
+        const float inverse = 1.f / determinant;
+        const glm::vec3 tangent = (edge1 * duv2.y - edge2 * duv1.y) * inverse;
+        const glm::vec3 bitangent = (edge2 * duv1.x - edge1 * duv2.x) * inverse;
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+          tangents[indices[i + corner]] += tangent;
+          bitangents[indices[i + corner]] += bitangent;
+        }
+      }
+      for (std::size_t i = 0; i < vertexCount; ++i) {
+        const glm::vec3 &normal = vertices[i].normal;
+        const glm::vec3 tangent = tangents[i] - normal * glm::dot(normal, tangents[i]);
+        if (!(glm::dot(tangent, tangent) > 1e-12f)) {
+          continue;
+        }
+        const float handedness = glm::dot(glm::cross(normal, tangent), bitangents[i]) < 0.f ? -1.f : 1.f;
+        outTangents[i] = glm::vec4(glm::normalize(tangent), handedness);
+      }
+    }
+
+    // appends the primitive's vertices and triangles; points and lines set outSkipped
+    bool processPrimitive(
+      const GltfDocument &doc,
+      const JsonValue &primitive,
+      const ModelImportSettings &settings,
+      const std::vector<glm::vec3> &materialColors,
+      backend::ModelData &data,
+      backend::ModelSubMesh &outSubMesh,
+      bool &outSkipped,
+      std::string *outError) {
+      outSkipped = false;
+      const int mode = intOf(primitive.find("mode"), kModeTriangles);
+      const JsonValue *attributes = primitive.find("attributes");
+      const JsonValue *positionIndex = attributes ? attributes->find("POSITION") : nullptr;
+      if ((mode != kModeTriangles && mode != kModeTriangleStrip && mode != kModeTriangleFan) || !positionIndex) {
+        outSkipped = true;
+        return true;
+      }
+
+      AccessorView positions{};
+      if (!resolveAccessor(doc, intOf(positionIndex, -1), positions, outError)) {
+        return false;
+      }
+      if (positions.components != 3) {
+        setError(outError, "POSITION must be a VEC3 accessor");
+        return false;
+      }
+      const std::size_t vertexCount = positions.count;
+      // readFloats leaves missing components alone, so a short accessor would pick up stale values
+      auto optionalAttribute = [&](const char *name, int minComponents, int maxComponents, AccessorView &out,
+                                   bool &present) {
+        const JsonValue *index = attributes->find(name);
+        present = index != nullptr;
+        if (!present) {
+          return true;
+        }
+        if (!resolveAccessor(doc, intOf(index, -1), out, outError)) {
+          return false;
+        }
+        if (out.count != vertexCount) {
+          setError(outError, std::string{name} + " and POSITION differ in count");
+          return false;
+        }
+        if (out.components < minComponents || out.components > maxComponents) {
+          setError(outError, std::string{name} + " has an unexpected accessor type");
+          return false;
+        }
+        return true;
+      };
+      AccessorView normals{};
+      AccessorView uvs{};
+      AccessorView colors{};
+      AccessorView tangents{};
+      bool hasNormals = false;
+      bool hasUvs = false;
+      bool hasColors = false;
+      bool hasTangents = false;
+      if (!optionalAttribute("NORMAL", 3, 3, normals, hasNormals) ||
+          !optionalAttribute("TEXCOORD_0", 2, 2, uvs, hasUvs) ||
+          !optionalAttribute("COLOR_0", 3, 4, colors, hasColors) ||
+          !optionalAttribute("TANGENT", 4, 4, tangents, hasTangents)) {
+        return false;
+      }
+
+      AccessorView indexView{};
+      const JsonValue *indicesIndex = primitive.find("indices");
+      const bool indexed = indicesIndex != nullptr;
+      if (indexed) {
+        if (!resolveAccessor(doc, intOf(indicesIndex, -1), indexView, outError)) {
+          return false;
+        }
+        if (indexView.components != 1 || indexView.componentType == kComponentFloat ||
+            indexView.componentType == kComponentByte || indexView.componentType == kComponentShort) {
+          setError(outError, "indices must be unsigned integer scalars");
+          return false;
+        }
+      }
+
+      const int materialIndex = intOf(primitive.find("material"), -1);
+      glm::vec3 materialColor{1.f, 1.f, 1.f};
+      if (materialIndex >= 0 && static_cast<std::size_t>(materialIndex) < materialColors.size()) {
+        materialColor = materialColors[static_cast<std::size_t>(materialIndex)];
+      }
+
+      const std::size_t vertexStart = data.vertices.size();
+      const std::size_t indexStart = data.indices.size();
+      data.vertices.resize(vertexStart + vertexCount);
+      backend::ModelVertex *vertices = data.vertices.data() + vertexStart;
+      float values[4];
+      for (std::size_t i = 0; i < vertexCount; ++i) {
+        readFloats(positions, i, values, 3);
+        vertices[i].position = {values[0], values[1], values[2]};
+      }
+      if (hasNormals && !settings.generateNormals) {
+        for (std::size_t i = 0; i < vertexCount; ++i) {
+          readFloats(normals, i, values, 3);
+          vertices[i].normal = {values[0], values[1], values[2]};
+        }
+      }
+      // glTF already has Vulkan's top-left uv origin
+      if (hasUvs) {
+        for (std::size_t i = 0; i < vertexCount; ++i) {
+          readFloats(uvs, i, values, 2);
+          vertices[i].uv = {values[0], settings.flipUV ? 1.f - values[1] : values[1]};
+        }
+      }
+      if (hasColors) {
+        for (std::size_t i = 0; i < vertexCount; ++i) {
+          readFloats(colors, i, values, 3);
+          vertices[i].color = {values[0], values[1], values[2]};
+        }
+      } else {
+        for (std::size_t i = 0; i < vertexCount; ++i) {
+          vertices[i].color = materialColor;
+        }
+      }
+
+      const std::size_t cornerCount = indexed ? indexView.count : vertexCount;
+      bool indicesInRange = true;
+      auto corner = [&](std::size_t i) {
+        const std::uint32_t index = indexed ? readIndex(indexView, i) : static_cast<std::uint32_t>(i);
+        indicesInRange = indicesInRange && index < vertexCount;
+        return index;
+      };
+      if (mode == kModeTriangles) {
+        const std::size_t triangleCorners = cornerCount - cornerCount % 3;
+        data.indices.resize(indexStart + triangleCorners);
+        std::uint32_t *out = data.indices.data() + indexStart;
+        for (std::size_t i = 0; i < triangleCorners; ++i) {
+          out[i] = corner(i);
+        }
+      } else {
+        data.indices.reserve(indexStart + (cornerCount > 2 ? (cornerCount - 2) * 3 : 0));
+        for (std::size_t i = 0; i + 2 < cornerCount; ++i) {
+          std::uint32_t a = mode == kModeTriangleFan ? corner(0) : corner(i);
+          std::uint32_t b = corner(i + 1);
+          const std::uint32_t c = corner(i + 2);
+          // every other strip triangle is wound the other way round
+          if (mode == kModeTriangleStrip && (i & 1) != 0) {
+            std::swap(a, b);
+          }
+          data.indices.push_back(a);
+          data.indices.push_back(b);
+          data.indices.push_back(c);
+        }
+      }
+      if (!indicesInRange) {
+        setError(outError, "index out of range for the primitive's vertices");
+        return false;
+      }
+      // what Assimp's FindDegenerates removes under this profile
+      if (settings.profile == ModelImportProfile::Optimize) {
+        std::size_t write = indexStart;
+        for (std::size_t i = indexStart; i + 2 < data.indices.size(); i += 3) {
+          const glm::vec3 &p0 = vertices[data.indices[i]].position;
+          const glm::vec3 &p1 = vertices[data.indices[i + 1]].position;
+          const glm::vec3 &p2 = vertices[data.indices[i + 2]].position;
+          if (p0 == p1 || p1 == p2 || p0 == p2) {
+            continue;
+          }
+          data.indices[write++] = data.indices[i];
+          data.indices[write++] = data.indices[i + 1];
+          data.indices[write++] = data.indices[i + 2];
+        }
+        data.indices.resize(write);
+      }
+
+      if (settings.generateNormals) {
+        generateSmoothNormals(vertices, vertexCount, data.indices.data() + indexStart, data.indices.size() - indexStart);
+      } else if (!hasNormals) {
+        generateFlatNormals(data, vertexStart, indexStart);
+      }
+      // flat normals may have grown the range
+      vertices = data.vertices.data() + vertexStart;
+      const std::size_t finalVertexCount = data.vertices.size() - vertexStart;
+
+      if (settings.generateTangents && hasUvs) {
+        // earlier primitives without tangents get zero entries
+        data.tangents.resize(vertexStart + finalVertexCount);
+        glm::vec4 *outTangents = data.tangents.data() + vertexStart;
+        if (hasTangents && finalVertexCount == vertexCount) {
+          for (std::size_t i = 0; i < vertexCount; ++i) {
+            values[3] = 1.f;
+            readFloats(tangents, i, values, 4);
+            const glm::vec3 &normal = vertices[i].normal;
+            glm::vec3 tangent{values[0], values[1], values[2]};
+            tangent = tangent - normal * glm::dot(normal, tangent);
+            if (!(glm::dot(tangent, tangent) > 1e-12f)) {
+              continue;
+            }
+            // flipping V mirrors the bitangent
+            const float handedness = (values[3] < 0.f) != settings.flipUV ? -1.f : 1.f;
+            outTangents[i] = glm::vec4(glm::normalize(tangent), handedness);
+          }
+        } else {
+          generateTangents(
+            vertices, outTangents, finalVertexCount, data.indices.data() + indexStart, data.indices.size() - indexStart);
+        }
+      }
+
+      const std::uint32_t base = static_cast<std::uint32_t>(vertexStart);
+      for (std::size_t i = indexStart; i < data.indices.size(); ++i) {
+        data.indices[i] += base;
+      }
+
+      outSubMesh.firstIndex = static_cast<std::uint32_t>(indexStart);
+      outSubMesh.indexCount = static_cast<std::uint32_t>(data.indices.size() - indexStart);
+      outSubMesh.materialIndex = materialIndex;
+      outSubMesh.hasBounds = finalVertexCount > 0;
+      if (outSubMesh.hasBounds) {
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        for (std::size_t i = 0; i < finalVertexCount; ++i) {
+          boundsMin = glm::min(boundsMin, vertices[i].position);
+          boundsMax = glm::max(boundsMax, vertices[i].position);
+        }
+        outSubMesh.boundsMin = boundsMin;
+        outSubMesh.boundsMax = boundsMax;
+      }
+      return true;
+    }
+
+    backend::ModelTextureSource loadTextureSource(const GltfDocument &doc, const JsonValue *textureInfo) {
+      backend::ModelTextureSource source{};
+      if (!textureInfo) {
+        return source;
+      }
+      const JsonValue *texture = element(arrayOf(doc.json, "textures"), intOf(textureInfo->find("index"), -1));
+      const JsonValue *image = texture ? element(arrayOf(doc.json, "images"), intOf(texture->find("source"), -1)) : nullptr;
+      if (!image) {
+        return source;
+      }
+
+      const JsonValue *uri = image->find("uri");
+      if (uri && uri->type == JsonValue::Type::String) {
+        if (isDataUri(uri->string)) {
+          if (decodeDataUri(uri->string, source.data)) {
+            source.kind = backend::ModelTextureSource::Kind::EmbeddedCompressed;
+          }
+          return source;
+        }
+        source.kind = backend::ModelTextureSource::Kind::File;
+        source.path = resolveUri(doc.baseDir, uri->string);
+        return source;
+      }
+
+      const int view = intOf(image->find("bufferView"), -1);
+      if (view >= 0 && static_cast<std::size_t>(view) < doc.bufferViews.size()) {
+        const GltfBufferView &bufferView = doc.bufferViews[static_cast<std::size_t>(view)];
+        const unsigned char *bytes = doc.buffers[bufferView.buffer].data + bufferView.offset;
+        source.kind = backend::ModelTextureSource::Kind::EmbeddedCompressed;
+        source.data.assign(bytes, bytes + bufferView.length);
+      }
+      return source;
+    }
+
+    // TRS is applied as T * R * S, rotation is an xyzw quaternion
+    glm::mat4 nodeTransform(const JsonValue &node) {
+      glm::mat4 transform{1.f};
+      const JsonValue *matrix = node.find("matrix");
+      if (matrix && matrix->type == JsonValue::Type::Array && matrix->items.size() == 16) {
+        for (int column = 0; column < 4; ++column) {
+          for (int row = 0; row < 4; ++row) {
+            transform[column][row] = static_cast<float>(numberOf(&matrix->items[column * 4 + row], 0.0));
+          }
+        }
+        return transform;
+      }
+
+      float translation[3] = {0.f, 0.f, 0.f};
+      float rotation[4] = {0.f, 0.f, 0.f, 1.f};
+      float scale[3] = {1.f, 1.f, 1.f};
+      readNumbers(node.find("translation"), translation, 3);
+      readNumbers(node.find("rotation"), rotation, 4);
+      readNumbers(node.find("scale"), scale, 3);
+      const float x = rotation[0];
+      const float y = rotation[1];
+      const float z = rotation[2];
+      const float w = rotation[3];
+      transform[0] = glm::vec4(
+        glm::vec3{1.f - 2.f * (y * y + z * z), 2.f * (x * y + z * w), 2.f * (x * z - y * w)} * scale[0], 0.f);
+      transform[1] = glm::vec4(
+        glm::vec3{2.f * (x * y - z * w), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + x * w)} * scale[1], 0.f);
+      transform[2] = glm::vec4(
+        glm::vec3{2.f * (x * z + y * w), 2.f * (y * z - x * w), 1.f - 2.f * (x * x + y * y)} * scale[2], 0.f);
+      transform[3] = glm::vec4(translation[0], translation[1], translation[2], 1.f);
+      return transform;
+    }
+
+    void processNode(
+      const GltfDocument &doc,
+      int gltfIndex,
+      int parentIndex,
+      const std::vector<std::vector<int>> &meshSubMeshes,
+      std::vector<char> &visited,
+      backend::ModelData &data) {
+      const JsonValue *node = element(arrayOf(doc.json, "nodes"), gltfIndex);
+      // the node graph must be a forest, anything reached twice is ignored
+      if (!node || visited[static_cast<std::size_t>(gltfIndex)]) {
+        return;
+      }
+      visited[static_cast<std::size_t>(gltfIndex)] = 1;
+
+      backend::ModelNode newNode{};
+      newNode.name = stringOf(node->find("name"));
+      newNode.parent = parentIndex;
+      newNode.localTransform = nodeTransform(*node);
+      const int mesh = intOf(node->find("mesh"), -1);
+      if (mesh >= 0 && static_cast<std::size_t>(mesh) < meshSubMeshes.size()) {
+        newNode.meshes = meshSubMeshes[static_cast<std::size_t>(mesh)];
+      }
+
+      const int nodeIndex = static_cast<int>(data.nodes.size());
+      data.nodes.push_back(std::move(newNode));
+      if (parentIndex >= 0) {
+        data.nodes[static_cast<std::size_t>(parentIndex)].children.push_back(nodeIndex);
+      }
+
+      if (const JsonValue *children = arrayOf(*node, "children")) {
+        for (const JsonValue &child : children->items) {
+          processNode(doc, intOf(&child, -1), nodeIndex, meshSubMeshes, visited, data);
+        }
+      }
+    }
+  } // namespace
+
+  bool loadModelDataFromGltf(
+    const std::string &resolvedPath,
+    const ModelImportSettings &settings,
+    backend::ModelData &outData,
+    std::string *outError) {
+    GltfDocument doc{};
+    if (!doc.file.open(resolvedPath, outError)) {
+      return false;
+    }
+    doc.baseDir = std::filesystem::path(resolvedPath).parent_path();
+
+    const unsigned char *bytes = doc.file.data();
+    const char *jsonBegin = reinterpret_cast<const char *>(bytes);
+    const char *jsonEnd = jsonBegin + doc.file.size();
+    GltfBuffer glbBinary{};
+    if (doc.file.size() >= 12 && get32(bytes) == kGlbMagic) {
+      if (get32(bytes + 4) != 2) {
+        setError(outError, "unsupported GLB container version");
+        return false;
+      }
+      const std::size_t length = std::min<std::size_t>(get32(bytes + 8), doc.file.size());
+      jsonBegin = nullptr;
+      std::size_t offset = 12;
+      while (offset + 8 <= length) {
+        const std::size_t chunkLength = get32(bytes + offset);
+        const std::uint32_t chunkType = get32(bytes + offset + 4);
+        offset += 8;
+        if (chunkLength > length - offset) {
+          setError(outError, "truncated GLB chunk");
+          return false;
+        }
+        if (chunkType == kGlbChunkJson && !jsonBegin) {
+          jsonBegin = reinterpret_cast<const char *>(bytes + offset);
+          jsonEnd = jsonBegin + chunkLength;
+        } else if (chunkType == kGlbChunkBin && !glbBinary.data) {
+          glbBinary = {bytes + offset, chunkLength};
+        }
+        offset += chunkLength;
+      }
+      if (!jsonBegin) {
+        setError(outError, "GLB file without a JSON chunk");
+        return false;
+      }
+      // the JSON chunk is padded with spaces, the BIN chunk with zeros
+    }
+
+    JsonParser parser{jsonBegin, jsonEnd};
+    if (!parser.parse(doc.json, outError)) {
+      return false;
+    }
+    const JsonValue *asset = doc.json.find("asset");
+    if (!asset || stringOf(asset->find("version")).compare(0, 2, "2.") != 0) {
+      setError(outError, "not a glTF 2.0 asset");
+      return false;
+    }
+    if (const JsonValue *required = arrayOf(doc.json, "extensionsRequired"); required && !required->items.empty()) {
+      setError(outError, "requires extension " + stringOf(&required->items.front()));
+      return false;
+    }
+    if (!loadBuffers(doc, glbBinary, outError)) {
+      return false;
+    }
+
+    outData.vertices.clear();
+    outData.tangents.clear();
+    outData.indices.clear();
+    outData.subMeshes.clear();
+    outData.nodes.clear();
+    outData.materials.clear();
+    outData.vertexFormat = settings.vertexFormat;
+
+    const JsonValue *materials = arrayOf(doc.json, "materials");
+    const std::size_t materialCount = materials ? materials->items.size() : 0;
+    std::vector<glm::vec3> materialColors(materialCount, glm::vec3{1.f, 1.f, 1.f});
+    outData.materials.resize(materialCount);
+    for (std::size_t i = 0; i < materialCount; ++i) {
+      const JsonValue *pbr = materials->items[i].find("pbrMetallicRoughness");
+      if (!pbr) {
+        continue;
+      }
+      float baseColor[4] = {1.f, 1.f, 1.f, 1.f};
+      readNumbers(pbr->find("baseColorFactor"), baseColor, 4);
+      materialColors[i] = {baseColor[0], baseColor[1], baseColor[2]};
+      outData.materials[i].diffuse = loadTextureSource(doc, pbr->find("baseColorTexture"));
+    }
+
+    // one growth of the big arrays instead of one per primitive
+    const JsonValue *meshes = arrayOf(doc.json, "meshes");
+    const std::size_t meshCount = meshes ? meshes->items.size() : 0;
+    std::size_t expectedVertices = 0;
+    std::size_t expectedIndices = 0;
+    for (std::size_t m = 0; m < meshCount; ++m) {
+      const JsonValue *primitives = arrayOf(meshes->items[m], "primitives");
+      for (std::size_t p = 0; primitives && p < primitives->items.size(); ++p) {
+        const JsonValue &primitive = primitives->items[p];
+        const JsonValue *attributes = primitive.find("attributes");
+        const JsonValue *accessors = arrayOf(doc.json, "accessors");
+        const JsonValue *position =
+          attributes ? element(accessors, intOf(attributes->find("POSITION"), -1)) : nullptr;
+        const JsonValue *indices = element(accessors, intOf(primitive.find("indices"), -1));
+        const double vertexCount = position ? numberOf(position->find("count"), 0.0) : 0.0;
+        expectedVertices += static_cast<std::size_t>(std::max(0.0, vertexCount));
+        expectedIndices += static_cast<std::size_t>(std::max(0.0, indices ? numberOf(indices->find("count"), 0.0) : vertexCount));
+      }
+    }
+    outData.vertices.reserve(expectedVertices);
+    outData.indices.reserve(expectedIndices);
+
+    std::vector<std::vector<int>> meshSubMeshes(meshCount);
+    for (std::size_t m = 0; m < meshCount; ++m) {
+      const JsonValue *primitives = arrayOf(meshes->items[m], "primitives");
+      for (std::size_t p = 0; primitives && p < primitives->items.size(); ++p) {
+        backend::ModelSubMesh subMesh{};
+        bool skipped = false;
+        if (!processPrimitive(doc, primitives->items[p], settings, materialColors, outData, subMesh, skipped, outError)) {
+          return false;
+        }
+        if (!skipped) {
+          meshSubMeshes[m].push_back(static_cast<int>(outData.subMeshes.size()));
+          outData.subMeshes.push_back(subMesh);
+        }
+      }
+    }
+    // later primitives without tangents get zero entries too
+    if (!outData.tangents.empty()) {
+      outData.tangents.resize(outData.vertices.size());
+    }
+
+    // the scene's roots hang off one root node, which also carries the import scale
+    const JsonValue *nodes = arrayOf(doc.json, "nodes");
+    const std::size_t nodeCount = nodes ? nodes->items.size() : 0;
+    const JsonValue *scene = element(arrayOf(doc.json, "scenes"), intOf(doc.json.find("scene"), 0));
+    std::vector<int> roots;
+    if (const JsonValue *sceneNodes = scene ? arrayOf(*scene, "nodes") : nullptr) {
+      for (const JsonValue &root : sceneNodes->items) {
+        roots.push_back(intOf(&root, -1));
+      }
+    } else {
+      std::vector<char> isChild(nodeCount, 0);
+      for (std::size_t n = 0; n < nodeCount; ++n) {
+        if (const JsonValue *children = arrayOf(nodes->items[n], "children")) {
+          for (const JsonValue &child : children->items) {
+            const int childIndex = intOf(&child, -1);
+            if (childIndex >= 0 && static_cast<std::size_t>(childIndex) < nodeCount) {
+              isChild[static_cast<std::size_t>(childIndex)] = 1;
+            }
+          }
+        }
+      }
+      for (std::size_t n = 0; n < nodeCount; ++n) {
+        if (!isChild[n]) {
+          roots.push_back(static_cast<int>(n));
+        }
+      }
+    }
+
+    backend::ModelNode root{};
+    root.name = scene ? stringOf(scene->find("name")) : std::string{};
+    if (root.name.empty()) {
+      root.name = "ROOT";
+    }
+    root.localTransform[0][0] = settings.scale;
+    root.localTransform[1][1] = settings.scale;
+    root.localTransform[2][2] = settings.scale;
+    outData.nodes.push_back(std::move(root));
+    std::vector<char> visited(nodeCount, 0);
+    for (int rootIndex : roots) {
+      processNode(doc, rootIndex, 0, meshSubMeshes, visited, outData);
+    }
+    return true;
+  }
+
+} // namespace lve
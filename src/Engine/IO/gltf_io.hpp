@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Engine/IO/model_io.hpp"
+
+#include <string>
+
+namespace lve {
+
+  // Native glTF 2.0 reader for .gltf and .glb files. Binary buffers are memory mapped and accessors
+  // are decoded straight from them into the model's vertex and index arrays, one submesh per
+  // triangle primitive. Returns false for content it does not handle, sparse accessors or required
+  // extensions like Draco, so callers can fall back to Assimp. Of the import profiles only Optimize
+  // changes anything here, it drops degenerate triangles; glTF primitives are indexed already, so
+  // there is no welding, and materials are kept as the file lists them.
+  bool loadModelDataFromGltf(
+    const std::string &resolvedPath,
+    const ModelImportSettings &settings,
+    backend::ModelData &outData,
+    std::string *outError = nullptr);
+
+} // namespace lve
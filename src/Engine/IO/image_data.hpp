@@ -11,4 +11,21 @@ namespace lve {
     std::vector<unsigned char> pixels{};
   };
 
+  enum class BlockFormat {
+    BC1,  // RGB, 8 bytes per block
+    BC3,  // RGBA, BC1 color + BC4 alpha, 16 bytes per block
+    BC4,  // one channel (occlusion), 8 bytes per block
+    BC5,  // two channels (normal maps), 16 bytes per block
+    BC7   // RGBA, 16 bytes per block
+  };
+
+  // pre-encoded 4x4 block data, levels[0] is the full resolution image
+  struct CompressedImageData {
+    BlockFormat format{BlockFormat::BC7};
+    bool sRGB{true};
+    int width{0};
+    int height{0};
+    std::vector<std::vector<unsigned char>> levels{};
+  };
+
 } // namespace lve
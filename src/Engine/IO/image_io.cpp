@@ -3,6 +3,12 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
 namespace lve {
 
   namespace {
@@ -11,6 +17,131 @@ namespace lve {
         *outError = message ? message : "unknown error";
       }
     }
+
+    const std::array<float, 256> &srgbToLinearTable() {
+      static const std::array<float, 256> table = [] {
+        std::array<float, 256> values{};
+        for (int i = 0; i < 256; ++i) {
+          const float c = static_cast<float>(i) / 255.f;
+          values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+      }();
+      return table;
+    }
+
+    unsigned char linearToSrgb(float value) {
+      value = std::clamp(value, 0.f, 1.f);
+      const float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+      return static_cast<unsigned char>(std::lround(c * 255.f));
+    }
+
+    void downsample(const ImageData &src, bool sRGB, ImageData &dst) {
+      const int channels = src.channels;
+      dst.width = std::max(1, src.width / 2);
+      dst.height = std::max(1, src.height / 2);
+      dst.channels = channels;
+      dst.pixels.resize(static_cast<std::size_t>(dst.width) * dst.height * channels);
+
+      // only color channels of RGB(A) images are sRGB encoded
+      const int srgbChannels = sRGB && channels >= 3 ? 3 : 0;
+      const auto &toLinear = srgbToLinearTable();
+      for (int y = 0; y < dst.height; ++y) {
+        // odd sizes fold the last row/column into the final texel
+        const int y0 = std::min(y * 2, src.height - 1);
+        const int y1 = std::min(y * 2 + 1, src.height - 1);
+        for (int x = 0; x < dst.width; ++x) {
+          const int x0 = std::min(x * 2, src.width - 1);
+          const int x1 = std::min(x * 2 + 1, src.width - 1);
+          const unsigned char *taps[4] = {
+            &src.pixels[(static_cast<std::size_t>(y0) * src.width + x0) * channels],
+            &src.pixels[(static_cast<std::size_t>(y0) * src.width + x1) * channels],
+            &src.pixels[(static_cast<std::size_t>(y1) * src.width + x0) * channels],
+            &src.pixels[(static_cast<std::size_t>(y1) * src.width + x1) * channels]};
+          unsigned char *out = &dst.pixels[(static_cast<std::size_t>(y) * dst.width + x) * channels];
+          for (int c = 0; c < channels; ++c) {
+            if (c < srgbChannels) {
+              float sum = 0.f;
+              for (const unsigned char *tap : taps) sum += toLinear[tap[c]];
+              out[c] = linearToSrgb(sum * 0.25f);
+            } else {
+              int sum = 0;
+              for (const unsigned char *tap : taps) sum += tap[c];
+              out[c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+          }
+        }
+      }
+    }
+
+    bool isValidImage(const ImageData &image) {
+      return image.width > 0 && image.height > 0 && image.channels >= 1 && image.channels <= 4 &&
+        image.pixels.size() >= static_cast<std::size_t>(image.width) * image.height * image.channels;
+    }
+
+    std::uint32_t crc32(const unsigned char *data, std::size_t size, std::uint32_t crc = 0) {
+      static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> values{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+          std::uint32_t c = i;
+          for (int k = 0; k < 8; ++k) {
+            c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+          }
+          values[i] = c;
+        }
+        return values;
+      }();
+      crc = ~crc;
+      for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+      }
+      return ~crc;
+    }
+
+    void appendBigEndian(std::vector<unsigned char> &out, std::uint32_t value) {
+      out.push_back(static_cast<unsigned char>(value >> 24));
+      out.push_back(static_cast<unsigned char>(value >> 16));
+      out.push_back(static_cast<unsigned char>(value >> 8));
+      out.push_back(static_cast<unsigned char>(value));
+    }
+
+    void appendPngChunk(std::vector<unsigned char> &out, const char type[4], const std::vector<unsigned char> &data) {
+      appendBigEndian(out, static_cast<std::uint32_t>(data.size()));
+      const std::size_t typeOffset = out.size();
+      out.insert(out.end(), type, type + 4);
+      out.insert(out.end(), data.begin(), data.end());
+      appendBigEndian(out, crc32(&out[typeOffset], data.size() + 4));
+    }
+
+    // zlib stream of stored deflate blocks
+    std::vector<unsigned char> zlibStore(const std::vector<unsigned char> &raw) {
+      constexpr std::size_t kMaxStoredBlock = 65535;
+      std::vector<unsigned char> out;
+      out.reserve(raw.size() + raw.size() / kMaxStoredBlock * 5 + 16);
+      out.push_back(0x78);
+      out.push_back(0x01);
+      std::size_t offset = 0;
+      do {
+        const std::size_t length = std::min(kMaxStoredBlock, raw.size() - offset);
+        const bool last = offset + length == raw.size();
+        out.push_back(last ? 1 : 0);
+        out.push_back(static_cast<unsigned char>(length));
+        out.push_back(static_cast<unsigned char>(length >> 8));
+        out.push_back(static_cast<unsigned char>(~length));
+        out.push_back(static_cast<unsigned char>(~length >> 8));
+        out.insert(out.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+      } while (offset < raw.size());
+
+      std::uint32_t a = 1;
+      std::uint32_t b = 0;
+      for (unsigned char value : raw) {
+        a = (a + value) % 65521u;
+        b = (b + a) % 65521u;
+      }
+      appendBigEndian(out, (b << 16) | a);
+      return out;
+    }
   } // namespace
 
   bool loadImageDataFromFile(
@@ -24,7 +155,8 @@ namespace lve {
       return false;
     }
 
-    stbi_set_flip_vertically_on_load(flipVertically ? 1 : 0);
+    // the per-thread flag, decode workers load with different orientations at the same time
+    stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
     int width = 0;
     int height = 0;
     int channels = 0;
@@ -55,7 +187,7 @@ namespace lve {
       return false;
     }
 
-    stbi_set_flip_vertically_on_load(flipVertically ? 1 : 0);
+    stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
     int width = 0;
     int height = 0;
     int channels = 0;
@@ -118,4 +250,121 @@ namespace lve {
     }
   }
 
+  bool generateMipChain(
+    const ImageData &base,
+    bool sRGB,
+    std::vector<ImageData> &outLevels,
+    std::string *outError) {
+    outLevels.clear();
+    if (!isValidImage(base)) {
+      setError(outError, "mip generation expects 8 bit pixels with 1 to 4 channels");
+      return false;
+    }
+
+    const ImageData *previous = &base;
+    while (previous->width > 1 || previous->height > 1) {
+      ImageData level{};
+      downsample(*previous, sRGB, level);
+      outLevels.push_back(std::move(level));
+      previous = &outLevels.back();
+    }
+    return true;
+  }
+
+  bool writePngFile(const std::string &path, const ImageData &image, std::string *outError) {
+    if (!isValidImage(image)) {
+      setError(outError, "invalid image for PNG");
+      return false;
+    }
+
+    static constexpr unsigned char kColorTypes[] = {0, 0, 4, 2, 6};
+    std::vector<unsigned char> header;
+    appendBigEndian(header, static_cast<std::uint32_t>(image.width));
+    appendBigEndian(header, static_cast<std::uint32_t>(image.height));
+    header.push_back(8);  // bit depth
+    header.push_back(kColorTypes[image.channels]);
+    header.push_back(0);  // deflate
+    header.push_back(0);  // adaptive filtering
+    header.push_back(0);  // no interlace
+
+    // every scanline starts with filter type 0
+    const std::size_t rowSize = static_cast<std::size_t>(image.width) * image.channels;
+    std::vector<unsigned char> scanlines;
+    scanlines.reserve((rowSize + 1) * image.height);
+    for (int y = 0; y < image.height; ++y) {
+      scanlines.push_back(0);
+      const auto row = image.pixels.begin() + static_cast<std::ptrdiff_t>(rowSize * y);
+      scanlines.insert(scanlines.end(), row, row + static_cast<std::ptrdiff_t>(rowSize));
+    }
+
+    static constexpr unsigned char kSignature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<unsigned char> png(std::begin(kSignature), std::end(kSignature));
+    appendPngChunk(png, "IHDR", header);
+    appendPngChunk(png, "IDAT", zlibStore(scanlines));
+    appendPngChunk(png, "IEND", {});
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      setError(outError, "failed to open PNG for writing");
+      return false;
+    }
+    file.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+    if (!file) {
+      setError(outError, "failed to write PNG");
+      return false;
+    }
+    return true;
+  }
+
+  bool downscaleToFit(ImageData &image, int maxSize, bool sRGB, std::string *outError) {
+    if (!isValidImage(image)) {
+      setError(outError, "invalid image data");
+      return false;
+    }
+    while (maxSize > 0 && std::max(image.width, image.height) > maxSize) {
+      ImageData half{};
+      downsample(image, sRGB, half);
+      image = std::move(half);
+    }
+    return true;
+  }
+
+  bool packImageForUsage(
+    const ImageData &rgba,
+    TextureUsage usage,
+    ImageData &outData,
+    std::string *outError) {
+    if (!isValidImage(rgba) || rgba.channels != 4) {
+      setError(outError, "channel packing expects RGBA8 pixels");
+      return false;
+    }
+    if (usage == TextureUsage::Color) {
+      outData = rgba;
+      return true;
+    }
+
+    // normal: xy, metallic-roughness: glTF roughness (g) and metallic (b), occlusion: r
+    int sources[2] = {0, 1};
+    int channels = 2;
+    if (usage == TextureUsage::MetallicRoughness) {
+      sources[0] = 1;
+      sources[1] = 2;
+    } else if (usage == TextureUsage::Occlusion) {
+      channels = 1;
+    }
+
+    const std::size_t pixelCount = static_cast<std::size_t>(rgba.width) * rgba.height;
+    outData = ImageData{};
+    outData.width = rgba.width;
+    outData.height = rgba.height;
+    outData.channels = channels;
+    outData.pixels.resize(pixelCount * channels);
+    for (std::size_t i = 0; i < pixelCount; ++i) {
+      for (int c = 0; c < channels; ++c) {
+        outData.pixels[i * channels + c] = rgba.pixels[i * 4 + sources[c]];
+      }
+    }
+    return true;
+  }
+
 } // namespace lve
@@ -2,9 +2,11 @@
 
 #include "Engine/Backend/model_data.hpp"
 #include "Engine/IO/image_data.hpp"
+#include "Engine/material_data.hpp"
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace lve {
 
@@ -33,4 +35,28 @@ namespace lve {
     ImageData &outData,
     std::string *outError = nullptr);
 
+  // box-filtered mip levels 1..N (level 0 is the input), color averaged in linear space when sRGB
+  bool generateMipChain(
+    const ImageData &base,
+    bool sRGB,
+    std::vector<ImageData> &outLevels,
+    std::string *outError = nullptr);
+
+  // 8-bit PNG (grey, grey+alpha, RGB or RGBA by channel count), rows top to bottom.
+  // Deflate runs in stored mode: files are large but writing needs no zlib
+  bool writePngFile(
+    const std::string &path,
+    const ImageData &image,
+    std::string *outError = nullptr);
+
+  // halves the image until neither side exceeds maxSize (0 keeps it as is)
+  bool downscaleToFit(ImageData &image, int maxSize, bool sRGB, std::string *outError = nullptr);
+
+  // keeps only the channels a usage samples: normal xy, roughness/metallic, occlusion
+  bool packImageForUsage(
+    const ImageData &rgba,
+    TextureUsage usage,
+    ImageData &outData,
+    std::string *outError = nullptr);
+
 } // namespace lve
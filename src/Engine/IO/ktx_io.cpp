@@ -0,0 +1,277 @@
+#include "Engine/IO/ktx_io.hpp"
+
+#include "Engine/IO/texture_compression.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace lve {
+
+  namespace {
+    constexpr unsigned char kIdentifier[12] = {
+      0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    constexpr std::size_t kHeaderSize = 80;
+    constexpr std::size_t kLevelIndexEntrySize = 24;
+    constexpr const char *kSourceKey = "lveSourceKey";
+
+    void setError(std::string *outError, const char *message) {
+      if (outError) {
+        *outError = message ? message : "unknown error";
+      }
+    }
+
+    void put32(std::vector<unsigned char> &out, std::size_t offset, uint32_t value) {
+      for (int i = 0; i < 4; ++i) {
+        out[offset + i] = static_cast<unsigned char>((value >> (i * 8)) & 0xFF);
+      }
+    }
+
+    void put64(std::vector<unsigned char> &out, std::size_t offset, uint64_t value) {
+      for (int i = 0; i < 8; ++i) {
+        out[offset + i] = static_cast<unsigned char>((value >> (i * 8)) & 0xFF);
+      }
+    }
+
+    void append32(std::vector<unsigned char> &out, uint32_t value) {
+      out.resize(out.size() + 4);
+      put32(out, out.size() - 4, value);
+    }
+
+    uint32_t get32(const unsigned char *data) {
+      return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+        static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+    }
+
+    uint64_t get64(const unsigned char *data) {
+      return static_cast<uint64_t>(get32(data)) | static_cast<uint64_t>(get32(data + 4)) << 32;
+    }
+
+    void alignTo(std::vector<unsigned char> &out, std::size_t alignment) {
+      out.resize((out.size() + alignment - 1) / alignment * alignment, 0);
+    }
+
+    // Khronos data format descriptor with one basic block
+    void appendDfd(std::vector<unsigned char> &out, BlockFormat format, bool sRGB) {
+      struct Sample {
+        uint32_t bitOffset;
+        uint32_t bitLength;
+        uint32_t channel;
+      };
+      std::vector<Sample> samples;
+      uint32_t colorModel = 0;
+      switch (format) {
+        case BlockFormat::BC1:
+          colorModel = 128;
+          samples = {{0, 64, 0}};
+          break;
+        case BlockFormat::BC3:
+          colorModel = 130;
+          // alpha is never sRGB encoded
+          samples = {{0, 64, 15u | 0x10u}, {64, 64, 0}};
+          break;
+        case BlockFormat::BC4:
+          colorModel = 131;
+          samples = {{0, 64, 0}};
+          break;
+        case BlockFormat::BC5:
+          colorModel = 132;
+          samples = {{0, 64, 0}, {64, 64, 1}};
+          break;
+        case BlockFormat::BC7:
+          colorModel = 134;
+          samples = {{0, 128, 0}};
+          break;
+      }
+      const uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+      const bool colorFormat = format != BlockFormat::BC4 && format != BlockFormat::BC5;
+      const uint32_t transfer = sRGB && colorFormat ? 2 : 1;
+
+      append32(out, 4 + blockSize);
+      append32(out, 0);
+      append32(out, 2u | blockSize << 16);
+      append32(out, colorModel | 1u << 8 | transfer << 16);
+      append32(out, 3u | 3u << 8);
+      append32(out, static_cast<uint32_t>(blockFormatBytesPerBlock(format)));
+      append32(out, 0);
+      for (const auto &sample : samples) {
+        append32(out, sample.bitOffset | (sample.bitLength - 1) << 16 | sample.channel << 24);
+        append32(out, 0);
+        append32(out, 0);
+        append32(out, 0xFFFFFFFFu);
+      }
+    }
+
+    void appendKeyValue(std::vector<unsigned char> &out, const std::string &key, const std::string &value) {
+      const uint32_t length = static_cast<uint32_t>(key.size() + 1 + value.size() + 1);
+      append32(out, length);
+      out.insert(out.end(), key.begin(), key.end());
+      out.push_back(0);
+      out.insert(out.end(), value.begin(), value.end());
+      out.push_back(0);
+      alignTo(out, 4);
+    }
+
+    std::size_t boundedLength(const char *text, std::size_t maxLength) {
+      const void *terminator = std::memchr(text, 0, maxLength);
+      return terminator ? static_cast<std::size_t>(static_cast<const char *>(terminator) - text) : maxLength;
+    }
+
+    bool findKeyValue(const unsigned char *data, std::size_t size, const std::string &key, std::string &outValue) {
+      std::size_t offset = 0;
+      while (offset + 4 <= size) {
+        const uint32_t length = get32(data + offset);
+        offset += 4;
+        if (length > size - offset) return false;
+        const char *entry = reinterpret_cast<const char *>(data + offset);
+        const std::size_t keyLength = boundedLength(entry, length);
+        if (keyLength < length && key == std::string(entry, keyLength)) {
+          outValue.assign(entry + keyLength + 1, boundedLength(entry + keyLength + 1, length - keyLength - 1));
+          return true;
+        }
+        offset += (length + 3) & ~3u;
+      }
+      return false;
+    }
+
+    bool readFile(const std::string &path, std::vector<unsigned char> &out) {
+      std::ifstream file(path, std::ios::binary | std::ios::ate);
+      if (!file) return false;
+      const std::streamsize size = file.tellg();
+      if (size <= 0) return false;
+      out.resize(static_cast<std::size_t>(size));
+      file.seekg(0);
+      return static_cast<bool>(file.read(reinterpret_cast<char *>(out.data()), size));
+    }
+  } // namespace
+
+  bool saveKtxFile(
+    const std::string &path,
+    const CompressedImageData &data,
+    const std::string &sourceKey,
+    std::string *outError) {
+    if (data.width <= 0 || data.height <= 0 || data.levels.empty()) {
+      setError(outError, "no compressed levels to write");
+      return false;
+    }
+
+    const uint32_t levelCount = static_cast<uint32_t>(data.levels.size());
+    std::vector<unsigned char> out(kHeaderSize + kLevelIndexEntrySize * levelCount, 0);
+    std::memcpy(out.data(), kIdentifier, sizeof(kIdentifier));
+    put32(out, 12, blockFormatToVkFormat(data.format, data.sRGB));
+    put32(out, 16, 1);
+    put32(out, 20, static_cast<uint32_t>(data.width));
+    put32(out, 24, static_cast<uint32_t>(data.height));
+    put32(out, 36, 1);
+    put32(out, 40, levelCount);
+
+    const std::size_t dfdOffset = out.size();
+    appendDfd(out, data.format, data.sRGB);
+    put32(out, 48, static_cast<uint32_t>(dfdOffset));
+    put32(out, 52, static_cast<uint32_t>(out.size() - dfdOffset));
+
+    const std::size_t kvdOffset = out.size();
+    appendKeyValue(out, "KTXwriter", "littleVulkanGameEngine");
+    appendKeyValue(out, kSourceKey, sourceKey);
+    put32(out, 56, static_cast<uint32_t>(kvdOffset));
+    put32(out, 60, static_cast<uint32_t>(out.size() - kvdOffset));
+
+    // level data goes smallest first, each level aligned to the block size
+    const std::size_t alignment = blockFormatBytesPerBlock(data.format);
+    for (uint32_t level = levelCount; level-- > 0;) {
+      alignTo(out, alignment);
+      const std::size_t entry = kHeaderSize + kLevelIndexEntrySize * level;
+      put64(out, entry, out.size());
+      put64(out, entry + 8, data.levels[level].size());
+      put64(out, entry + 16, data.levels[level].size());
+      out.insert(out.end(), data.levels[level].begin(), data.levels[level].end());
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size()))) {
+      setError(outError, "failed to write KTX2 file");
+      return false;
+    }
+    return true;
+  }
+
+  bool loadKtxFile(
+    const std::string &path,
+    CompressedImageData &outData,
+    std::string *outSourceKey,
+    std::string *outError) {
+    outData = CompressedImageData{};
+    std::vector<unsigned char> bytes;
+    if (!readFile(path, bytes)) {
+      setError(outError, "failed to read KTX2 file");
+      return false;
+    }
+    if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kIdentifier, sizeof(kIdentifier)) != 0) {
+      setError(outError, "not a KTX2 file");
+      return false;
+    }
+    if (!blockFormatFromVkFormat(get32(&bytes[12]), outData.format, outData.sRGB)) {
+      setError(outError, "unsupported KTX2 format");
+      return false;
+    }
+    if (get32(&bytes[44]) != 0) {
+      setError(outError, "supercompressed KTX2 files are not supported");
+      return false;
+    }
+
+    outData.width = static_cast<int>(get32(&bytes[20]));
+    outData.height = static_cast<int>(get32(&bytes[24]));
+    const uint32_t levelCount = std::max(1u, get32(&bytes[40]));
+    if (bytes.size() < kHeaderSize + kLevelIndexEntrySize * levelCount) {
+      setError(outError, "truncated KTX2 level index");
+      return false;
+    }
+
+    outData.levels.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; ++level) {
+      const unsigned char *entry = &bytes[kHeaderSize + kLevelIndexEntrySize * level];
+      const uint64_t offset = get64(entry);
+      const uint64_t length = get64(entry + 8);
+      const int width = std::max(1, outData.width >> level);
+      const int height = std::max(1, outData.height >> level);
+      if (offset > bytes.size() || length > bytes.size() - offset ||
+          length != compressedLevelSize(outData.format, width, height)) {
+        setError(outError, "corrupt KTX2 level");
+        outData = CompressedImageData{};
+        return false;
+      }
+      const unsigned char *levelData = bytes.data() + offset;
+      outData.levels[level].assign(levelData, levelData + length);
+    }
+
+    if (outSourceKey) {
+      const uint32_t kvdOffset = get32(&bytes[56]);
+      const uint32_t kvdLength = get32(&bytes[60]);
+      outSourceKey->clear();
+      if (kvdOffset <= bytes.size() && kvdLength <= bytes.size() - kvdOffset) {
+        findKeyValue(&bytes[kvdOffset], kvdLength, kSourceKey, *outSourceKey);
+      }
+    }
+    return true;
+  }
+
+  bool readKtxSourceKey(const std::string &path, std::string &outSourceKey) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char header[kHeaderSize];
+    if (!file || !file.read(reinterpret_cast<char *>(header), kHeaderSize) ||
+        std::memcmp(header, kIdentifier, sizeof(kIdentifier)) != 0) {
+      return false;
+    }
+    const uint32_t kvdOffset = get32(&header[56]);
+    const uint32_t kvdLength = get32(&header[60]);
+    std::vector<unsigned char> kvd(kvdLength);
+    if (kvdLength == 0 || !file.seekg(kvdOffset) ||
+        !file.read(reinterpret_cast<char *>(kvd.data()), kvdLength)) {
+      return false;
+    }
+    return findKeyValue(kvd.data(), kvd.size(), kSourceKey, outSourceKey);
+  }
+
+} // namespace lve
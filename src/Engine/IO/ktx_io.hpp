@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Engine/IO/image_data.hpp"
+
+#include <string>
+
+namespace lve {
+
+  // KTX2 container with block compressed levels, no supercompression. sourceKey is stored as
+  // key/value data so importers can tell whether the file is stale.
+  bool saveKtxFile(
+    const std::string &path,
+    const CompressedImageData &data,
+    const std::string &sourceKey,
+    std::string *outError = nullptr);
+
+  bool loadKtxFile(
+    const std::string &path,
+    CompressedImageData &outData,
+    std::string *outSourceKey = nullptr,
+    std::string *outError = nullptr);
+
+  // reads only the header and key/value data
+  bool readKtxSourceKey(const std::string &path, std::string &outSourceKey);
+
+} // namespace lve
@@ -0,0 +1,134 @@
+#include "Engine/IO/mapped_file.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace lve {
+
+  namespace {
+    bool fail(std::string *outError, const std::string &message) {
+      if (outError) {
+        *outError = message;
+      }
+      return false;
+    }
+  } // namespace
+
+  MappedFile::~MappedFile() {
+    close();
+  }
+
+  MappedFile::MappedFile(MappedFile &&other) noexcept {
+    *this = std::move(other);
+  }
+
+  MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+      close();
+      std::swap(data_, other.data_);
+      std::swap(size_, other.size_);
+#ifdef _WIN32
+      std::swap(fileHandle_, other.fileHandle_);
+      std::swap(mappingHandle_, other.mappingHandle_);
+#endif
+    }
+    return *this;
+  }
+
+#ifdef _WIN32
+  bool MappedFile::open(const std::string &path, std::string *outError) {
+    close();
+    HANDLE file = CreateFileA(
+      path.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+      nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return fail(outError, "failed to open " + path);
+    }
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+      CloseHandle(file);
+      return fail(outError, "empty or unreadable file " + path);
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+      CloseHandle(file);
+      return fail(outError, "failed to map " + path);
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      return fail(outError, "failed to map " + path);
+    }
+    fileHandle_ = file;
+    mappingHandle_ = mapping;
+    data_ = static_cast<const unsigned char *>(view);
+    size_ = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+  }
+
+  void MappedFile::close() {
+    if (data_) {
+      UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_) {
+      CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    }
+    if (fileHandle_) {
+      CloseHandle(static_cast<HANDLE>(fileHandle_));
+    }
+    data_ = nullptr;
+    size_ = 0;
+    fileHandle_ = nullptr;
+    mappingHandle_ = nullptr;
+  }
+#else
+  bool MappedFile::open(const std::string &path, std::string *outError) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return fail(outError, "failed to open " + path);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+      ::close(fd);
+      return fail(outError, "empty or unreadable file " + path);
+    }
+    void *view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    if (view == MAP_FAILED) {
+      return fail(outError, "failed to map " + path);
+    }
+    madvise(view, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+    data_ = static_cast<const unsigned char *>(view);
+    size_ = static_cast<std::size_t>(info.st_size);
+    return true;
+  }
+
+  void MappedFile::close() {
+    if (data_) {
+      munmap(const_cast<unsigned char *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+  }
+#endif
+
+} // namespace lve
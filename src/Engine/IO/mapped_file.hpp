@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace lve {
+
+  // read-only memory mapping of a whole file
+  class MappedFile {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    bool open(const std::string &path, std::string *outError = nullptr);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+  private:
+    const unsigned char *data_{nullptr};
+    std::size_t size_{0};
+#ifdef _WIN32
+    void *fileHandle_{nullptr};
+    void *mappingHandle_{nullptr};
+#endif
+  };
+
+} // namespace lve
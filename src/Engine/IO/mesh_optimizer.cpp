@@ -0,0 +1,305 @@
+#include "Engine/IO/mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace lve {
+
+  namespace {
+    constexpr std::size_t kCacheSize = 16;
+    // cluster sorting may give back this much of the cache optimized miss count
+    constexpr float kOverdrawThreshold = 1.05f;
+    constexpr std::uint32_t kInvalidVertex = std::numeric_limits<std::uint32_t>::max();
+
+    // FIFO cache of kCacheSize entries: a vertex is still cached while fewer than kCacheSize
+    // misses happened since its own
+    class CacheSimulator {
+    public:
+      explicit CacheSimulator(std::size_t vertexCount) : insertedAt(vertexCount, 0) {}
+
+      bool access(std::uint32_t vertex) {
+        std::size_t &inserted = insertedAt[vertex];
+        if (inserted != 0 && misses - inserted < kCacheSize) {
+          return true;
+        }
+        inserted = ++misses;
+        return false;
+      }
+
+      std::size_t missCount() const { return misses; }
+
+    private:
+      std::vector<std::size_t> insertedAt;
+      std::size_t misses{0};
+    };
+
+    std::size_t countCacheMisses(const std::uint32_t *indices, std::size_t indexCount, std::size_t vertexCount) {
+      CacheSimulator cache{vertexCount};
+      for (std::size_t i = 0; i < indexCount; ++i) {
+        cache.access(indices[i]);
+      }
+      return cache.missCount();
+    }
+
+    // Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+    void optimizeVertexCache(std::uint32_t *indices, std::size_t indexCount, std::size_t vertexCount) {
+      const std::size_t triangleCount = indexCount / 3;
+
+      std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+      for (std::size_t i = 0; i < indexCount; ++i) {
+        ++adjacencyOffsets[indices[i] + 1];
+      }
+      for (std::size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+      }
+      std::vector<std::uint32_t> adjacency(indexCount);
+      std::vector<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+      for (std::size_t i = 0; i < indexCount; ++i) {
+        adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+      }
+
+      std::vector<std::uint32_t> liveTriangles(vertexCount);
+      for (std::size_t v = 0; v < vertexCount; ++v) {
+        liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+      }
+      std::vector<std::size_t> cacheTime(vertexCount, 0);
+      std::vector<char> emitted(triangleCount, 0);
+      std::vector<std::uint32_t> deadEnd;
+      std::vector<std::uint32_t> candidates;
+      std::vector<std::uint32_t> output;
+      output.reserve(indexCount);
+
+      std::size_t timestamp = kCacheSize + 1;
+      std::size_t cursor = 0;
+      auto skipDeadEnd = [&]() -> std::uint32_t {
+        while (!deadEnd.empty()) {
+          const std::uint32_t vertex = deadEnd.back();
+          deadEnd.pop_back();
+          if (liveTriangles[vertex] > 0) {
+            return vertex;
+          }
+        }
+        for (; cursor < vertexCount; ++cursor) {
+          if (liveTriangles[cursor] > 0) {
+            return static_cast<std::uint32_t>(cursor);
+          }
+        }
+        return kInvalidVertex;
+      };
+
+      std::uint32_t fanning = skipDeadEnd();
+      while (fanning != kInvalidVertex) {
+        candidates.clear();
+        for (std::uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; ++a) {
+          const std::uint32_t triangle = adjacency[a];
+          if (emitted[triangle]) {
+            continue;
+          }
+          emitted[triangle] = 1;
+          for (std::size_t corner = 0; corner < 3; ++corner) {
+            const std::uint32_t vertex = indices[triangle * 3 + corner];
+            output.push_back(vertex);
+            deadEnd.push_back(vertex);
+            candidates.push_back(vertex);
+            --liveTriangles[vertex];
+            if (timestamp - cacheTime[vertex] > kCacheSize) {
+              cacheTime[vertex] = timestamp++;
+            }
+          }
+        }
+
+        // prefer the candidate that stays in the cache longest without its fan spilling out of it
+        fanning = kInvalidVertex;
+        std::size_t bestPriority = 0;
+        for (std::uint32_t vertex : candidates) {
+          if (liveTriangles[vertex] == 0) {
+            continue;
+          }
+          std::size_t priority = 0;
+          const std::size_t age = timestamp - cacheTime[vertex];
+          if (age + 2 * liveTriangles[vertex] <= kCacheSize) {
+            priority = age;
+          }
+          if (fanning == kInvalidVertex || priority > bestPriority) {
+            fanning = vertex;
+            bestPriority = priority;
+          }
+        }
+        if (fanning == kInvalidVertex) {
+          fanning = skipDeadEnd();
+        }
+      }
+
+      std::copy(output.begin(), output.end(), indices);
+    }
+
+    // Clusters start where the cache was flushed, so reordering them barely changes the miss
+    // count. Clusters facing away from the mesh center are drawn first, they tend to occlude the rest.
+    void optimizeOverdraw(
+      std::uint32_t *indices,
+      std::size_t indexCount,
+      std::size_t vertexCount,
+      const backend::ModelVertex *vertices) {
+      const std::size_t triangleCount = indexCount / 3;
+      const std::size_t cacheMisses = countCacheMisses(indices, indexCount, vertexCount);
+
+      std::vector<std::size_t> clusterStarts;
+      CacheSimulator cache{vertexCount};
+      for (std::size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        const std::uint32_t *corners = indices + triangle * 3;
+        const bool hit0 = cache.access(corners[0]);
+        const bool hit1 = cache.access(corners[1]);
+        const bool hit2 = cache.access(corners[2]);
+        if (triangle == 0 || (!hit0 && !hit1 && !hit2)) {
+          clusterStarts.push_back(triangle);
+        }
+      }
+      if (clusterStarts.size() < 2) {
+        return;
+      }
+      clusterStarts.push_back(triangleCount);
+
+      struct Cluster {
+        std::size_t start;
+        std::size_t end;
+        glm::vec3 centroid;
+        glm::vec3 normal;
+        float sortKey;
+      };
+      std::vector<Cluster> clusters;
+      clusters.reserve(clusterStarts.size() - 1);
+      glm::vec3 meshCentroid{0.f};
+      float meshArea = 0.f;
+      for (std::size_t c = 0; c + 1 < clusterStarts.size(); ++c) {
+        Cluster cluster{clusterStarts[c], clusterStarts[c + 1], glm::vec3{0.f}, glm::vec3{0.f}, 0.f};
+        float clusterArea = 0.f;
+        for (std::size_t triangle = cluster.start; triangle < cluster.end; ++triangle) {
+          const glm::vec3 &p0 = vertices[indices[triangle * 3 + 0]].position;
+          const glm::vec3 &p1 = vertices[indices[triangle * 3 + 1]].position;
+          const glm::vec3 &p2 = vertices[indices[triangle * 3 + 2]].position;
+          const glm::vec3 areaNormal = glm::cross(p1 - p0, p2 - p0);
+          const float area = glm::length(areaNormal);
+          const glm::vec3 center = (p0 + p1 + p2) / 3.f;
+          cluster.centroid += center * area;
+          cluster.normal += areaNormal;
+          clusterArea += area;
+        }
+        meshCentroid += cluster.centroid;
+        meshArea += clusterArea;
+        if (clusterArea > 0.f) {
+          cluster.centroid /= clusterArea;
+        }
+        clusters.push_back(cluster);
+      }
+      if (meshArea > 0.f) {
+        meshCentroid /= meshArea;
+      }
+      for (Cluster &cluster : clusters) {
+        const float normalLength = glm::length(cluster.normal);
+        if (normalLength > 0.f) {
+          cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal / normalLength);
+        }
+      }
+      std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b) {
+        return a.sortKey > b.sortKey;
+      });
+
+      std::vector<std::uint32_t> sorted;
+      sorted.reserve(indexCount);
+      for (const Cluster &cluster : clusters) {
+        sorted.insert(sorted.end(), indices + cluster.start * 3, indices + cluster.end * 3);
+      }
+      const std::size_t sortedMisses = countCacheMisses(sorted.data(), sorted.size(), vertexCount);
+      if (static_cast<float>(sortedMisses) <= static_cast<float>(cacheMisses) * kOverdrawThreshold) {
+        std::copy(sorted.begin(), sorted.end(), indices);
+      }
+    }
+
+    // renumbers vertices in the order the index buffer first touches them
+    void optimizeVertexFetch(backend::ModelData &data) {
+      std::vector<std::uint32_t> remap(data.vertices.size(), kInvalidVertex);
+      std::vector<backend::ModelVertex> reordered;
+      std::vector<glm::vec4> reorderedTangents;
+      const bool hasTangents = data.tangents.size() == data.vertices.size();
+      reordered.reserve(data.vertices.size());
+      reorderedTangents.reserve(data.tangents.size());
+      for (std::uint32_t &index : data.indices) {
+        std::uint32_t &mapped = remap[index];
+        if (mapped == kInvalidVertex) {
+          mapped = static_cast<std::uint32_t>(reordered.size());
+          reordered.push_back(data.vertices[index]);
+          if (hasTangents) {
+            reorderedTangents.push_back(data.tangents[index]);
+          }
+        }
+        index = mapped;
+      }
+      data.vertices = std::move(reordered);
+      data.tangents = std::move(reorderedTangents);
+    }
+  } // namespace
+
+  void optimizeModelData(backend::ModelData &data, bool reduceOverdraw, MeshOptimizationStats *outStats) {
+    MeshOptimizationStats stats{};
+    const std::size_t vertexCount = data.vertices.size();
+    const bool validIndices = std::all_of(data.indices.begin(), data.indices.end(), [vertexCount](std::uint32_t index) {
+      return index < vertexCount;
+    });
+    if (data.indices.empty() || !validIndices) {
+      if (outStats) *outStats = stats;
+      return;
+    }
+
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    if (data.subMeshes.empty()) {
+      ranges.emplace_back(0, data.indices.size());
+    }
+    for (const auto &subMesh : data.subMeshes) {
+      ranges.emplace_back(subMesh.firstIndex, subMesh.indexCount);
+      for (const auto &lod : subMesh.lods) {
+        ranges.emplace_back(lod.firstIndex, lod.indexCount);
+      }
+    }
+
+    std::size_t missesBefore = 0;
+    std::size_t missesAfter = 0;
+    std::vector<std::uint32_t> local;
+    for (const auto &[firstIndex, indexCount] : ranges) {
+      if (indexCount < 3 || indexCount % 3 != 0 || firstIndex + indexCount > data.indices.size()) {
+        continue;
+      }
+      std::uint32_t *indices = data.indices.data() + firstIndex;
+      const auto [minIt, maxIt] = std::minmax_element(indices, indices + indexCount);
+      const std::uint32_t baseVertex = *minIt;
+      const std::size_t rangeVertexCount = static_cast<std::size_t>(*maxIt - baseVertex) + 1;
+
+      local.assign(indices, indices + indexCount);
+      for (std::uint32_t &index : local) {
+        index -= baseVertex;
+      }
+      missesBefore += countCacheMisses(local.data(), indexCount, rangeVertexCount);
+      optimizeVertexCache(local.data(), indexCount, rangeVertexCount);
+      if (reduceOverdraw) {
+        optimizeOverdraw(local.data(), indexCount, rangeVertexCount, data.vertices.data() + baseVertex);
+      }
+      missesAfter += countCacheMisses(local.data(), indexCount, rangeVertexCount);
+      for (std::size_t i = 0; i < indexCount; ++i) {
+        indices[i] = local[i] + baseVertex;
+      }
+      stats.triangleCount += indexCount / 3;
+    }
+
+    optimizeVertexFetch(data);
+
+    if (stats.triangleCount > 0) {
+      stats.acmrBefore = static_cast<float>(missesBefore) / static_cast<float>(stats.triangleCount);
+      stats.acmrAfter = static_cast<float>(missesAfter) / static_cast<float>(stats.triangleCount);
+    }
+    if (outStats) *outStats = stats;
+  }
+
+} // namespace lve
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Engine/Backend/model_data.hpp"
+
+#include <cstddef>
+
+namespace lve {
+
+  struct MeshOptimizationStats {
+    std::size_t triangleCount{0};
+    // average cache miss ratio, vertices transformed per triangle with a 16 entry FIFO cache
+    float acmrBefore{0.f};
+    float acmrAfter{0.f};
+  };
+
+  // Reorders the triangles of each submesh and LOD for the post-transform vertex cache (Tipsify),
+  // optionally sorts clusters of them outside-in against overdraw, then lays the vertices out in
+  // first-use order and drops unreferenced ones. Index ranges and bounds are unchanged, and the
+  // output depends only on the input.
+  void optimizeModelData(
+    backend::ModelData &data,
+    bool reduceOverdraw,
+    MeshOptimizationStats *outStats = nullptr);
+
+} // namespace lve
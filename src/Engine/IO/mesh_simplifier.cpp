@@ -0,0 +1,369 @@
+#include "Engine/IO/mesh_simplifier.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <unordered_map>
+
+namespace lve {
+
+  namespace {
+    constexpr std::size_t kMinLodTriangles = 64;
+    constexpr float kLodReduction = 0.5f;
+    // a level has to drop at least this share of the previous level's triangles
+    constexpr float kMinLodSaving = 0.1f;
+    // deviation a level may reach, relative to the submesh's bounding radius
+    constexpr float kMaxLodError = 0.25f;
+    // cosine below which a collapse is rejected as flipping or folding a triangle
+    constexpr float kMinNormalDot = 0.25f;
+
+    struct Quadric {
+      double a2{0}, ab{0}, ac{0}, ad{0}, b2{0}, bc{0}, bd{0}, c2{0}, cd{0}, d2{0};
+
+      void addPlane(double a, double b, double c, double d) {
+        a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+        b2 += b * b; bc += b * c; bd += b * d;
+        c2 += c * c; cd += c * d;
+        d2 += d * d;
+      }
+
+      Quadric &operator+=(const Quadric &o) {
+        a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad;
+        b2 += o.b2; bc += o.bc; bd += o.bd;
+        c2 += o.c2; cd += o.cd;
+        d2 += o.d2;
+        return *this;
+      }
+
+      // sum of squared distances from p to the accumulated planes, so its root bounds the largest one
+      double evaluate(const glm::vec3 &p) const {
+        const double x = p.x;
+        const double y = p.y;
+        const double z = p.z;
+        const double value = a2 * x * x + b2 * y * y + c2 * z * z +
+          2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+          2.0 * (ad * x + bd * y + cd * z) + d2;
+        return std::max(value, 0.0);
+      }
+    };
+
+    struct Collapse {
+      double cost;
+      std::uint32_t from;
+      std::uint32_t to;
+    };
+
+    std::uint64_t edgeKey(std::uint32_t a, std::uint32_t b) {
+      return a < b ? (static_cast<std::uint64_t>(a) << 32) | b : (static_cast<std::uint64_t>(b) << 32) | a;
+    }
+
+    // triangles around each vertex of the current index buffer
+    struct Adjacency {
+      std::vector<std::uint32_t> offsets;
+      std::vector<std::uint32_t> triangles;
+
+      void build(const std::vector<std::uint32_t> &indices, std::size_t vertexCount) {
+        offsets.assign(vertexCount + 1, 0);
+        for (std::uint32_t index : indices) {
+          ++offsets[index + 1];
+        }
+        for (std::size_t v = 0; v < vertexCount; ++v) {
+          offsets[v + 1] += offsets[v];
+        }
+        triangles.resize(indices.size());
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+          triangles[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+      }
+    };
+
+    void collectNeighbors(
+      const std::vector<std::uint32_t> &indices,
+      const Adjacency &adjacency,
+      std::uint32_t vertex,
+      std::vector<std::uint32_t> &out) {
+      out.clear();
+      for (std::uint32_t a = adjacency.offsets[vertex]; a < adjacency.offsets[vertex + 1]; ++a) {
+        const std::uint32_t *corners = &indices[adjacency.triangles[a] * 3];
+        for (int c = 0; c < 3; ++c) {
+          if (corners[c] != vertex) out.push_back(corners[c]);
+        }
+      }
+      std::sort(out.begin(), out.end());
+      out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+
+    // link condition against non-manifold results, and no triangle around from may flip
+    bool canCollapse(
+      const std::vector<std::uint32_t> &indices,
+      const Adjacency &adjacency,
+      const backend::ModelVertex *vertices,
+      std::uint32_t from,
+      std::uint32_t to,
+      std::vector<std::uint32_t> &fromNeighbors,
+      std::vector<std::uint32_t> &toNeighbors,
+      std::size_t &outRemovedTriangles) {
+      std::size_t shared = 0;
+      for (std::uint32_t a = adjacency.offsets[from]; a < adjacency.offsets[from + 1]; ++a) {
+        const std::uint32_t *corners = &indices[adjacency.triangles[a] * 3];
+        if (corners[0] == to || corners[1] == to || corners[2] == to) {
+          ++shared;
+          continue;
+        }
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (int c = 0; c < 3; ++c) {
+          before[c] = vertices[corners[c]].position;
+          after[c] = corners[c] == from ? vertices[to].position : before[c];
+        }
+        const glm::vec3 n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+        const glm::vec3 n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+        const float len0 = glm::length(n0);
+        const float len1 = glm::length(n1);
+        if (len1 <= 0.f || glm::dot(n0, n1) < kMinNormalDot * len0 * len1) {
+          return false;
+        }
+      }
+      if (shared == 0) {
+        return false;
+      }
+
+      collectNeighbors(indices, adjacency, from, fromNeighbors);
+      collectNeighbors(indices, adjacency, to, toNeighbors);
+      std::size_t common = 0;
+      auto a = fromNeighbors.begin();
+      auto b = toNeighbors.begin();
+      while (a != fromNeighbors.end() && b != toNeighbors.end()) {
+        if (*a < *b) {
+          ++a;
+        } else if (*b < *a) {
+          ++b;
+        } else {
+          ++common;
+          ++a;
+          ++b;
+        }
+      }
+      if (common != shared) {
+        return false;
+      }
+      outRemovedTriangles = shared;
+      return true;
+    }
+  } // namespace
+
+  std::vector<std::uint32_t> simplifyMesh(
+    const std::vector<std::uint32_t> &sourceIndices,
+    const backend::ModelVertex *vertices,
+    std::size_t vertexCount,
+    std::size_t targetIndexCount,
+    float maxError,
+    float *outError) {
+    std::vector<std::uint32_t> indices = sourceIndices;
+    double maxCost = 0.0;
+    const double costLimit = static_cast<double>(maxError) * maxError;
+
+    // an edge used by one triangle is a border, also where uv or normal seams split vertices;
+    // edges shared by more than two triangles are not safe to touch either
+    std::unordered_map<std::uint64_t, std::uint32_t> edgeUse;
+    edgeUse.reserve(indices.size());
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+      for (int e = 0; e < 3; ++e) {
+        ++edgeUse[edgeKey(indices[i + e], indices[i + (e + 1) % 3])];
+      }
+    }
+    std::vector<char> locked(vertexCount, 0);
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+      for (int e = 0; e < 3; ++e) {
+        const std::uint32_t a = indices[i + e];
+        const std::uint32_t b = indices[i + (e + 1) % 3];
+        if (edgeUse[edgeKey(a, b)] != 2) {
+          locked[a] = 1;
+          locked[b] = 1;
+        }
+      }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+      const glm::vec3 &p0 = vertices[indices[i]].position;
+      const glm::vec3 &p1 = vertices[indices[i + 1]].position;
+      const glm::vec3 &p2 = vertices[indices[i + 2]].position;
+      const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+      const float length = glm::length(normal);
+      if (length <= 0.f) {
+        continue;
+      }
+      const glm::vec3 n = normal / length;
+      const double d = -static_cast<double>(glm::dot(n, p0));
+      for (int c = 0; c < 3; ++c) {
+        quadrics[indices[i + c]].addPlane(n.x, n.y, n.z, d);
+      }
+    }
+
+    Adjacency adjacency;
+    std::vector<Collapse> candidates;
+    std::vector<std::uint64_t> edges;
+    std::vector<char> touched;
+    std::vector<std::uint32_t> remap;
+    std::vector<std::uint32_t> fromNeighbors;
+    std::vector<std::uint32_t> toNeighbors;
+    const std::size_t targetTriangles = targetIndexCount / 3;
+
+    // each pass collapses independent edges cheapest first, then rebuilds the topology
+    while (indices.size() / 3 > targetTriangles) {
+      adjacency.build(indices, vertexCount);
+
+      edges.clear();
+      for (std::size_t i = 0; i < indices.size(); i += 3) {
+        for (int e = 0; e < 3; ++e) {
+          edges.push_back(edgeKey(indices[i + e], indices[i + (e + 1) % 3]));
+        }
+      }
+      std::sort(edges.begin(), edges.end());
+      edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+      candidates.clear();
+      for (std::uint64_t key : edges) {
+        const auto a = static_cast<std::uint32_t>(key >> 32);
+        const auto b = static_cast<std::uint32_t>(key & 0xFFFFFFFFu);
+        Quadric combined = quadrics[a];
+        combined += quadrics[b];
+        const bool canA = !locked[a];
+        const bool canB = !locked[b];
+        if (!canA && !canB) {
+          continue;
+        }
+        const double costAB = canA ? combined.evaluate(vertices[b].position) : 0.0;
+        const double costBA = canB ? combined.evaluate(vertices[a].position) : 0.0;
+        if (canA && (!canB || costAB <= costBA)) {
+          candidates.push_back({costAB, a, b});
+        } else {
+          candidates.push_back({costBA, b, a});
+        }
+      }
+      std::sort(candidates.begin(), candidates.end(), [](const Collapse &l, const Collapse &r) {
+        return std::tie(l.cost, l.from, l.to) < std::tie(r.cost, r.from, r.to);
+      });
+
+      touched.assign(vertexCount, 0);
+      remap.resize(vertexCount);
+      for (std::size_t v = 0; v < vertexCount; ++v) {
+        remap[v] = static_cast<std::uint32_t>(v);
+      }
+      std::size_t triangles = indices.size() / 3;
+      bool collapsed = false;
+      for (const Collapse &candidate : candidates) {
+        if (triangles <= targetTriangles || candidate.cost > costLimit) {
+          break;
+        }
+        if (touched[candidate.from] || touched[candidate.to]) {
+          continue;
+        }
+        std::size_t removed = 0;
+        if (!canCollapse(
+              indices, adjacency, vertices, candidate.from, candidate.to, fromNeighbors, toNeighbors, removed)) {
+          continue;
+        }
+        remap[candidate.from] = candidate.to;
+        quadrics[candidate.to] += quadrics[candidate.from];
+        // triangles around from change, so their other corners wait for the next pass
+        for (std::uint32_t neighbor : fromNeighbors) {
+          touched[neighbor] = 1;
+        }
+        touched[candidate.from] = 1;
+        touched[candidate.to] = 1;
+        triangles -= removed;
+        maxCost = std::max(maxCost, candidate.cost);
+        collapsed = true;
+      }
+      if (!collapsed) {
+        break;
+      }
+
+      std::size_t write = 0;
+      for (std::size_t i = 0; i < indices.size(); i += 3) {
+        const std::uint32_t a = remap[indices[i]];
+        const std::uint32_t b = remap[indices[i + 1]];
+        const std::uint32_t c = remap[indices[i + 2]];
+        if (a == b || b == c || a == c) {
+          continue;
+        }
+        indices[write++] = a;
+        indices[write++] = b;
+        indices[write++] = c;
+      }
+      indices.resize(write);
+    }
+
+    if (outError) {
+      *outError = static_cast<float>(std::sqrt(maxCost));
+    }
+    return indices;
+  }
+
+  void generateModelLods(backend::ModelData &data, int lodCount) {
+    if (lodCount <= 0) {
+      return;
+    }
+    const std::size_t vertexCount = data.vertices.size();
+    std::vector<std::uint32_t> local;
+    for (auto &subMesh : data.subMeshes) {
+      subMesh.lods.clear();
+      const std::size_t indexCount = subMesh.indexCount;
+      if (!subMesh.hasBounds || indexCount / 3 < kMinLodTriangles ||
+          static_cast<std::size_t>(subMesh.firstIndex) + indexCount > data.indices.size()) {
+        continue;
+      }
+      const float radius = glm::length(subMesh.boundsMax - subMesh.boundsMin) * 0.5f;
+      if (!(radius > 0.f)) {
+        continue;
+      }
+
+      const std::uint32_t *source = data.indices.data() + subMesh.firstIndex;
+      const auto [minIt, maxIt] = std::minmax_element(source, source + indexCount);
+      if (*maxIt >= vertexCount) {
+        continue;
+      }
+      const std::uint32_t baseVertex = *minIt;
+      const std::size_t rangeVertexCount = static_cast<std::size_t>(*maxIt - baseVertex) + 1;
+      local.assign(source, source + indexCount);
+      for (std::uint32_t &index : local) {
+        index -= baseVertex;
+      }
+
+      // every level starts from the full mesh, so its error is measured against the original
+      std::size_t previousCount = indexCount;
+      float target = static_cast<float>(indexCount);
+      for (int level = 0; level < lodCount; ++level) {
+        target *= kLodReduction;
+        const std::size_t targetIndexCount = static_cast<std::size_t>(target) / 3 * 3;
+        float error = 0.f;
+        const std::vector<std::uint32_t> simplified = simplifyMesh(
+          local,
+          data.vertices.data() + baseVertex,
+          rangeVertexCount,
+          targetIndexCount,
+          kMaxLodError * radius,
+          &error);
+        if (simplified.empty() ||
+            static_cast<float>(simplified.size()) > static_cast<float>(previousCount) * (1.f - kMinLodSaving)) {
+          break;
+        }
+
+        backend::ModelLod lod{};
+        lod.firstIndex = static_cast<std::uint32_t>(data.indices.size());
+        lod.indexCount = static_cast<std::uint32_t>(simplified.size());
+        lod.error = error / radius;
+        for (std::uint32_t index : simplified) {
+          data.indices.push_back(index + baseVertex);
+        }
+        subMesh.lods.push_back(lod);
+        previousCount = simplified.size();
+      }
+    }
+  }
+
+} // namespace lve
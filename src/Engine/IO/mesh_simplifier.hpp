@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Engine/Backend/model_data.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+  // Quadric error edge collapse onto existing vertices, indices address the vertices array.
+  // Border and attribute seam vertices never move, so the result keeps the mesh outline and
+  // stays crack free. Stops at targetIndexCount or when the next collapse could move the surface
+  // further than maxError; outError receives the largest accepted bound on that deviation.
+  std::vector<std::uint32_t> simplifyMesh(
+    const std::vector<std::uint32_t> &indices,
+    const backend::ModelVertex *vertices,
+    std::size_t vertexCount,
+    std::size_t targetIndexCount,
+    float maxError,
+    float *outError = nullptr);
+
+  // Appends up to lodCount coarser levels per submesh to the index buffer, each targeting half
+  // the triangles of the one before. A level that saves too little ends the chain.
+  void generateModelLods(backend::ModelData &data, int lodCount);
+
+} // namespace lve
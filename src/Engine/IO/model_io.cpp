@@ -1,40 +1,161 @@
 #include "Engine/IO/model_io.hpp"
 
-#include "utils/utils.hpp"
+#include "Engine/IO/gltf_io.hpp"
 
 // libs
 #include <assimp/Importer.hpp>
 #include <assimp/material.h>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
 
 // std
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <iostream>
 #include <limits>
-#include <unordered_map>
 #include <utility>
 
 #ifndef ENGINE_DIR
 #define ENGINE_DIR ""
 #endif
 
-namespace std {
-  template <>
-  struct hash<lve::backend::ModelVertex> {
-    size_t operator()(lve::backend::ModelVertex const &vertex) const {
-      size_t seed = 0;
-      lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-      return seed;
-    }
-  };
-}  // namespace std
-
 namespace lve {
 
   namespace {
+    // only the steps an asset needs, each one is a full pass over the scene
+    unsigned int importFlags(const ModelImportSettings &settings) {
+      unsigned int flags = aiProcess_Triangulate;
+      flags |= settings.generateNormals
+        ? aiProcess_GenSmoothNormals | aiProcess_ForceGenNormals
+        : aiProcess_GenNormals;
+      // runs after FlipUVs, so the frame matches the final texture coordinates
+      if (settings.generateTangents) {
+        flags |= aiProcess_CalcTangentSpace;
+      }
+      // Assimp's origin is bottom-left, Vulkan samples from the top-left
+      if (!settings.flipUV) {
+        flags |= aiProcess_FlipUVs;
+      }
+      if (settings.scale != 1.f) {
+        flags |= aiProcess_GlobalScale;
+      }
+      if (settings.profile == ModelImportProfile::Optimize) {
+        // the engine's own cache pass replaces Assimp's when it is enabled
+        if (!settings.optimizeVertexCache) {
+          flags |= aiProcess_ImproveCacheLocality;
+        }
+        flags |= aiProcess_JoinIdenticalVertices |
+          aiProcess_RemoveRedundantMaterials |
+          aiProcess_FindDegenerates |
+          aiProcess_FindInvalidData |
+          aiProcess_OptimizeMeshes |
+          aiProcess_SortByPType;
+      }
+      return flags;
+    }
+
+    void hashFloats(std::uint64_t &hash, const float *values, std::size_t count) {
+      for (std::size_t i = 0; i < count; ++i) {
+        const float value = values[i] + 0.f;
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        hash = (hash ^ bits) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 29;
+      }
+    }
+
+    // over the bit patterns of all fields, -0 is folded into +0 to agree with operator==
+    std::uint32_t hashVertex(const backend::ModelVertex &vertex, const glm::vec4 *tangent) {
+      constexpr std::size_t kWords = sizeof(backend::ModelVertex) / sizeof(float);
+      static_assert(kWords * sizeof(float) == sizeof(backend::ModelVertex), "ModelVertex must be packed floats");
+      float values[kWords];
+      std::memcpy(values, &vertex, sizeof(values));
+      std::uint64_t hash = 0x9E3779B97F4A7C15ull;
+      hashFloats(hash, values, kWords);
+      if (tangent) {
+        const float tangentValues[4] = {tangent->x, tangent->y, tangent->z, tangent->w};
+        hashFloats(hash, tangentValues, 4);
+      }
+      return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+    }
+
+    // Welds equal vertices in [firstVertex, end) and rewrites indices in [firstIndex, end). Only
+    // needed when the importer did not join identical vertices itself.
+    void weldVertices(backend::ModelData &data, std::size_t firstVertex, std::size_t firstIndex) {
+      const std::size_t count = data.vertices.size() - firstVertex;
+      if (count == 0) {
+        return;
+      }
+      glm::vec4 *tangents = data.tangents.size() > firstVertex ? data.tangents.data() + firstVertex : nullptr;
+      std::size_t capacity = 16;
+      while (capacity < count * 2) {
+        capacity <<= 1;
+      }
+      struct Slot {
+        std::uint32_t hash{0};
+        std::uint32_t vertex{~0u};
+      };
+      std::vector<Slot> slots(capacity);
+      std::vector<std::uint32_t> remap(count);
+      std::uint32_t unique = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        const backend::ModelVertex vertex = data.vertices[firstVertex + i];
+        const glm::vec4 tangent = tangents ? tangents[i] : glm::vec4{0.f};
+        const std::uint32_t hash = hashVertex(vertex, tangents ? &tangent : nullptr);
+        std::size_t slot = hash & (capacity - 1);
+        while (slots[slot].vertex != ~0u &&
+               (slots[slot].hash != hash || !(data.vertices[firstVertex + slots[slot].vertex] == vertex) ||
+                (tangents && tangents[slots[slot].vertex] != tangent))) {
+          slot = (slot + 1) & (capacity - 1);
+        }
+        if (slots[slot].vertex == ~0u) {
+          slots[slot] = {hash, unique};
+          data.vertices[firstVertex + unique] = vertex;
+          if (tangents) {
+            tangents[unique] = tangent;
+          }
+          ++unique;
+        }
+        remap[i] = slots[slot].vertex;
+      }
+      data.vertices.resize(firstVertex + unique);
+      if (tangents) {
+        data.tangents.resize(firstVertex + unique);
+      }
+      for (std::size_t i = firstIndex; i < data.indices.size(); ++i) {
+        data.indices[i] = static_cast<std::uint32_t>(firstVertex) + remap[data.indices[i] - firstVertex];
+      }
+    }
+
+    // drops vertices only used by the points and lines skipped during import
+    void compactVertices(backend::ModelData &data, std::size_t firstVertex, std::size_t firstIndex) {
+      const std::size_t count = data.vertices.size() - firstVertex;
+      const bool hasTangents = data.tangents.size() > firstVertex;
+      std::vector<std::uint32_t> remap(count, ~0u);
+      for (std::size_t i = firstIndex; i < data.indices.size(); ++i) {
+        remap[data.indices[i] - firstVertex] = 0;
+      }
+      std::uint32_t used = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        if (remap[i] != ~0u) {
+          data.vertices[firstVertex + used] = data.vertices[firstVertex + i];
+          if (hasTangents) {
+            data.tangents[firstVertex + used] = data.tangents[firstVertex + i];
+          }
+          remap[i] = used++;
+        }
+      }
+      data.vertices.resize(firstVertex + used);
+      if (hasTangents) {
+        data.tangents.resize(firstVertex + used);
+      }
+      for (std::size_t i = firstIndex; i < data.indices.size(); ++i) {
+        data.indices[i] = static_cast<std::uint32_t>(firstVertex) + remap[data.indices[i] - firstVertex];
+      }
+    }
     glm::mat4 toGlmMat4(const aiMatrix4x4 &m) {
       glm::mat4 out{1.0f};
       out[0][0] = m.a1; out[1][0] = m.a2; out[2][0] = m.a3; out[3][0] = m.a4;
@@ -119,69 +240,102 @@ namespace lve {
       return source;
     }
 
+    // one vertex per Assimp vertex, indexed by Assimp's own faces
     void processMesh(
       const aiMesh *mesh,
       const aiMaterial *material,
+      bool weld,
       backend::ModelData &data,
-      std::unordered_map<backend::ModelVertex, uint32_t> &uniqueVertices,
       backend::ModelSubMesh &outSubMesh) {
-      const uint32_t indexStart = static_cast<uint32_t>(data.indices.size());
-      glm::vec3 boundsMin(std::numeric_limits<float>::max());
-      glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
-      bool hasBounds = false;
+      const std::size_t indexStart = data.indices.size();
+      const std::size_t vertexStart = data.vertices.size();
+      const unsigned int vertexCount = mesh->mNumVertices;
+
+      glm::vec3 materialColor{1.0f, 1.0f, 1.0f};
+      aiColor4D diffuse;
+      if (!mesh->HasVertexColors(0) && material &&
+          aiGetMaterialColor(material, AI_MATKEY_COLOR_DIFFUSE, &diffuse) == AI_SUCCESS) {
+        materialColor = {diffuse.r, diffuse.g, diffuse.b};
+      }
+
+      data.vertices.resize(vertexStart + vertexCount);
+      backend::ModelVertex *vertices = data.vertices.data() + vertexStart;
+      for (unsigned int i = 0; i < vertexCount; ++i) {
+        vertices[i].color = materialColor;
+      }
+      if (mesh->HasPositions()) {
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+          const aiVector3D &pos = mesh->mVertices[i];
+          vertices[i].position = {pos.x, pos.y, pos.z};
+        }
+      }
+      if (mesh->HasNormals()) {
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+          const aiVector3D &n = mesh->mNormals[i];
+          vertices[i].normal = {n.x, n.y, n.z};
+        }
+      }
+      if (mesh->HasTextureCoords(0)) {
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+          const aiVector3D &uv = mesh->mTextureCoords[0][i];
+          vertices[i].uv = {uv.x, uv.y};
+        }
+      }
+      if (mesh->HasTangentsAndBitangents() && mesh->HasNormals()) {
+        // earlier meshes without tangents get zero entries
+        data.tangents.resize(vertexStart + vertexCount);
+        glm::vec4 *tangents = data.tangents.data() + vertexStart;
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+          const aiVector3D &t = mesh->mTangents[i];
+          const aiVector3D &b = mesh->mBitangents[i];
+          const glm::vec3 tangent{t.x, t.y, t.z};
+          // degenerate uv mapping leaves NaNs or a zero tangent, keep those on the shader fallback
+          if (!(glm::dot(tangent, tangent) > 1e-12f)) {
+            continue;
+          }
+          const float handedness =
+            glm::dot(glm::cross(vertices[i].normal, tangent), glm::vec3{b.x, b.y, b.z}) < 0.f ? -1.f : 1.f;
+          tangents[i] = glm::vec4(glm::normalize(tangent), handedness);
+        }
+      }
+      if (mesh->HasVertexColors(0)) {
+        for (unsigned int i = 0; i < vertexCount; ++i) {
+          const aiColor4D &c = mesh->mColors[0][i];
+          vertices[i].color = {c.r, c.g, c.b};
+        }
+      }
+
+      data.indices.reserve(indexStart + static_cast<std::size_t>(mesh->mNumFaces) * 3);
+      const std::uint32_t base = static_cast<std::uint32_t>(vertexStart);
+      bool skippedFaces = false;
       for (unsigned int faceIndex = 0; faceIndex < mesh->mNumFaces; ++faceIndex) {
         const aiFace &face = mesh->mFaces[faceIndex];
         if (face.mNumIndices != 3) {
+          skippedFaces = true;
           continue;
         }
-        for (unsigned int i = 0; i < face.mNumIndices; ++i) {
-          unsigned int index = face.mIndices[i];
-          backend::ModelVertex vertex{};
-
-          if (mesh->HasPositions()) {
-            const aiVector3D &pos = mesh->mVertices[index];
-            vertex.position = {pos.x, pos.y, pos.z};
-            boundsMin = glm::min(boundsMin, vertex.position);
-            boundsMax = glm::max(boundsMax, vertex.position);
-            hasBounds = true;
-          }
-
-          if (mesh->HasNormals()) {
-            const aiVector3D &n = mesh->mNormals[index];
-            vertex.normal = {n.x, n.y, n.z};
-          }
-
-          if (mesh->HasTextureCoords(0)) {
-            const aiVector3D &uv = mesh->mTextureCoords[0][index];
-            vertex.uv = {uv.x, uv.y};
-          }
-
-          if (mesh->HasVertexColors(0)) {
-            const aiColor4D &c = mesh->mColors[0][index];
-            vertex.color = {c.r, c.g, c.b};
-          } else if (material) {
-            aiColor4D diffuse;
-            if (aiGetMaterialColor(material, AI_MATKEY_COLOR_DIFFUSE, &diffuse) == AI_SUCCESS) {
-              vertex.color = {diffuse.r, diffuse.g, diffuse.b};
-            } else {
-              vertex.color = {1.0f, 1.0f, 1.0f};
-            }
-          } else {
-            vertex.color = {1.0f, 1.0f, 1.0f};
-          }
-
-          if (uniqueVertices.count(vertex) == 0) {
-            uniqueVertices[vertex] = static_cast<uint32_t>(data.vertices.size());
-            data.vertices.push_back(vertex);
-          }
-          data.indices.push_back(uniqueVertices[vertex]);
-        }
+        data.indices.push_back(base + face.mIndices[0]);
+        data.indices.push_back(base + face.mIndices[1]);
+        data.indices.push_back(base + face.mIndices[2]);
+      }
+      if (skippedFaces) {
+        compactVertices(data, vertexStart, indexStart);
       }
-      outSubMesh.firstIndex = indexStart;
-      outSubMesh.indexCount = static_cast<uint32_t>(data.indices.size()) - indexStart;
+      if (weld) {
+        weldVertices(data, vertexStart, indexStart);
+      }
+
+      outSubMesh.firstIndex = static_cast<uint32_t>(indexStart);
+      outSubMesh.indexCount = static_cast<uint32_t>(data.indices.size() - indexStart);
       outSubMesh.materialIndex = static_cast<int>(mesh->mMaterialIndex);
-      outSubMesh.hasBounds = hasBounds;
-      if (hasBounds) {
+      outSubMesh.hasBounds = mesh->HasPositions() && data.vertices.size() > vertexStart;
+      if (outSubMesh.hasBounds) {
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        for (std::size_t i = vertexStart; i < data.vertices.size(); ++i) {
+          boundsMin = glm::min(boundsMin, data.vertices[i].position);
+          boundsMax = glm::max(boundsMax, data.vertices[i].position);
+        }
         outSubMesh.boundsMin = boundsMin;
         outSubMesh.boundsMax = boundsMax;
       }
@@ -221,17 +375,38 @@ namespace lve {
 
   bool loadModelDataFromFile(
     const std::string &path,
+    const ModelImportSettings &settings,
     backend::ModelData &outData,
     std::string *outError) {
     const std::string resolvedPath = ENGINE_DIR + path;
 
+    // glTF is read natively, Assimp stays the fallback for what that reader rejects
+    std::string extension = std::filesystem::path(resolvedPath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    if (extension == ".gltf" || extension == ".glb") {
+      std::string gltfError;
+      if (loadModelDataFromGltf(resolvedPath, settings, outData, &gltfError)) {
+        return true;
+      }
+      std::cerr << "Native glTF import of " << resolvedPath << " failed";
+      if (!gltfError.empty()) {
+        std::cerr << ": " << gltfError;
+      }
+      std::cerr << ", falling back to Assimp\n";
+    }
+
     Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(
-      resolvedPath,
-      aiProcess_Triangulate |
-        aiProcess_GenNormals |
-        aiProcess_JoinIdenticalVertices |
-        aiProcess_FlipUVs);
+    const unsigned int flags = importFlags(settings);
+    if (flags & aiProcess_GlobalScale) {
+      importer.SetPropertyFloat(AI_CONFIG_GLOBAL_SCALE_FACTOR_KEY, settings.scale);
+    }
+    if (flags & aiProcess_FindDegenerates) {
+      // drop collapsed triangles instead of turning them into lines and points
+      importer.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
+    }
+    const aiScene *scene = importer.ReadFile(resolvedPath, flags);
     if (!scene || !scene->mRootNode) {
       if (outError) {
         *outError = importer.GetErrorString();
@@ -240,10 +415,12 @@ namespace lve {
     }
 
     outData.vertices.clear();
+    outData.tangents.clear();
     outData.indices.clear();
     outData.subMeshes.clear();
     outData.nodes.clear();
     outData.materials.clear();
+    outData.vertexFormat = settings.vertexFormat;
 
     const std::filesystem::path baseDir = std::filesystem::path(resolvedPath).parent_path();
     outData.materials.resize(scene->mNumMaterials);
@@ -257,7 +434,8 @@ namespace lve {
       outData.materials[materialIndex] = std::move(materialSource);
     }
 
-    std::unordered_map<backend::ModelVertex, uint32_t> uniqueVertices{};
+    // the engine's weld is cheaper than Assimp's joining, which only Optimize pays for
+    const bool weld = settings.profile != ModelImportProfile::Fast && (flags & aiProcess_JoinIdenticalVertices) == 0;
     std::vector<int> meshIndexToSubmesh(scene->mNumMeshes, -1);
     for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex) {
       const aiMesh *mesh = scene->mMeshes[meshIndex];
@@ -266,10 +444,14 @@ namespace lve {
         material = scene->mMaterials[mesh->mMaterialIndex];
       }
       backend::ModelSubMesh subMesh{};
-      processMesh(mesh, material, outData, uniqueVertices, subMesh);
+      processMesh(mesh, material, weld, outData, subMesh);
       meshIndexToSubmesh[meshIndex] = static_cast<int>(outData.subMeshes.size());
       outData.subMeshes.push_back(subMesh);
     }
+    // later meshes without tangents get zero entries too
+    if (!outData.tangents.empty()) {
+      outData.tangents.resize(outData.vertices.size());
+    }
 
     processNode(scene->mRootNode, -1, meshIndexToSubmesh, outData);
     return true;
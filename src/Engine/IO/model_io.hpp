@@ -6,8 +6,28 @@
 
 namespace lve {
 
+  enum class ModelImportProfile {
+    Default,  // triangulate, normals where missing, welded by the engine
+    Fast,     // already clean, indexed assets: no welding or cleanup at all
+    Optimize  // adds Assimp's joining, cleanup and vertex cache ordering
+  };
+
+  struct ModelImportSettings {
+    float scale{1.f};
+    bool generateNormals{false};  // smooth normals replace the source's
+    bool generateTangents{true};  // per-vertex frames for normal mapping, otherwise rebuilt per pixel
+    bool flipUV{false};  // inverts V on top of the conversion to Vulkan's top-left origin
+    ModelImportProfile profile{ModelImportProfile::Default};
+    // engine side passes after loading, see optimizeModelData
+    bool optimizeVertexCache{true};
+    bool reduceOverdraw{false};
+    int lodCount{3};  // simplified levels per submesh, see generateModelLods
+    backend::ModelVertexFormat vertexFormat{backend::ModelVertexFormat::Full};  // compact trades precision for size
+  };
+
   bool loadModelDataFromFile(
     const std::string &path,
+    const ModelImportSettings &settings,
     backend::ModelData &outData,
     std::string *outError = nullptr);
 
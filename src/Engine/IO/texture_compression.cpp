@@ -0,0 +1,482 @@
+#include "Engine/IO/texture_compression.hpp"
+
+#include "Engine/IO/image_io.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace lve {
+
+  namespace {
+    constexpr std::uint32_t kFormatBc1RgbUnorm = 131;
+    constexpr std::uint32_t kFormatBc1RgbSrgb = 132;
+    constexpr std::uint32_t kFormatBc3Unorm = 137;
+    constexpr std::uint32_t kFormatBc3Srgb = 138;
+    constexpr std::uint32_t kFormatBc4Unorm = 139;
+    constexpr std::uint32_t kFormatBc5Unorm = 141;
+    constexpr std::uint32_t kFormatBc7Unorm = 145;
+    constexpr std::uint32_t kFormatBc7Srgb = 146;
+
+    void setError(std::string *outError, const char *message) {
+      if (outError) {
+        *outError = message ? message : "unknown error";
+      }
+    }
+
+    using Block = std::array<std::array<float, 4>, 16>;
+
+    void fetchBlock(const ImageData &image, int blockX, int blockY, Block &out) {
+      for (int y = 0; y < 4; ++y) {
+        const int py = std::min(blockY * 4 + y, image.height - 1);
+        for (int x = 0; x < 4; ++x) {
+          const int px = std::min(blockX * 4 + x, image.width - 1);
+          const unsigned char *src =
+            &image.pixels[(static_cast<std::size_t>(py) * image.width + px) * image.channels];
+          for (int c = 0; c < 4; ++c) {
+            const float missing = c == 3 ? 255.f : 0.f;
+            out[y * 4 + x][c] = c < image.channels ? static_cast<float>(src[c]) : missing;
+          }
+        }
+      }
+    }
+
+    // principal axis of the first `channels` components through power iteration
+    void principalAxis(const Block &block, int channels, float mean[4], float axis[4]) {
+      for (int c = 0; c < 4; ++c) {
+        mean[c] = 0.f;
+        axis[c] = 0.f;
+      }
+      for (const auto &texel : block) {
+        for (int c = 0; c < channels; ++c) mean[c] += texel[c];
+      }
+      for (int c = 0; c < channels; ++c) mean[c] /= 16.f;
+
+      float cov[4][4]{};
+      for (const auto &texel : block) {
+        for (int i = 0; i < channels; ++i) {
+          for (int j = 0; j < channels; ++j) {
+            cov[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+          }
+        }
+      }
+
+      float v[4] = {1.f, 1.f, 1.f, 1.f};
+      for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4]{};
+        float length = 0.f;
+        for (int i = 0; i < channels; ++i) {
+          for (int j = 0; j < channels; ++j) next[i] += cov[i][j] * v[j];
+          length = std::max(length, std::abs(next[i]));
+        }
+        if (length < 1e-6f) break;
+        for (int i = 0; i < channels; ++i) v[i] = next[i] / length;
+      }
+
+      float length = 0.f;
+      for (int c = 0; c < channels; ++c) length += v[c] * v[c];
+      length = std::sqrt(length);
+      for (int c = 0; c < channels; ++c) axis[c] = v[c] / length;
+    }
+
+    void endpointsAlongAxis(const Block &block, int channels, float e0[4], float e1[4]) {
+      float mean[4];
+      float axis[4];
+      principalAxis(block, channels, mean, axis);
+      float minT = std::numeric_limits<float>::max();
+      float maxT = std::numeric_limits<float>::lowest();
+      for (const auto &texel : block) {
+        float t = 0.f;
+        for (int c = 0; c < channels; ++c) t += (texel[c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+      }
+      for (int c = 0; c < 4; ++c) {
+        e0[c] = c < channels ? std::clamp(mean[c] + axis[c] * minT, 0.f, 255.f) : 255.f;
+        e1[c] = c < channels ? std::clamp(mean[c] + axis[c] * maxT, 0.f, 255.f) : 255.f;
+      }
+    }
+
+    float distanceSquared(const float *a, const float *b, int channels) {
+      float sum = 0.f;
+      for (int c = 0; c < channels; ++c) {
+        const float d = a[c] - b[c];
+        sum += d * d;
+      }
+      return sum;
+    }
+
+    void writeLe16(unsigned char *out, uint32_t value) {
+      out[0] = static_cast<unsigned char>(value & 0xFF);
+      out[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+    }
+
+    // ---- BC1 ----
+
+    uint32_t packRgb565(const float color[4]) {
+      const uint32_t r = static_cast<uint32_t>(std::lround(color[0] * 31.f / 255.f));
+      const uint32_t g = static_cast<uint32_t>(std::lround(color[1] * 63.f / 255.f));
+      const uint32_t b = static_cast<uint32_t>(std::lround(color[2] * 31.f / 255.f));
+      return (r << 11) | (g << 5) | b;
+    }
+
+    void unpackRgb565(uint32_t packed, float out[4]) {
+      const uint32_t r = (packed >> 11) & 31;
+      const uint32_t g = (packed >> 5) & 63;
+      const uint32_t b = packed & 31;
+      out[0] = static_cast<float>((r << 3) | (r >> 2));
+      out[1] = static_cast<float>((g << 2) | (g >> 4));
+      out[2] = static_cast<float>((b << 3) | (b >> 2));
+      out[3] = 255.f;
+    }
+
+    void encodeBc1Block(const Block &block, unsigned char *out) {
+      float e0[4];
+      float e1[4];
+      endpointsAlongAxis(block, 3, e0, e1);
+
+      uint32_t c0 = packRgb565(e1);
+      uint32_t c1 = packRgb565(e0);
+      if (c0 < c1) std::swap(c0, c1);
+      writeLe16(out, c0);
+      writeLe16(out + 2, c1);
+      std::memset(out + 4, 0, 4);
+      if (c0 == c1) {
+        return;
+      }
+
+      // c0 > c1 selects the four color mode
+      float palette[4][4];
+      unpackRgb565(c0, palette[0]);
+      unpackRgb565(c1, palette[1]);
+      for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+        palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+      }
+
+      uint32_t indices = 0;
+      for (int i = 0; i < 16; ++i) {
+        uint32_t best = 0;
+        float bestError = std::numeric_limits<float>::max();
+        for (uint32_t p = 0; p < 4; ++p) {
+          const float error = distanceSquared(block[i].data(), palette[p], 3);
+          if (error < bestError) {
+            bestError = error;
+            best = p;
+          }
+        }
+        indices |= best << (i * 2);
+      }
+      writeLe16(out + 4, indices & 0xFFFF);
+      writeLe16(out + 6, indices >> 16);
+    }
+
+    // ---- BC4 (BC3 alpha, BC5 channels) ----
+
+    void encodeBc4Block(const Block &block, int channel, unsigned char *out) {
+      float minValue = 255.f;
+      float maxValue = 0.f;
+      for (const auto &texel : block) {
+        minValue = std::min(minValue, texel[channel]);
+        maxValue = std::max(maxValue, texel[channel]);
+      }
+      const uint32_t a0 = static_cast<uint32_t>(std::lround(maxValue));
+      const uint32_t a1 = static_cast<uint32_t>(std::lround(minValue));
+      out[0] = static_cast<unsigned char>(a0);
+      out[1] = static_cast<unsigned char>(a1);
+      std::memset(out + 2, 0, 6);
+      if (a0 == a1) {
+        return;
+      }
+
+      // a0 > a1 selects the eight value mode
+      float palette[8];
+      palette[0] = static_cast<float>(a0);
+      palette[1] = static_cast<float>(a1);
+      for (int i = 1; i < 7; ++i) {
+        palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7.f;
+      }
+
+      uint64_t indices = 0;
+      for (int i = 0; i < 16; ++i) {
+        uint64_t best = 0;
+        float bestError = std::numeric_limits<float>::max();
+        for (uint64_t p = 0; p < 8; ++p) {
+          const float error = std::abs(block[i][channel] - palette[p]);
+          if (error < bestError) {
+            bestError = error;
+            best = p;
+          }
+        }
+        indices |= best << (i * 3);
+      }
+      for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<unsigned char>((indices >> (i * 8)) & 0xFF);
+      }
+    }
+
+    // ---- BC7 (mode 6: one subset, RGBA 7.7.7.7 endpoints + p-bit, 4 bit indices) ----
+
+    constexpr int kBc7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct Bc7Endpoint {
+      uint32_t q[4]{};
+      uint32_t p{0};
+
+      float value(int c) const { return static_cast<float>((q[c] << 1) | p); }
+    };
+
+    Bc7Endpoint quantizeBc7(const float color[4]) {
+      Bc7Endpoint best{};
+      float bestError = std::numeric_limits<float>::max();
+      for (uint32_t p = 0; p < 2; ++p) {
+        Bc7Endpoint candidate{};
+        candidate.p = p;
+        float error = 0.f;
+        for (int c = 0; c < 4; ++c) {
+          const long q = std::lround((color[c] - static_cast<float>(p)) * 0.5f);
+          candidate.q[c] = static_cast<uint32_t>(std::clamp(q, 0L, 127L));
+          const float d = candidate.value(c) - color[c];
+          error += d * d;
+        }
+        if (error < bestError) {
+          bestError = error;
+          best = candidate;
+        }
+      }
+      return best;
+    }
+
+    float indexBc7(
+      const Block &block, const Bc7Endpoint &e0, const Bc7Endpoint &e1, uint32_t indices[16]) {
+      float palette[16][4];
+      for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+          const int w = kBc7Weights4[i];
+          palette[i][c] = static_cast<float>(
+            ((64 - w) * static_cast<int>(e0.value(c)) + w * static_cast<int>(e1.value(c)) + 32) >> 6);
+        }
+      }
+      float total = 0.f;
+      for (int i = 0; i < 16; ++i) {
+        uint32_t best = 0;
+        float bestError = std::numeric_limits<float>::max();
+        for (uint32_t p = 0; p < 16; ++p) {
+          const float error = distanceSquared(block[i].data(), palette[p], 4);
+          if (error < bestError) {
+            bestError = error;
+            best = p;
+          }
+        }
+        indices[i] = best;
+        total += bestError;
+      }
+      return total;
+    }
+
+    // least squares endpoints for fixed indices
+    bool refitBc7(const Block &block, const uint32_t indices[16], float e0[4], float e1[4]) {
+      float aa = 0.f, ab = 0.f, bb = 0.f;
+      float ax[4]{}, bx[4]{};
+      for (int i = 0; i < 16; ++i) {
+        const float w = kBc7Weights4[indices[i]] / 64.f;
+        const float a = 1.f - w;
+        aa += a * a;
+        ab += a * w;
+        bb += w * w;
+        for (int c = 0; c < 4; ++c) {
+          ax[c] += a * block[i][c];
+          bx[c] += w * block[i][c];
+        }
+      }
+      const float det = aa * bb - ab * ab;
+      if (std::abs(det) < 1e-6f) {
+        return false;
+      }
+      for (int c = 0; c < 4; ++c) {
+        e0[c] = std::clamp((bb * ax[c] - ab * bx[c]) / det, 0.f, 255.f);
+        e1[c] = std::clamp((aa * bx[c] - ab * ax[c]) / det, 0.f, 255.f);
+      }
+      return true;
+    }
+
+    struct BitWriter {
+      unsigned char *out;
+      int position = 0;
+
+      void write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; ++i, ++position) {
+          if ((value >> i) & 1u) {
+            out[position >> 3] |= static_cast<unsigned char>(1u << (position & 7));
+          }
+        }
+      }
+    };
+
+    void encodeBc7Block(const Block &block, unsigned char *out) {
+      float c0[4];
+      float c1[4];
+      endpointsAlongAxis(block, 4, c0, c1);
+
+      Bc7Endpoint e0 = quantizeBc7(c0);
+      Bc7Endpoint e1 = quantizeBc7(c1);
+      uint32_t indices[16];
+      float error = indexBc7(block, e0, e1, indices);
+
+      float r0[4];
+      float r1[4];
+      if (error > 0.f && refitBc7(block, indices, r0, r1)) {
+        const Bc7Endpoint f0 = quantizeBc7(r0);
+        const Bc7Endpoint f1 = quantizeBc7(r1);
+        uint32_t refitIndices[16];
+        const float refitError = indexBc7(block, f0, f1, refitIndices);
+        if (refitError < error) {
+          e0 = f0;
+          e1 = f1;
+          std::memcpy(indices, refitIndices, sizeof(indices));
+        }
+      }
+
+      // the anchor index drops its top bit, so it has to be < 8
+      if (indices[0] & 8u) {
+        std::swap(e0, e1);
+        for (uint32_t &index : indices) index = 15u - index;
+      }
+
+      std::memset(out, 0, 16);
+      BitWriter writer{out};
+      writer.write(1u << 6, 7);
+      for (int c = 0; c < 4; ++c) {
+        writer.write(e0.q[c], 7);
+        writer.write(e1.q[c], 7);
+      }
+      writer.write(e0.p, 1);
+      writer.write(e1.p, 1);
+      writer.write(indices[0], 3);
+      for (int i = 1; i < 16; ++i) {
+        writer.write(indices[i], 4);
+      }
+    }
+  } // namespace
+
+  std::size_t blockFormatBytesPerBlock(BlockFormat format) {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+  }
+
+  std::size_t compressedLevelSize(BlockFormat format, int width, int height) {
+    const std::size_t blocksX = static_cast<std::size_t>((std::max(width, 1) + 3) / 4);
+    const std::size_t blocksY = static_cast<std::size_t>((std::max(height, 1) + 3) / 4);
+    return blocksX * blocksY * blockFormatBytesPerBlock(format);
+  }
+
+  std::uint32_t blockFormatToVkFormat(BlockFormat format, bool sRGB) {
+    switch (format) {
+      case BlockFormat::BC1: return sRGB ? kFormatBc1RgbSrgb : kFormatBc1RgbUnorm;
+      case BlockFormat::BC3: return sRGB ? kFormatBc3Srgb : kFormatBc3Unorm;
+      case BlockFormat::BC4: return kFormatBc4Unorm;
+      case BlockFormat::BC5: return kFormatBc5Unorm;
+      case BlockFormat::BC7: return sRGB ? kFormatBc7Srgb : kFormatBc7Unorm;
+    }
+    return 0;
+  }
+
+  bool blockFormatFromVkFormat(std::uint32_t vkFormat, BlockFormat &outFormat, bool &outSrgb) {
+    switch (vkFormat) {
+      case kFormatBc1RgbUnorm: outFormat = BlockFormat::BC1; outSrgb = false; return true;
+      case kFormatBc1RgbSrgb: outFormat = BlockFormat::BC1; outSrgb = true; return true;
+      case kFormatBc3Unorm: outFormat = BlockFormat::BC3; outSrgb = false; return true;
+      case kFormatBc3Srgb: outFormat = BlockFormat::BC3; outSrgb = true; return true;
+      case kFormatBc4Unorm: outFormat = BlockFormat::BC4; outSrgb = false; return true;
+      case kFormatBc5Unorm: outFormat = BlockFormat::BC5; outSrgb = false; return true;
+      case kFormatBc7Unorm: outFormat = BlockFormat::BC7; outSrgb = false; return true;
+      case kFormatBc7Srgb: outFormat = BlockFormat::BC7; outSrgb = true; return true;
+      default: return false;
+    }
+  }
+
+  bool compressImage(
+    const ImageData &image,
+    BlockFormat format,
+    std::vector<unsigned char> &outBlocks,
+    std::string *outError) {
+    outBlocks.clear();
+    if (image.width <= 0 || image.height <= 0 || image.channels < 1 || image.channels > 4 ||
+        image.pixels.size() < static_cast<std::size_t>(image.width) * image.height * image.channels) {
+      setError(outError, "block compression expects 8 bit pixels with 1 to 4 channels");
+      return false;
+    }
+
+    const int blocksX = (image.width + 3) / 4;
+    const int blocksY = (image.height + 3) / 4;
+    const std::size_t blockBytes = blockFormatBytesPerBlock(format);
+    outBlocks.resize(compressedLevelSize(format, image.width, image.height));
+
+    Block block{};
+    for (int by = 0; by < blocksY; ++by) {
+      for (int bx = 0; bx < blocksX; ++bx) {
+        fetchBlock(image, bx, by, block);
+        unsigned char *out = &outBlocks[(static_cast<std::size_t>(by) * blocksX + bx) * blockBytes];
+        switch (format) {
+          case BlockFormat::BC1:
+            encodeBc1Block(block, out);
+            break;
+          case BlockFormat::BC3:
+            encodeBc4Block(block, 3, out);
+            encodeBc1Block(block, out + 8);
+            break;
+          case BlockFormat::BC4:
+            encodeBc4Block(block, 0, out);
+            break;
+          case BlockFormat::BC5:
+            encodeBc4Block(block, 0, out);
+            encodeBc4Block(block, 1, out + 8);
+            break;
+          case BlockFormat::BC7:
+            encodeBc7Block(block, out);
+            break;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool compressImageWithMips(
+    const ImageData &image,
+    BlockFormat format,
+    bool sRGB,
+    bool generateMipmaps,
+    CompressedImageData &outData,
+    std::string *outError) {
+    outData = CompressedImageData{};
+    outData.format = format;
+    outData.sRGB = sRGB;
+    outData.width = image.width;
+    outData.height = image.height;
+
+    std::vector<unsigned char> blocks;
+    if (!compressImage(image, format, blocks, outError)) {
+      return false;
+    }
+    outData.levels.push_back(std::move(blocks));
+
+    if (!generateMipmaps) {
+      return true;
+    }
+    std::vector<ImageData> mips;
+    if (!generateMipChain(image, sRGB, mips, outError)) {
+      return false;
+    }
+    for (const auto &mip : mips) {
+      if (!compressImage(mip, format, blocks, outError)) {
+        return false;
+      }
+      outData.levels.push_back(std::move(blocks));
+    }
+    return true;
+  }
+
+} // namespace lve
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Engine/IO/image_data.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+  std::size_t blockFormatBytesPerBlock(BlockFormat format);
+  std::size_t compressedLevelSize(BlockFormat format, int width, int height);
+
+  // VkFormat values, kept numeric so the IO layer does not depend on Vulkan headers
+  std::uint32_t blockFormatToVkFormat(BlockFormat format, bool sRGB);
+  bool blockFormatFromVkFormat(std::uint32_t vkFormat, BlockFormat &outFormat, bool &outSrgb);
+
+  // encodes one 8 bit image into 4x4 blocks, edge blocks repeat the last row/column. Images with
+  // fewer than 4 channels read missing color channels as 0 and alpha as 255.
+  bool compressImage(
+    const ImageData &image,
+    BlockFormat format,
+    std::vector<unsigned char> &outBlocks,
+    std::string *outError = nullptr);
+
+  // encodes the image and, when generateMipmaps is set, its full mip chain
+  bool compressImageWithMips(
+    const ImageData &image,
+    BlockFormat format,
+    bool sRGB,
+    bool generateMipmaps,
+    CompressedImageData &outData,
+    std::string *outError = nullptr);
+
+} // namespace lve
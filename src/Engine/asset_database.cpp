@@ -1,12 +1,23 @@
 #include "Engine/asset_database.hpp"
 
+#include "Engine/IO/cooked_model_io.hpp"
+#include "Engine/IO/image_io.hpp"
+#include "Engine/IO/ktx_io.hpp"
+#include "Engine/IO/mesh_optimizer.hpp"
+#include "Engine/IO/mesh_simplifier.hpp"
+#include "Engine/IO/model_io.hpp"
+#include "Engine/IO/texture_compression.hpp"
+
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
 #include <random>
 #include <regex>
 #include <sstream>
+#include <vector>
 
 namespace lve {
 
@@ -54,6 +65,179 @@ namespace lve {
       }
     }
 
+    TextureCompression compressionFromString(const std::string &value) {
+      const std::string key = toLowerCopy(value);
+      if (key == "none") return TextureCompression::None;
+      if (key == "bc1") return TextureCompression::BC1;
+      if (key == "bc3") return TextureCompression::BC3;
+      if (key == "bc4") return TextureCompression::BC4;
+      if (key == "bc5") return TextureCompression::BC5;
+      if (key == "bc7") return TextureCompression::BC7;
+      return TextureCompression::Auto;
+    }
+
+    std::string compressionToString(TextureCompression compression) {
+      switch (compression) {
+        case TextureCompression::None: return "none";
+        case TextureCompression::BC1: return "bc1";
+        case TextureCompression::BC3: return "bc3";
+        case TextureCompression::BC4: return "bc4";
+        case TextureCompression::BC5: return "bc5";
+        case TextureCompression::BC7: return "bc7";
+        default: return "auto";
+      }
+    }
+
+    ModelImportProfile profileFromString(const std::string &value) {
+      const std::string key = toLowerCopy(value);
+      if (key == "fast") return ModelImportProfile::Fast;
+      if (key == "optimize") return ModelImportProfile::Optimize;
+      return ModelImportProfile::Default;
+    }
+
+    std::string profileToString(ModelImportProfile profile) {
+      switch (profile) {
+        case ModelImportProfile::Fast: return "fast";
+        case ModelImportProfile::Optimize: return "optimize";
+        default: return "default";
+      }
+    }
+
+    backend::ModelVertexFormat vertexFormatFromString(const std::string &value) {
+      return toLowerCopy(value) == "compact" ? backend::ModelVertexFormat::Compact : backend::ModelVertexFormat::Full;
+    }
+
+    std::string vertexFormatToString(backend::ModelVertexFormat format) {
+      return format == backend::ModelVertexFormat::Compact ? "compact" : "full";
+    }
+
+    TextureUsage usageFromString(const std::string &value) {
+      const std::string key = toLowerCopy(value);
+      if (key == "normal") return TextureUsage::Normal;
+      if (key == "metallicroughness") return TextureUsage::MetallicRoughness;
+      if (key == "occlusion") return TextureUsage::Occlusion;
+      return TextureUsage::Color;
+    }
+
+    std::string usageToString(TextureUsage usage) {
+      switch (usage) {
+        case TextureUsage::Normal: return "normal";
+        case TextureUsage::MetallicRoughness: return "metallicRoughness";
+        case TextureUsage::Occlusion: return "occlusion";
+        default: return "color";
+      }
+    }
+
+    TextureFilter filterFromString(const std::string &value) {
+      return toLowerCopy(value) == "linear" ? TextureFilter::Linear : TextureFilter::Nearest;
+    }
+
+    std::string filterToString(TextureFilter filter) {
+      return filter == TextureFilter::Linear ? "linear" : "nearest";
+    }
+
+    TextureWrap wrapFromString(const std::string &value) {
+      const std::string key = toLowerCopy(value);
+      if (key == "clamp") return TextureWrap::ClampToEdge;
+      if (key == "mirror") return TextureWrap::MirroredRepeat;
+      return TextureWrap::Repeat;
+    }
+
+    std::string wrapToString(TextureWrap wrap) {
+      switch (wrap) {
+        case TextureWrap::ClampToEdge: return "clamp";
+        case TextureWrap::MirroredRepeat: return "mirror";
+        default: return "repeat";
+      }
+    }
+
+    BlockFormat toBlockFormat(const TextureImportSettings &settings) {
+      switch (settings.compression) {
+        case TextureCompression::BC1: return BlockFormat::BC1;
+        case TextureCompression::BC3: return BlockFormat::BC3;
+        case TextureCompression::BC4: return BlockFormat::BC4;
+        case TextureCompression::BC5: return BlockFormat::BC5;
+        case TextureCompression::BC7: return BlockFormat::BC7;
+        default: break;
+      }
+      switch (settings.usage) {
+        case TextureUsage::Normal:
+        case TextureUsage::MetallicRoughness: return BlockFormat::BC5;
+        case TextureUsage::Occlusion: return BlockFormat::BC4;
+        default: return BlockFormat::BC7;
+      }
+    }
+
+    std::string compressedPathForAsset(const std::string &assetPath) {
+      return assetPath + ".ktx2";
+    }
+
+    bool isCompressedTextureFile(const fs::path &path) {
+      if (path.extension() != ".ktx2") return false;
+      fs::path source = path;
+      source.replace_extension();
+      std::error_code ec;
+      return source.has_extension() && fs::is_regular_file(source, ec);
+    }
+
+    // changes whenever the source file or the settings that shape the encoded data change
+    std::string textureSourceKey(
+      const std::string &sourcePath,
+      const TextureImportSettings &settings,
+      int maxSize) {
+      std::error_code ec;
+      const auto size = fs::file_size(sourcePath, ec);
+      if (ec) return {};
+      const auto modified = fs::last_write_time(sourcePath, ec);
+      if (ec) return {};
+      std::ostringstream ss;
+      ss << "v2:" << size << ':' << modified.time_since_epoch().count() << ':'
+         << compressionToString(settings.compression) << ':' << usageToString(settings.usage) << ':'
+         << settings.sRGB << ':' << settings.generateMipmaps << ':' << maxSize;
+      return ss.str();
+    }
+
+    std::string cookedPathForAsset(const std::string &assetPath) {
+      return assetPath + ".lvemesh";
+    }
+
+    bool isCookedModelFile(const fs::path &path) {
+      return path.extension() == ".lvemesh";
+    }
+
+    std::uint64_t fnv1a(std::uint64_t hash, const void *data, std::size_t size) {
+      const auto *bytes = static_cast<const unsigned char *>(data);
+      for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+      }
+      return hash;
+    }
+
+    bool hashFileContents(const std::string &path, std::uint64_t &outHash) {
+      std::ifstream file(path, std::ios::in | std::ios::binary);
+      if (!file) return false;
+      std::uint64_t hash = 14695981039346656037ull;
+      std::vector<char> chunk(64 * 1024);
+      while (file) {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        hash = fnv1a(hash, chunk.data(), static_cast<std::size_t>(file.gcount()));
+      }
+      outHash = hash;
+      return file.eof();
+    }
+
+    // bump the prefix whenever the cooker output changes for the same input
+    std::uint64_t modelSettingsHash(const ModelImportSettings &settings) {
+      std::ostringstream ss;
+      ss << "cook-v10:" << settings.scale << ':' << settings.generateNormals << ':'
+         << settings.generateTangents << ':' << settings.flipUV << ':' << profileToString(settings.profile)
+         << ':' << vertexFormatToString(settings.vertexFormat) << ':' << settings.optimizeVertexCache << ':'
+         << settings.reduceOverdraw << ':' << settings.lodCount;
+      const std::string text = ss.str();
+      return fnv1a(14695981039346656037ull, text.data(), text.size());
+    }
+
     std::string readFileToString(const std::string &path) {
       std::ifstream file(path, std::ios::in | std::ios::binary);
       if (!file) return {};
@@ -171,12 +355,22 @@ namespace lve {
         ss << "    \"scale\": " << meta.modelSettings.scale << ",\n";
         ss << "    \"generateNormals\": " << (meta.modelSettings.generateNormals ? "true" : "false") << ",\n";
         ss << "    \"generateTangents\": " << (meta.modelSettings.generateTangents ? "true" : "false") << ",\n";
-        ss << "    \"flipUV\": " << (meta.modelSettings.flipUV ? "true" : "false") << "\n";
+        ss << "    \"flipUV\": " << (meta.modelSettings.flipUV ? "true" : "false") << ",\n";
+        ss << "    \"profile\": \"" << profileToString(meta.modelSettings.profile) << "\",\n";
+        ss << "    \"vertexFormat\": \"" << vertexFormatToString(meta.modelSettings.vertexFormat) << "\",\n";
+        ss << "    \"optimizeVertexCache\": " << (meta.modelSettings.optimizeVertexCache ? "true" : "false") << ",\n";
+        ss << "    \"reduceOverdraw\": " << (meta.modelSettings.reduceOverdraw ? "true" : "false") << ",\n";
+        ss << "    \"lodCount\": " << meta.modelSettings.lodCount << "\n";
         ss << "  }";
       } else if (meta.type == AssetType::Texture) {
         ss << ",\n  \"import\": {\n";
         ss << "    \"sRGB\": " << (meta.textureSettings.sRGB ? "true" : "false") << ",\n";
-        ss << "    \"generateMipmaps\": " << (meta.textureSettings.generateMipmaps ? "true" : "false") << "\n";
+        ss << "    \"generateMipmaps\": " << (meta.textureSettings.generateMipmaps ? "true" : "false") << ",\n";
+        ss << "    \"compression\": \"" << compressionToString(meta.textureSettings.compression) << "\",\n";
+        ss << "    \"usage\": \"" << usageToString(meta.textureSettings.usage) << "\",\n";
+        ss << "    \"maxSize\": " << meta.textureSettings.maxSize << ",\n";
+        ss << "    \"filter\": \"" << filterToString(meta.textureSettings.filter) << "\",\n";
+        ss << "    \"wrap\": \"" << wrapToString(meta.textureSettings.wrap) << "\"\n";
         ss << "  }";
       }
       ss << "\n}\n";
@@ -195,9 +389,28 @@ namespace lve {
         outMeta.modelSettings.generateNormals = parseBool(content, "generateNormals", outMeta.modelSettings.generateNormals);
         outMeta.modelSettings.generateTangents = parseBool(content, "generateTangents", outMeta.modelSettings.generateTangents);
         outMeta.modelSettings.flipUV = parseBool(content, "flipUV", outMeta.modelSettings.flipUV);
+        outMeta.modelSettings.profile = profileFromString(
+          parseString(content, "profile", profileToString(outMeta.modelSettings.profile)));
+        outMeta.modelSettings.vertexFormat = vertexFormatFromString(
+          parseString(content, "vertexFormat", vertexFormatToString(outMeta.modelSettings.vertexFormat)));
+        outMeta.modelSettings.optimizeVertexCache =
+          parseBool(content, "optimizeVertexCache", outMeta.modelSettings.optimizeVertexCache);
+        outMeta.modelSettings.reduceOverdraw = parseBool(content, "reduceOverdraw", outMeta.modelSettings.reduceOverdraw);
+        outMeta.modelSettings.lodCount = std::clamp(
+          static_cast<int>(parseFloat(content, "lodCount", static_cast<float>(outMeta.modelSettings.lodCount))), 0, 8);
       } else if (outMeta.type == AssetType::Texture) {
         outMeta.textureSettings.sRGB = parseBool(content, "sRGB", outMeta.textureSettings.sRGB);
         outMeta.textureSettings.generateMipmaps = parseBool(content, "generateMipmaps", outMeta.textureSettings.generateMipmaps);
+        outMeta.textureSettings.compression = compressionFromString(
+          parseString(content, "compression", compressionToString(outMeta.textureSettings.compression)));
+        outMeta.textureSettings.usage = usageFromString(
+          parseString(content, "usage", usageToString(outMeta.textureSettings.usage)));
+        outMeta.textureSettings.maxSize = static_cast<int>(
+          parseFloat(content, "maxSize", static_cast<float>(outMeta.textureSettings.maxSize)));
+        outMeta.textureSettings.filter = filterFromString(
+          parseString(content, "filter", filterToString(outMeta.textureSettings.filter)));
+        outMeta.textureSettings.wrap = wrapFromString(
+          parseString(content, "wrap", wrapToString(outMeta.textureSettings.wrap)));
       }
       return true;
     }
@@ -211,6 +424,16 @@ namespace lve {
     rootPath = newRootPath.empty() ? "Assets" : newRootPath;
   }
 
+  void AssetDatabase::setMaxTextureSize(int size) {
+    maxTextureSize = std::max(0, size);
+  }
+
+  int AssetDatabase::effectiveTextureSize(const TextureImportSettings &settings) const {
+    if (settings.maxSize <= 0) return maxTextureSize;
+    if (maxTextureSize <= 0) return settings.maxSize;
+    return std::min(settings.maxSize, maxTextureSize);
+  }
+
   void AssetDatabase::initialize() {
     pathToGuid.clear();
     guidToPath.clear();
@@ -227,6 +450,8 @@ namespace lve {
       if (!it->is_regular_file(ec)) continue;
       fs::path filePath = it->path();
       if (filePath.extension() == ".meta") continue;
+      if (isCompressedTextureFile(filePath)) continue;
+      if (isCookedModelFile(filePath)) continue;
       const std::string assetPath = makeAssetPath(root, filePath, rootPath);
       ensureMetaForAsset(assetPath);
     }
@@ -260,6 +485,11 @@ namespace lve {
     pathToGuid[normalizedAssetPath] = meta.guid;
     guidToPath[meta.guid] = normalizedAssetPath;
     pathToMeta[normalizedAssetPath] = meta;
+    if (meta.type == AssetType::Texture) {
+      importTexture(normalizedAssetPath, meta);
+    } else if (meta.type == AssetType::Model) {
+      importModel(normalizedAssetPath, meta);
+    }
     return meta.guid;
   }
 
@@ -302,4 +532,133 @@ namespace lve {
     return getMetaForPath(it->second);
   }
 
+  std::string AssetDatabase::getCompressedTexturePath(const std::string &assetPath) const {
+    const AssetMeta *meta = getMetaForPath(assetPath);
+    if (!meta || meta->type != AssetType::Texture ||
+        meta->textureSettings.compression == TextureCompression::None) {
+      return {};
+    }
+    const std::string path = compressedPathForAsset(assetPath);
+    std::error_code ec;
+    return fs::is_regular_file(path, ec) ? path : std::string{};
+  }
+
+  std::string AssetDatabase::getCookedModelPath(const std::string &assetPath) const {
+    const AssetMeta *meta = getMetaForPath(assetPath);
+    if (!meta || meta->type != AssetType::Model) {
+      return {};
+    }
+    const std::string path = cookedPathForAsset(assetPath);
+    std::error_code ec;
+    return fs::is_regular_file(path, ec) ? path : std::string{};
+  }
+
+  void AssetDatabase::importModel(const std::string &assetPath, const AssetMeta &meta) {
+    const std::string cookedPath = cookedPathForAsset(assetPath);
+    std::error_code ec;
+    CookedModelKey key{};
+    key.settingsHash = modelSettingsHash(meta.modelSettings);
+    key.sourceSize = static_cast<std::uint64_t>(fs::file_size(meta.sourcePath, ec));
+    if (ec) return;
+    const auto modified = fs::last_write_time(meta.sourcePath, ec);
+    if (ec) return;
+    key.sourceModified = static_cast<std::int64_t>(modified.time_since_epoch().count());
+
+    CookedModelKey existing{};
+    const bool hasExisting = readCookedModelKey(cookedPath, existing) && existing.settingsHash == key.settingsHash;
+    if (hasExisting && existing.sourceSize == key.sourceSize && existing.sourceModified == key.sourceModified) {
+      return;
+    }
+    if (!hashFileContents(meta.sourcePath, key.sourceHash)) return;
+    // touched but unchanged, e.g. a fresh checkout
+    if (hasExisting && existing.sourceHash == key.sourceHash) {
+      writeCookedModelKey(cookedPath, key);
+      return;
+    }
+
+    backend::ModelData data{};
+    std::string error;
+    auto reportFailure = [&]() {
+      std::cerr << "Failed to cook model " << assetPath;
+      if (!error.empty()) {
+        std::cerr << ": " << error;
+      }
+      std::cerr << "\n";
+      fs::remove(cookedPath, ec);
+    };
+    if (!loadModelDataFromFile(meta.sourcePath, meta.modelSettings, data, &error)) {
+      reportFailure();
+      return;
+    }
+    generateModelLods(data, meta.modelSettings.lodCount);
+    if (meta.modelSettings.optimizeVertexCache) {
+      MeshOptimizationStats stats{};
+      optimizeModelData(data, meta.modelSettings.reduceOverdraw, &stats);
+      if (stats.triangleCount > 0) {
+        std::cout << "Optimized " << assetPath << ": " << stats.triangleCount << " triangles, ACMR "
+                  << stats.acmrBefore << " -> " << stats.acmrAfter << std::endl;
+      }
+    }
+    if (!saveCookedModelFile(cookedPath, data, key, &error)) {
+      reportFailure();
+    }
+  }
+
+  void AssetDatabase::importTexture(const std::string &assetPath, const AssetMeta &meta) {
+    const std::string compressedPath = compressedPathForAsset(assetPath);
+    std::error_code ec;
+    if (meta.textureSettings.compression == TextureCompression::None) {
+      fs::remove(compressedPath, ec);
+      return;
+    }
+    // already block compressed containers are uploaded as they are
+    if (hasExtension(meta.sourcePath, {".ktx", ".ktx2", ".dds"})) {
+      return;
+    }
+
+    const TextureImportSettings &settings = meta.textureSettings;
+    const int maxSize = effectiveTextureSize(settings);
+    const std::string sourceKey = textureSourceKey(meta.sourcePath, settings, maxSize);
+    if (sourceKey.empty()) return;
+    std::string existingKey;
+    if (readKtxSourceKey(compressedPath, existingKey) && existingKey == sourceKey) {
+      return;
+    }
+
+    // data maps are linear no matter what the sRGB flag says
+    const bool sRGB = settings.sRGB && settings.usage == TextureUsage::Color;
+    ImageData image{};
+    ImageData packed{};
+    CompressedImageData compressed{};
+    std::string error;
+    if (!loadImageDataFromFile(meta.sourcePath, image, &error) ||
+        !downscaleToFit(image, maxSize, sRGB, &error) ||
+        !packImageForUsage(image, settings.usage, packed, &error) ||
+        !compressImageWithMips(
+          packed,
+          toBlockFormat(settings),
+          sRGB,
+          settings.generateMipmaps,
+          compressed,
+          &error) ||
+        !saveKtxFile(compressedPath, compressed, sourceKey, &error)) {
+      std::cerr << "Failed to compress texture " << assetPath;
+      if (!error.empty()) {
+        std::cerr << ": " << error;
+      }
+      std::cerr << "\n";
+      fs::remove(compressedPath, ec);
+    }
+  }
+
+  const AssetMeta *AssetDatabase::getMetaForSourcePath(const std::string &sourcePath) const {
+    const std::string normalized = normalizePathString(fs::path(sourcePath));
+    for (const auto &entry : pathToMeta) {
+      if (entry.second.sourcePath == normalized) {
+        return &entry.second;
+      }
+    }
+    return nullptr;
+  }
+
 } // namespace lve
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Engine/IO/model_io.hpp"
+#include "Engine/material_data.hpp"
+
 #include <string>
 #include <unordered_map>
 
@@ -14,16 +17,24 @@ namespace lve {
     Scene
   };
 
-  struct ModelImportSettings {
-    float scale{1.f};
-    bool generateNormals{false};
-    bool generateTangents{true};
-    bool flipUV{false};
+  enum class TextureCompression {
+    None,
+    Auto,  // picked from usage: BC7 color, BC5 normal/metallic-roughness, BC4 occlusion
+    BC1,
+    BC3,
+    BC4,
+    BC5,
+    BC7
   };
 
   struct TextureImportSettings {
     bool sRGB{true};
     bool generateMipmaps{true};
+    TextureCompression compression{TextureCompression::Auto};
+    TextureUsage usage{TextureUsage::Color};
+    int maxSize{0};  // longest side after import, 0 = source size
+    TextureFilter filter{TextureFilter::Nearest};
+    TextureWrap wrap{TextureWrap::Repeat};
   };
 
   struct AssetMeta {
@@ -41,6 +52,10 @@ namespace lve {
 
     void setRootPath(const std::string &rootPath);
     const std::string &getRootPath() const { return rootPath; }
+    void setMaxTextureSize(int size);
+    int getMaxTextureSize() const { return maxTextureSize; }
+    // the smaller of the asset's maxSize and the platform budget, 0 = unlimited
+    int effectiveTextureSize(const TextureImportSettings &settings) const;
 
     void initialize();
 
@@ -52,9 +67,18 @@ namespace lve {
     std::string resolveGuid(const std::string &guid) const;
     const AssetMeta *getMetaForPath(const std::string &assetPath) const;
     const AssetMeta *getMetaForGuid(const std::string &guid) const;
+    const AssetMeta *getMetaForSourcePath(const std::string &sourcePath) const;
+    // block compressed KTX2 written at import time, empty when the texture is not compressed
+    std::string getCompressedTexturePath(const std::string &assetPath) const;
+    // binary model cooked at import time, empty when the model could not be cooked
+    std::string getCookedModelPath(const std::string &assetPath) const;
 
   private:
+    void importTexture(const std::string &assetPath, const AssetMeta &meta);
+    void importModel(const std::string &assetPath, const AssetMeta &meta);
+
     std::string rootPath;
+    int maxTextureSize{0};
     std::unordered_map<std::string, std::string> pathToGuid;
     std::unordered_map<std::string, std::string> guidToPath;
     std::unordered_map<std::string, AssetMeta> pathToMeta;
@@ -9,6 +9,8 @@ namespace lve {
     std::string activeMeshPath{"Assets/models/colored_cube.obj"};
     std::string activeSpriteMetaPath{"Assets/textures/characters/player.json"};
     std::string activeMaterialPath{};
+    // platform texture budget applied on top of per-asset maxSize, 0 = unlimited
+    int maxTextureSize{0};
   };
 
 } // namespace lve
@@ -65,9 +65,9 @@ namespace lve {
 
     LveCamera editorCamera{};
     LveCamera gameCamera{};
-    editorSystem->init(
-      renderBackend.getSwapChainRenderPass(),
-      static_cast<uint32_t>(renderBackend.getSwapChainImageCount()));
+    backend::RenderPassHandle editorRenderPass = renderBackend.getSwapChainRenderPass();
+    uint32_t editorImageCount = static_cast<uint32_t>(renderBackend.getSwapChainImageCount());
+    editorSystem->init(editorRenderPass, editorImageCount);
 
     auto &viewerObject = sceneSystem.createEmptyObject();
     viewerObject.transform.translation.z = -2.5f;
@@ -91,6 +91,7 @@ namespace lve {
 
     while (!window.shouldClose()) {
       window.pollEvents();
+      sceneSystem.processAsyncLoads();
 
       auto newTime = std::chrono::high_resolution_clock::now();
       float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
@@ -130,10 +131,14 @@ namespace lve {
 
       auto commandBuffer = renderBackend.beginFrame();
       if (renderBackend.wasSwapChainRecreated()) {
-        editorSystem->onRenderPassChanged(
-          renderBackend.getSwapChainRenderPass(),
-          static_cast<uint32_t>(renderBackend.getSwapChainImageCount()));
-        sceneSystem.resetDescriptorCaches();
+        // a plain resize keeps the swapchain render pass; only re-init the editor when it changed
+        const backend::RenderPassHandle renderPass = renderBackend.getSwapChainRenderPass();
+        const uint32_t imageCount = static_cast<uint32_t>(renderBackend.getSwapChainImageCount());
+        if (renderPass != editorRenderPass || imageCount != editorImageCount) {
+          editorSystem->onRenderPassChanged(renderPass, imageCount);
+          editorRenderPass = renderPass;
+          editorImageCount = imageCount;
+        }
       }
       if (commandBuffer) {
         renderBackend.ensureOffscreenTargets(
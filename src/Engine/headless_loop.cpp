@@ -0,0 +1,144 @@
+#include "headless_loop.hpp"
+
+#include "camera.hpp"
+#include "Engine/Backend/Factory/runtime_backend_factory.hpp"
+#include "Engine/IO/image_io.hpp"
+#include "Engine/scene_system.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace lve {
+  namespace {
+    // same time step every run so animated frames match between captures
+    constexpr float kFixedFrameTime = 1.f / 60.f;
+
+    std::unique_ptr<backend::RuntimeBackend> createHeadlessRuntime(const HeadlessConfig &config) {
+      backend::RuntimeBackendConfig runtimeConfig{};
+      runtimeConfig.api = backend::BackendApi::Vulkan;
+      runtimeConfig.width = static_cast<int>(config.width);
+      runtimeConfig.height = static_cast<int>(config.height);
+      runtimeConfig.headless = true;
+      auto runtimeBackend = backend::createRuntimeBackend(runtimeConfig);
+      if (!runtimeBackend) {
+        throw std::runtime_error("Headless runtime backend initialization failed.");
+      }
+      return runtimeBackend;
+    }
+
+    void setupCamera(SceneSystem &sceneSystem, backend::RenderView view, float aspect, LveCamera &camera) {
+      const LveGameObject *activeCamera = sceneSystem.findActiveCamera();
+      if (view == backend::RenderView::Game && activeCamera && activeCamera->camera) {
+        const auto &settings = *activeCamera->camera;
+        camera.setViewYXZ(activeCamera->transform.translation, activeCamera->transform.rotation);
+        if (settings.projection == "ortho") {
+          const float orthoHeight = settings.orthoHeight;
+          const float orthoWidth = orthoHeight * aspect;
+          camera.setOrthographicProjection(
+            -orthoWidth / 2.f,
+            orthoWidth / 2.f,
+            -orthoHeight / 2.f,
+            orthoHeight / 2.f,
+            settings.nearPlane,
+            settings.farPlane);
+        } else {
+          camera.setPerspectiveProjection(glm::radians(settings.fov), aspect, settings.nearPlane, settings.farPlane);
+        }
+        return;
+      }
+
+      // the editor's starting viewpoint
+      camera.setViewYXZ(glm::vec3{0.f, 0.f, -2.5f}, glm::vec3{0.f});
+      camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
+    }
+  } // namespace
+
+  HeadlessLoop::HeadlessLoop(const HeadlessConfig &config)
+    : config{config}, runtime{createHeadlessRuntime(config)} {
+    auto &sceneSystem = runtime->sceneSystem();
+    if (config.scenePath.empty()) {
+      sceneSystem.loadGameObjects();
+    } else {
+      sceneSystem.loadSceneFromFile(config.scenePath, std::nullopt);
+    }
+  }
+
+  HeadlessLoop::~HeadlessLoop() {}
+
+  void HeadlessLoop::run() {
+    auto &sceneSystem = runtime->sceneSystem();
+    auto &renderBackend = runtime->renderBackend();
+
+    if (SpriteAnimator *spriteAnimator = sceneSystem.getSpriteAnimator()) {
+      if (auto *character = sceneSystem.findObject(sceneSystem.getCharacterId())) {
+        spriteAnimator->applySpriteState(*character, "idle");
+      }
+    }
+    // captures are of the finished scene, not of placeholders
+    sceneSystem.waitForPendingLoads();
+
+    const bool sceneView = config.view == backend::RenderView::Scene;
+    const float aspect = static_cast<float>(config.width) / static_cast<float>(config.height);
+    LveCamera camera{};
+    std::vector<LveGameObject*> renderObjects{};
+
+    const auto start = std::chrono::steady_clock::now();
+    int renderedFrames = 0;
+    while (renderedFrames < config.frames) {
+      auto commandBuffer = renderBackend.beginFrame();
+      if (!commandBuffer) {
+        continue;
+      }
+      renderBackend.ensureOffscreenTargets(
+        sceneView ? config.width : 0,
+        sceneView ? config.height : 0,
+        sceneView ? 0 : config.width,
+        sceneView ? 0 : config.height);
+
+      if (auto *character = sceneSystem.findObject(sceneSystem.getCharacterId())) {
+        sceneSystem.updateAnimationFrame(*character, 6, kFixedFrameTime, 0.15f);
+      }
+      setupCamera(sceneSystem, config.view, aspect, camera);
+
+      sceneSystem.updateBuffers(renderBackend.getFrameIndex());
+      sceneSystem.collectObjects(renderObjects);
+      if (sceneView) {
+        renderBackend.renderSceneView(kFixedFrameTime, camera, renderObjects, commandBuffer);
+      } else {
+        renderBackend.renderGameView(kFixedFrameTime, camera, renderObjects, commandBuffer);
+      }
+      renderBackend.endFrame();
+      renderedFrames++;
+    }
+    const double elapsedMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const auto &pacing = renderBackend.getFramePacingStats();
+    std::cout << "headless: " << renderedFrames << " frames, "
+              << (renderedFrames > 0 ? elapsedMs / renderedFrames : 0.0) << " ms/frame, "
+              << "fence wait avg " << pacing.average.fenceWaitMs << " ms, peak "
+              << pacing.peak.fenceWaitMs << " ms" << std::endl;
+
+    if (!config.capturePath.empty()) {
+      ImageData image{};
+      if (!renderBackend.readbackView(config.view, image)) {
+        throw std::runtime_error("headless: no rendered frame to read back");
+      }
+      std::string error;
+      if (!writePngFile(config.capturePath, image, &error)) {
+        throw std::runtime_error("headless: " + error + " (" + config.capturePath + ")");
+      }
+      std::cout << "headless: wrote " << config.capturePath << std::endl;
+    }
+  }
+
+} // namespace lve
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Engine/Backend/runtime_backend.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace lve {
+  struct HeadlessConfig {
+    std::uint32_t width{800};
+    std::uint32_t height{600};
+    int frames{1};
+    backend::RenderView view{backend::RenderView::Game};
+    std::string scenePath{};  // empty renders the default objects
+    std::string capturePath{};  // PNG of the last frame, empty skips the readback
+  };
+
+  // Renders one view offscreen for a fixed number of frames with a fixed time step, then reports
+  // frame timings and optionally writes the result out. Used for benchmarks and golden images.
+  class HeadlessLoop {
+  public:
+    explicit HeadlessLoop(const HeadlessConfig &config);
+    ~HeadlessLoop();
+
+    HeadlessLoop(const HeadlessLoop &) = delete;
+    HeadlessLoop &operator=(const HeadlessLoop &) = delete;
+
+    void run();
+
+  private:
+    HeadlessConfig config;
+    std::unique_ptr<backend::RuntimeBackend> runtime;
+  };
+} // namespace lve
@@ -1,7 +1,9 @@
 #include "scene_system.hpp"
 
 // std
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 // libs
@@ -23,7 +25,47 @@ namespace lve {
     backend::ObjectBufferPoolPtr objectBuffers)
     : assetFactory{assets},
       gameObjectManager{std::move(objectBuffers), assets.getDefaultTexture()},
-      assetDatabase{"Assets"} {}
+      assetDatabase{"Assets"} {
+    assets.setTextureOptionsProvider([this](const std::string &path, TextureUsage usage) {
+      backend::TextureLoadOptions options{};
+      options.usage = usage;
+      options.maxSize = assetDatabase.getMaxTextureSize();
+      const AssetMeta *meta = assetDatabase.getMetaForPath(path);
+      if (!meta) {
+        meta = assetDatabase.getMetaForSourcePath(path);
+      }
+      if (meta && meta->type == AssetType::Texture) {
+        options.sRGB = meta->textureSettings.sRGB;
+        options.generateMipmaps = meta->textureSettings.generateMipmaps;
+        options.filter = meta->textureSettings.filter;
+        options.wrap = meta->textureSettings.wrap;
+        options.maxSize = assetDatabase.effectiveTextureSize(meta->textureSettings);
+        // the KTX2 holds channels packed for its import usage
+        if (meta->textureSettings.usage == usage) {
+          options.compressedPath =
+            assetDatabase.getCompressedTexturePath(assetDatabase.getPathForGuid(meta->guid));
+        }
+      }
+      return options;
+    });
+    assets.setModelOptionsProvider([this](const std::string &path) {
+      backend::ModelLoadOptions options{};
+      const AssetMeta *meta = assetDatabase.getMetaForPath(path);
+      if (!meta) {
+        meta = assetDatabase.getMetaForSourcePath(path);
+      }
+      if (meta && meta->type == AssetType::Model) {
+        options.importSettings = meta->modelSettings;
+        options.cookedPath = assetDatabase.getCookedModelPath(assetDatabase.getPathForGuid(meta->guid));
+      }
+      return options;
+    });
+  }
+
+  SceneSystem::~SceneSystem() {
+    assetFactory.setTextureOptionsProvider({});
+    assetFactory.setModelOptionsProvider({});
+  }
 
   void SceneSystem::setAssetDefaults(const AssetDefaults &defaults) {
     assetDefaults = defaults;
@@ -37,6 +79,7 @@ namespace lve {
       assetDefaults.activeSpriteMetaPath = "Assets/textures/characters/player.json";
     }
     assetDatabase.setRootPath(assetDefaults.rootPath);
+    assetDatabase.setMaxTextureSize(assetDefaults.maxTextureSize);
   }
 
   void SceneSystem::setAssetRootPath(const std::string &rootPath) {
@@ -69,6 +112,7 @@ namespace lve {
   }
 
   bool SceneSystem::destroyObject(LveGameObject::id_t id) {
+    pendingNodeOverrides.erase(id);
     return gameObjectManager.destroyGameObject(id);
   }
 
@@ -137,6 +181,135 @@ namespace lve {
     return sharedModel;
   }
 
+  std::shared_ptr<backend::RenderModel> SceneSystem::getPlaceholderModel() {
+    if (!placeholderModel) {
+      placeholderModel = assetFactory.loadModel(assetDatabase.resolveAssetPath("Assets/models/colored_cube.obj"));
+    }
+    return placeholderModel;
+  }
+
+  std::shared_ptr<backend::RenderModel> SceneSystem::requestModel(const std::string &path) {
+    if (path.empty()) return {};
+    auto it = modelCache.find(path);
+    if (it != modelCache.end()) {
+      return it->second;
+    }
+    if (pendingModels.find(path) == pendingModels.end()) {
+      pendingModels[path] = assetFactory.loadModelAsync(assetDatabase.resolveAssetPath(path));
+    }
+    return getPlaceholderModel();
+  }
+
+  void SceneSystem::requestMaterialForObject(LveGameObject &obj, const std::string &path) {
+    obj.materialPath = path;
+    auto it = materialCache.find(path);
+    if (it != materialCache.end()) {
+      obj.material = it->second;
+    } else {
+      obj.material.reset();
+      if (pendingMaterials.find(path) == pendingMaterials.end()) {
+        pendingMaterials[path] = assetFactory.loadMaterialAsync(
+          path,
+          [this](const std::string &assetPath) {
+            return assetDatabase.resolveAssetPath(assetPath);
+          });
+      }
+    }
+    updateTextureMode(obj);
+  }
+
+  void SceneSystem::processAsyncLoads() {
+    assetFactory.processAsyncLoads();
+
+    for (auto it = pendingModels.begin(); it != pendingModels.end();) {
+      if (it->second.isPending()) {
+        ++it;
+        continue;
+      }
+      const std::string path = it->first;
+      const auto model = it->second.get();
+      it = pendingModels.erase(it);
+      finishModelLoad(path, model);
+    }
+    for (auto it = pendingMaterials.begin(); it != pendingMaterials.end();) {
+      if (it->second.isPending()) {
+        ++it;
+        continue;
+      }
+      const std::string path = it->first;
+      const auto material = it->second.get();
+      it = pendingMaterials.erase(it);
+      finishMaterialLoad(path, material);
+    }
+
+    if (spriteAnimator && spriteAnimator->collectLoadedTextures()) {
+      for (auto &kv : gameObjectManager.gameObjects) {
+        if (kv.second.isSprite) {
+          spriteAnimator->refreshTexture(kv.second);
+        }
+      }
+    }
+  }
+
+  bool SceneSystem::hasPendingLoads() const {
+    return !pendingModels.empty() || !pendingMaterials.empty() ||
+      (spriteAnimator && spriteAnimator->hasPendingTextures()) ||
+      assetFactory.getPendingAsyncLoads() > 0;
+  }
+
+  void SceneSystem::waitForPendingLoads() {
+    processAsyncLoads();
+    while (hasPendingLoads()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      processAsyncLoads();
+    }
+  }
+
+  void SceneSystem::finishModelLoad(const std::string &path, const std::shared_ptr<backend::RenderModel> &loaded) {
+    if (!loaded) {
+      std::cerr << "Failed to load model " << path << ", keeping the placeholder\n";
+      return;
+    }
+    // a blocking load may have cached the path in the meantime
+    auto &model = modelCache.try_emplace(path, loaded).first->second;
+    if (path == "Assets/models/colored_cube.obj") {
+      cubeModel = model;
+    }
+    for (auto &kv : gameObjectManager.gameObjects) {
+      auto &obj = kv.second;
+      if (obj.isSprite || obj.modelPath != path || obj.model != placeholderModel) {
+        continue;
+      }
+      obj.model = model;
+      obj.transformDirty = true;
+      auto overrides = pendingNodeOverrides.find(obj.getId());
+      if (overrides != pendingNodeOverrides.end()) {
+        applyNodeOverrides(obj, overrides->second);
+        pendingNodeOverrides.erase(overrides);
+      } else {
+        ensureNodeOverrides(obj);
+      }
+      updateTextureMode(obj);
+    }
+  }
+
+  void SceneSystem::finishMaterialLoad(
+    const std::string &path,
+    const std::shared_ptr<backend::RenderMaterial> &loaded) {
+    if (!loaded) {
+      return;
+    }
+    auto &material = materialCache.try_emplace(path, loaded).first->second;
+    for (auto &kv : gameObjectManager.gameObjects) {
+      auto &obj = kv.second;
+      if (obj.materialPath != path || obj.material) {
+        continue;
+      }
+      obj.material = material;
+      updateTextureMode(obj);
+    }
+  }
+
   std::shared_ptr<backend::RenderMaterial> SceneSystem::loadMaterialCached(const std::string &path) {
     if (path.empty()) return {};
     auto it = materialCache.find(path);
@@ -205,7 +378,11 @@ namespace lve {
       obj.materialPath = path;
       obj.material = material;
     }
+    updateTextureMode(obj);
+    return true;
+  }
 
+  void SceneSystem::updateTextureMode(LveGameObject &obj) {
     if (obj.material && obj.material->hasBaseColorTexture()) {
       obj.enableTextureType = 1;
     } else if (obj.model && obj.model->hasAnyDiffuseTexture()) {
@@ -213,7 +390,6 @@ namespace lve {
     } else {
       obj.enableTextureType = 0;
     }
-    return true;
   }
 
   void SceneSystem::ensureNodeOverrides(LveGameObject &obj) {
@@ -278,7 +454,7 @@ namespace lve {
       ? "Assets/models/colored_cube.obj"
       : assetDefaults.activeMeshPath;
     const std::string pathToUse = modelPath.empty() ? fallbackPath : modelPath;
-    auto model = loadModelCached(pathToUse);
+    auto model = requestModel(pathToUse);
     auto &obj = gameObjectManager.createGameObject();
     obj.model = model;
     obj.modelPath = pathToUse;
@@ -341,7 +517,7 @@ namespace lve {
       ? "Assets/models/colored_cube.obj"
       : assetDefaults.activeMeshPath;
     const std::string pathToUse = modelPath.empty() ? fallbackPath : modelPath;
-    auto model = loadModelCached(pathToUse);
+    auto model = requestModel(pathToUse);
     auto &obj = gameObjectManager.createGameObjectWithId(id);
     obj.model = model;
     obj.modelPath = pathToUse;
@@ -493,7 +669,10 @@ namespace lve {
         if (!mc.material.empty()) {
           mc.materialGuid = assetDatabase.ensureMetaForAsset(mc.material);
         }
-        if (!obj.nodeOverrides.empty()) {
+        auto pendingOverrides = pendingNodeOverrides.find(obj.getId());
+        if (pendingOverrides != pendingNodeOverrides.end()) {
+          mc.nodeOverrides = pendingOverrides->second.nodeOverrides;
+        } else if (!obj.nodeOverrides.empty()) {
           for (std::size_t i = 0; i < obj.nodeOverrides.size(); ++i) {
             const auto &override = obj.nodeOverrides[i];
             if (!override.enabled || isIdentityTransform(override.transform)) {
@@ -522,6 +701,7 @@ namespace lve {
     spriteModel.reset();
     modelCache.clear();
     materialCache.clear();
+    pendingNodeOverrides.clear();
 
     auto resolveAssetPath = [this](const std::string &guid, const std::string &path) {
       if (!guid.empty()) {
@@ -614,10 +794,14 @@ namespace lve {
         obj.transform.scale = e.transform.scale;
         obj.name = !e.name.empty() ? e.name : "Mesh " + std::to_string(obj.getId());
         obj.transformDirty = true;
-        applyNodeOverrides(obj, *e.mesh);
+        if (modelCache.find(modelPath) != modelCache.end()) {
+          applyNodeOverrides(obj, *e.mesh);
+        } else if (!e.mesh->nodeOverrides.empty()) {
+          pendingNodeOverrides[obj.getId()] = *e.mesh;
+        }
         const std::string materialPath = resolveAssetPath(e.mesh->materialGuid, e.mesh->material);
         if (!materialPath.empty()) {
-          applyMaterialToObject(obj, materialPath);
+          requestMaterialForObject(obj, materialPath);
         }
         continue;
       }
@@ -23,6 +23,10 @@ namespace lve {
     SceneSystem(
       backend::RenderAssetFactory &assets,
       backend::ObjectBufferPoolPtr objectBuffers);
+    ~SceneSystem();
+
+    SceneSystem(const SceneSystem &) = delete;
+    SceneSystem &operator=(const SceneSystem &) = delete;
 
     LveGameObject &createEmptyObject();
     LveGameObject *findObject(LveGameObject::id_t id);
@@ -60,6 +64,13 @@ namespace lve {
 
     std::shared_ptr<backend::RenderModel> loadModelCached(const std::string &path);
     std::shared_ptr<backend::RenderMaterial> loadMaterialCached(const std::string &path);
+    // cached model, or the placeholder while path loads in the background; objects holding the
+    // placeholder for path are switched over by processAsyncLoads()
+    std::shared_ptr<backend::RenderModel> requestModel(const std::string &path);
+    // finishes background loads and patches the objects waiting for them, call between frames
+    void processAsyncLoads();
+    bool hasPendingLoads() const;
+    void waitForPendingLoads();
     bool updateMaterialFromData(const std::string &path, const MaterialData &data);
     bool applyMaterialToObject(LveGameObject &obj, const std::string &path);
     bool setActiveSpriteMetadata(const std::string &path);
@@ -98,6 +109,11 @@ namespace lve {
   private:
     static ObjectState objectStateFromString(const std::string &name);
     static std::string objectStateToString(ObjectState state);
+    std::shared_ptr<backend::RenderModel> getPlaceholderModel();
+    void requestMaterialForObject(LveGameObject &obj, const std::string &path);
+    void updateTextureMode(LveGameObject &obj);
+    void finishModelLoad(const std::string &path, const std::shared_ptr<backend::RenderModel> &model);
+    void finishMaterialLoad(const std::string &path, const std::shared_ptr<backend::RenderMaterial> &material);
 
     backend::RenderAssetFactory &assetFactory;
     LveGameObjectManager gameObjectManager;
@@ -109,6 +125,11 @@ namespace lve {
     std::shared_ptr<backend::RenderModel> spriteModel;
     std::unordered_map<std::string, std::shared_ptr<backend::RenderModel>> modelCache;
     std::unordered_map<std::string, std::shared_ptr<backend::RenderMaterial>> materialCache;
+    std::shared_ptr<backend::RenderModel> placeholderModel;
+    std::unordered_map<std::string, backend::AssetHandle<backend::RenderModel>> pendingModels;
+    std::unordered_map<std::string, backend::AssetHandle<backend::RenderMaterial>> pendingMaterials;
+    // scene node overrides of meshes still showing the placeholder, applied once the model is in
+    std::unordered_map<LveGameObject::id_t, MeshComponent> pendingNodeOverrides;
     LveGameObject::id_t characterId{0};
   };
 } // namespace lve
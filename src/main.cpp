@@ -1,11 +1,59 @@
 #include "Engine/engine_loop.hpp"
+#include "Engine/headless_loop.hpp"
 
 // std
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+
+namespace {
+  // --headless [--frames N] [--size WxH] [--view game|scene] [--scene path] [--capture out.png]
+  bool parseHeadlessArgs(int argc, char **argv, lve::HeadlessConfig &config) {
+    bool headless = false;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      const bool hasValue = i + 1 < argc;
+      if (arg == "--headless") {
+        headless = true;
+      } else if (arg == "--frames" && hasValue) {
+        config.frames = std::max(1, std::atoi(argv[++i]));
+      } else if (arg == "--size" && hasValue) {
+        unsigned width = 0;
+        unsigned height = 0;
+        if (std::sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width > 0 && height > 0) {
+          config.width = width;
+          config.height = height;
+        }
+      } else if (arg == "--view" && hasValue) {
+        config.view = std::strcmp(argv[++i], "scene") == 0 ? lve::backend::RenderView::Scene
+                                                            : lve::backend::RenderView::Game;
+      } else if (arg == "--scene" && hasValue) {
+        config.scenePath = argv[++i];
+      } else if (arg == "--capture" && hasValue) {
+        config.capturePath = argv[++i];
+      }
+    }
+    return headless;
+  }
+} // namespace
+
+int main(int argc, char **argv) {
+  lve::HeadlessConfig headlessConfig{};
+  if (parseHeadlessArgs(argc, argv, headlessConfig)) {
+    try {
+      lve::HeadlessLoop headless{headlessConfig};
+      headless.run();
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << '\n';
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
 
-int main() {
   lve::EngineLoop app{};
 
   try {
@@ -52,13 +52,19 @@ namespace lve {
     const backend::RenderTexture *metallicRoughness{nullptr};
     const backend::RenderTexture *occlusion{nullptr};
     const backend::RenderTexture *emissive{nullptr};
+    // highest getRevision() of the bound textures, changes when any of them streams
+    std::uint64_t revision{0};
+    // generation of the descriptor pool the cached set came from, a recycled pool invalidates it
+    std::uint64_t poolGeneration{0};
 
     bool operator==(const MaterialTextureBindings &other) const {
       return baseColor == other.baseColor &&
         normal == other.normal &&
         metallicRoughness == other.metallicRoughness &&
         occlusion == other.occlusion &&
-        emissive == other.emissive;
+        emissive == other.emissive &&
+        revision == other.revision &&
+        poolGeneration == other.poolGeneration;
     }
     bool operator!=(const MaterialTextureBindings &other) const {
       return !(*this == other);
@@ -68,6 +74,7 @@ namespace lve {
   struct SubMeshDescriptorCache {
     std::array<backend::DescriptorSetHandle, backend::kMaxFramesInFlight> sets{};
     std::array<MaterialTextureBindings, backend::kMaxFramesInFlight> textures{};
+    std::array<std::uint8_t, backend::kRenderViewCount> lodLevels{};  // per RenderView, 0 is the full mesh
   };
 
   class LveGameObjectManager; // forward declare game object manager class
@@ -33,12 +33,43 @@ namespace lve {
     if (it != textureCache.end()) {
       return it->second;
     }
-    auto sharedTex = assets.loadTexture(path);
-    if (!sharedTex) {
-      return nullptr;
+    auto pending = pendingTextures.find(path);
+    if (pending == pendingTextures.end()) {
+      pending = pendingTextures.emplace(path, assets.loadTextureAsync(path)).first;
+    }
+    // already resident textures resolve right away
+    if (!pending->second.isPending()) {
+      auto texture = pending->second.get();
+      textureCache[path] = texture;
+      pendingTextures.erase(pending);
+      return texture;
+    }
+    return assets.getDefaultTexture();
+  }
+
+  bool SpriteAnimator::collectLoadedTextures() {
+    bool loaded = false;
+    for (auto it = pendingTextures.begin(); it != pendingTextures.end();) {
+      if (it->second.isPending()) {
+        ++it;
+        continue;
+      }
+      // failures are cached too, applySpriteState reports them instead of retrying every frame
+      textureCache[it->first] = it->second.get();
+      it = pendingTextures.erase(it);
+      loaded = true;
+    }
+    return loaded;
+  }
+
+  void SpriteAnimator::refreshTexture(LveGameObject &character) const {
+    if (!character.hasSpriteState) {
+      return;
+    }
+    auto it = textureCache.find(character.spriteState.texturePath);
+    if (it != textureCache.end() && it->second && it->second != character.diffuseMap) {
+      character.diffuseMap = it->second;
     }
-    textureCache[path] = sharedTex;
-    return sharedTex;
   }
 
   bool SpriteAnimator::applySpriteState(LveGameObject &character, const std::string &stateName) {
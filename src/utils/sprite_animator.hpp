@@ -20,12 +20,22 @@ namespace lve {
     const std::string &getCurrentTexturePath() const { return currentTexturePath; }
     const SpriteMetadata &getMetadata() const { return metadata; }
 
+    // textures load in the background, characters show the default texture until then
+    bool hasPendingTextures() const { return !pendingTextures.empty(); }
+    // moves finished loads into the cache, true when any finished
+    bool collectLoadedTextures();
+    // swaps in the texture of the character's current state once it has loaded
+    void refreshTexture(LveGameObject &character) const;
+
   private:
     std::shared_ptr<backend::RenderTexture> loadTextureCached(const std::string &path);
 
     backend::RenderAssetFactory &assets;
     SpriteMetadata metadata;
+    // pins every state's texture so switching states never reloads; the factory registry
+    // already shares them with other animators, models and materials
     std::unordered_map<std::string, std::shared_ptr<backend::RenderTexture>> textureCache;
+    std::unordered_map<std::string, backend::AssetHandle<backend::RenderTexture>> pendingTextures;
     std::string currentTexturePath;
   };
 